@@ -3,6 +3,7 @@
 
 #include <golos/chain/comment_object.hpp>
 #include <golos/chain/database.hpp>
+#include <golos/protocol/json_writer.hpp>
 #include <vector>
 
 namespace golos { namespace api {
@@ -95,4 +96,7 @@ FC_REFLECT(
     (root_comment)(root_title)(max_accepted_payout)(percent_steem_dollars)(allow_replies)(allow_votes)
     (allow_curation_rewards)(curation_rewards_percent)(beneficiaries))
 
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::protocol::beneficiary_route_type)
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::api::comment_api_object)
+
 #endif //GOLOS_COMMENT_API_OBJ_H
@@ -57,3 +57,5 @@ FC_REFLECT_DERIVED( (golos::api::discussion), ((golos::api::comment_api_object))
         (pending_payout_value)(total_pending_payout_value)(active_votes)(active_votes_count)(replies)
         (author_reputation)(promoted)(body_length)(reblogged_by)(first_reblogged_by)(first_reblogged_on)
         (reblog_author)(reblog_title)(reblog_body)(reblog_json_metadata)(reblog_entries))
+
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::api::discussion)
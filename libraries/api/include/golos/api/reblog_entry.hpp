@@ -1,6 +1,7 @@
 #pragma once
 
 #include <golos/chain/database.hpp>
+#include <golos/protocol/json_writer.hpp>
 
 namespace golos { namespace api {
 
@@ -20,4 +21,6 @@ namespace golos { namespace api {
 
 } } // golos::api
 
-FC_REFLECT((golos::api::reblog_entry), (author)(title)(body)(json_metadata));
\ No newline at end of file
+FC_REFLECT((golos::api::reblog_entry), (author)(title)(body)(json_metadata));
+
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::api::reblog_entry)
@@ -1,5 +1,6 @@
 #pragma once
 #include <golos/protocol/types.hpp>
+#include <golos/protocol/json_writer.hpp>
 #include <fc/reflect/reflect.hpp>
 
 namespace golos { namespace api {
@@ -16,4 +17,6 @@ namespace golos { namespace api {
 } } // golos::api
 
 
-FC_REFLECT((golos::api::vote_state), (voter)(weight)(rshares)(percent)(reputation)(time));
\ No newline at end of file
+FC_REFLECT((golos::api::vote_state), (voter)(weight)(rshares)(percent)(reputation)(time));
+
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::api::vote_state)
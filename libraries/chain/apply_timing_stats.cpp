@@ -0,0 +1,83 @@
+#include <golos/chain/apply_timing_stats.hpp>
+#include <golos/protocol/operation_util_impl.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace chain {
+
+    apply_timing_stats::apply_timing_stats()
+            : _operations(operation::count()),
+              _steps(static_cast<uint32_t>(block_step::total) + 1) {
+    }
+
+    apply_timing_info apply_timing_stats::get_info() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return make_info();
+    }
+
+    apply_timing_info apply_timing_stats::make_info() const {
+        apply_timing_info info;
+
+        for (int i = 0; i < operation::count(); ++i) {
+            if (!_operations[i].count) {
+                continue;
+            }
+            apply_timing_item item;
+            static_cast<latency_histogram&>(item) = _operations[i];
+            operation op;
+            op.set_which(i);
+            op.visit(fc::get_operation_name(item.name));
+            info.operations.push_back(std::move(item));
+        }
+
+        for (uint32_t i = 0; i < _steps.size(); ++i) {
+            if (!_steps[i].count) {
+                continue;
+            }
+            apply_timing_item item;
+            static_cast<latency_histogram&>(item) = _steps[i];
+            item.name = fc::reflector<block_step>::to_string(static_cast<block_step>(i));
+            info.block_steps.push_back(std::move(item));
+        }
+
+        return info;
+    }
+
+    void apply_timing_stats::log(uint32_t block_num, uint32_t top) const {
+        auto info = get_info();
+
+        auto by_total = [](const apply_timing_item& l, const apply_timing_item& r) {
+            return l.total_us > r.total_us;
+        };
+        std::sort(info.operations.begin(), info.operations.end(), by_total);
+        std::sort(info.block_steps.begin(), info.block_steps.end(), by_total);
+
+        auto print = [&](const char* kind, const std::vector<apply_timing_item>& items) {
+            for (uint32_t i = 0; i < items.size() && i < top; ++i) {
+                const auto& item = items[i];
+                ilog("Apply timing ${kind} ${name}: count ${count}, total ${total} ms, avg ${avg} us, max ${max} us",
+                    ("kind", kind)("name", item.name)("count", item.count)("total", item.total_us / 1000)
+                    ("avg", item.total_us / item.count)("max", item.max_us));
+            }
+        };
+
+        ilog("Apply timing stats at block ${n}", ("n", block_num));
+        print("step", info.block_steps);
+        print("operation", info.operations);
+    }
+
+    apply_timing_info apply_timing_stats::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto info = make_info();
+        for (auto& h: _operations) {
+            h = latency_histogram();
+        }
+        for (auto& h: _steps) {
+            h = latency_histogram();
+        }
+        return info;
+    }
+
+} } // golos::chain
@@ -102,6 +102,30 @@ namespace golos { namespace chain {
                 return end_pos + sizeof(uint64_t);
             }
 
+            void read_block_data(uint32_t block_num, uint64_t pos, const block_data_handler& handler) const {
+                // the next block starts after the position marker of this block
+                uint64_t end_pos;
+                if (block_num < protocol::block_header::num_from_id(head_id)) {
+                    end_pos = get_uint64(index_mapped_file, sizeof(uint64_t) * block_num);
+                } else {
+                    end_pos = get_mapped_size(block_mapped_file);
+                }
+
+                GOLOS_CHECK_DATABASE(pos + sizeof(uint64_t) <= end_pos,
+                        database_corrupted::reading_data_beyond_end_of_file,
+                        "Reading data beyond end of file",
+                        ("pos", pos)("end_pos", end_pos));
+
+                const auto size = end_pos - pos - sizeof(uint64_t);
+                const auto block_pos = get_uint64(block_mapped_file, pos + size);
+                GOLOS_CHECK_DATABASE(block_pos == pos,
+                        database_corrupted::wrong_position_marker_was_read,
+                        "Wrong position makers was read (read ${block_pos}, expected ${expected})",
+                        ("block_pos", block_pos)("expected", pos));
+
+                handler(block_mapped_file.const_data() + pos, size);
+            }
+
             signed_block read_head() const {
                 auto pos = get_last_uint64(block_mapped_file);
                 signed_block block;
@@ -250,23 +274,50 @@ namespace golos { namespace chain {
         flush();
     }
 
-    void block_log::open(const fc::path& file) {
+    void block_log::open(const fc::path& file, uint32_t chunk_blocks) {
         detail::write_lock lock(my->mutex);
-        my->open(file);
+
+        bool has_raw_blocks = false;
+        bool is_compressed_file = compressed_block_log::is_compressed_file(file);
+        if (!is_compressed_file && boost::filesystem::is_regular_file(file.string())) {
+            has_raw_blocks = boost::filesystem::file_size(file.string()) > uint64_t(detail::min_valid_file_size);
+        }
+
+        if (is_compressed_file || (chunk_blocks && !has_raw_blocks)) {
+            my->close();
+            compressed = std::make_unique<compressed_block_log>();
+            compressed->set_cache_size(cache_size);
+            compressed->open(file, chunk_blocks);
+        } else {
+            if (chunk_blocks) {
+                wlog("Block log has the raw format, it can be converted to the compressed format by convert_block_log");
+            }
+            compressed.reset();
+            my->open(file);
+        }
     }
 
     void block_log::close() {
         detail::write_lock lock(my->mutex);
+        if (compressed) {
+            compressed->close();
+        }
         my->close();
     }
 
     bool block_log::is_open() const {
+        if (compressed) {
+            return compressed->is_open();
+        }
         detail::read_lock lock(my->mutex);
         return my->block_mapped_file.is_open();
     }
 
     uint64_t block_log::append(const signed_block& block) { try {
         auto data = fc::raw::pack(block);
+        if (compressed) {
+            return compressed->append(block, data);
+        }
         detail::write_lock lock(my->mutex);
         return my->append(block, data);
     } FC_LOG_AND_RETHROW() }
@@ -276,6 +327,7 @@ namespace golos { namespace chain {
     }
 
     std::pair<signed_block, uint64_t> block_log::read_block(uint64_t pos) const {
+        FC_ASSERT(!compressed, "Reading by position isn't supported by compressed block log");
         detail::read_lock lock(my->mutex);
         std::pair<signed_block, uint64_t> result;
         result.second = my->read_block(pos, result.first);
@@ -283,6 +335,9 @@ namespace golos { namespace chain {
     }
 
     optional<signed_block> block_log::read_block_by_num(uint32_t block_num) const { try {
+        if (compressed) {
+            return compressed->read_block_by_num(block_num);
+        }
         detail::read_lock lock(my->mutex);
         optional<signed_block> result;
         uint64_t pos = my->get_block_pos(block_num);
@@ -298,18 +353,58 @@ namespace golos { namespace chain {
         return result;
     } FC_LOG_AND_RETHROW() }
 
+    bool block_log::read_block_data_by_num(uint32_t block_num, const block_data_handler& handler) const { try {
+        if (compressed) {
+            return compressed->read_block_data_by_num(block_num, handler);
+        }
+        detail::read_lock lock(my->mutex);
+        uint64_t pos = my->get_block_pos(block_num);
+        if (pos == npos) {
+            return false;
+        }
+        my->read_block_data(block_num, pos, handler);
+        return true;
+    } FC_LOG_AND_RETHROW() }
+
     uint64_t block_log::get_block_pos(uint32_t block_num) const {
+        if (compressed) {
+            return compressed->get_block_pos(block_num);
+        }
         detail::read_lock lock(my->mutex);
         return my->get_block_pos(block_num);
     }
 
     signed_block block_log::read_head() const {
+        if (compressed) {
+            return compressed->read_head();
+        }
         detail::read_lock lock(my->mutex);
         return my->read_head();
     }
 
     const optional<signed_block>& block_log::head() const {
+        if (compressed) {
+            return compressed->head();
+        }
         detail::read_lock lock(my->mutex);
         return my->head;
     }
+
+    bool block_log::is_compressed() const {
+        return !!compressed;
+    }
+
+    void block_log::set_cache_size(uint32_t chunks) {
+        cache_size = chunks;
+        if (compressed) {
+            compressed->set_cache_size(chunks);
+        }
+    }
+
+    block_log_cache_stats block_log::get_cache_stats() const {
+        if (compressed) {
+            return compressed->get_cache_stats();
+        }
+        return block_log_cache_stats();
+    }
 } } // golos::chain
@@ -0,0 +1,148 @@
+#include <golos/chain/block_prefetcher.hpp>
+#include <golos/protocol/exceptions.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace chain {
+
+    block_prefetcher::block_prefetcher(
+        const block_log& log, uint32_t from_block_num, uint32_t last_block_num,
+        uint32_t reader_threads, uint32_t queue_depth
+    ) : _block_log(log),
+        _last_block_num(last_block_num),
+        _reader_threads(reader_threads),
+        _slots(std::max<uint32_t>(queue_depth, 1)),
+        _next_read_num(from_block_num),
+        _next_apply_num(from_block_num) {
+    }
+
+    block_prefetcher::~block_prefetcher() {
+        stop();
+    }
+
+    void block_prefetcher::start() {
+        _threads.reserve(_reader_threads);
+        for (uint32_t i = 0; i < _reader_threads; ++i) {
+            _threads.emplace_back([this]{ read_loop(); });
+        }
+    }
+
+    void block_prefetcher::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _is_stopped = true;
+        }
+        _producer_cv.notify_all();
+        _consumer_cv.notify_all();
+
+        for (auto& thread: _threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        _threads.clear();
+    }
+
+    block_prefetcher::slot& block_prefetcher::get_slot(uint32_t block_num) {
+        return _slots[block_num % _slots.size()];
+    }
+
+    void block_prefetcher::read_loop() {
+        while (true) {
+            auto block_num = _next_read_num++;
+            if (block_num > _last_block_num) {
+                return;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (!_is_stopped && block_num >= _next_apply_num + _slots.size()) {
+                    ++_producer_stalls;
+                    _producer_cv.wait(lock, [&]{
+                        return _is_stopped || block_num < _next_apply_num + _slots.size();
+                    });
+                }
+                if (_is_stopped) {
+                    return;
+                }
+            }
+
+            signed_block block;
+            std::exception_ptr error;
+            try {
+                auto result = _block_log.read_block_by_num(block_num);
+                GOLOS_CHECK_DATABASE(result.valid(),
+                    database_corrupted::block_not_found_in_block_log,
+                    "Block ${num} not found in block log", ("num", block_num));
+                block = std::move(*result);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto& s = get_slot(block_num);
+                s.block = std::move(block);
+                s.error = error;
+                s.ready = true;
+                ++_ready_count;
+            }
+            _consumer_cv.notify_one();
+        }
+    }
+
+    signed_block block_prefetcher::next() {
+        GOLOS_CHECK_DATABASE(_next_apply_num <= _last_block_num,
+            database_corrupted::block_not_found_in_block_log,
+            "Block ${num} not found in block log", ("num", _next_apply_num));
+
+        if (!_reader_threads) {
+            auto block_num = _next_apply_num++;
+            auto result = _block_log.read_block_by_num(block_num);
+            GOLOS_CHECK_DATABASE(result.valid(),
+                database_corrupted::block_not_found_in_block_log,
+                "Block ${num} not found in block log", ("num", block_num));
+            return std::move(*result);
+        }
+
+        signed_block block;
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            auto& s = get_slot(_next_apply_num);
+            if (!s.ready) {
+                ++_consumer_stalls;
+                _consumer_cv.wait(lock, [&]{ return s.ready || _is_stopped; });
+            }
+            FC_ASSERT(s.ready, "Block prefetcher was stopped");
+
+            block = std::move(s.block);
+            error = s.error;
+            s.error = nullptr;
+            s.ready = false;
+            --_ready_count;
+            ++_next_apply_num;
+        }
+        // wake all readers, because each of them waits for its own slot
+        _producer_cv.notify_all();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return block;
+    }
+
+    uint32_t block_prefetcher::queue_size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _ready_count;
+    }
+
+    uint64_t block_prefetcher::producer_stalls() const {
+        return _producer_stalls;
+    }
+
+    uint64_t block_prefetcher::consumer_stalls() const {
+        return _consumer_stalls;
+    }
+
+} } // namespace golos::chain
@@ -0,0 +1,137 @@
+#include <golos/chain/block_prevalidator.hpp>
+#include <golos/protocol/config.hpp>
+
+namespace golos { namespace chain {
+
+    bool prevalidated_block::matches(const signed_block& block) const {
+        if (transactions.size() != block.transactions.size()) {
+            return false;
+        }
+        for (std::size_t i = 0, e = transactions.size(); i < e; ++i) {
+            if (transactions[i].merkle_digest != block.transactions[i].merkle_digest()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    block_prevalidator::block_prevalidator() {
+    }
+
+    block_prevalidator::~block_prevalidator() {
+        stop();
+    }
+
+    void block_prevalidator::start(uint32_t threads, uint32_t max_blocks) {
+        if (!threads || !max_blocks) {
+            return;
+        }
+
+        _max_blocks = max_blocks;
+        _io_service.reset(new boost::asio::io_service());
+        _work.reset(new boost::asio::io_service::work(*_io_service));
+        for (uint32_t i = 0; i < threads; ++i) {
+            _thread_pool.create_thread([this]{ _io_service->run(); });
+        }
+    }
+
+    void block_prevalidator::stop() {
+        if (!_io_service) {
+            return;
+        }
+
+        _work.reset();
+        _io_service->stop();
+        _thread_pool.join_all();
+        _io_service.reset();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _results.clear();
+    }
+
+    bool block_prevalidator::is_started() const {
+        return !!_io_service;
+    }
+
+    void block_prevalidator::prevalidate(
+        const signed_block& block, const block_id_type& block_id, bool recover_signatures
+    ) {
+        if (!is_started()) {
+            return;
+        }
+
+        auto task = std::make_shared<std::packaged_task<result_type()>>([block, block_id, recover_signatures]() {
+            return prevalidate_block(block, block_id, recover_signatures);
+        });
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_results.count(block_id)) {
+                return;
+            }
+            if (_results.size() >= _max_blocks) {
+                _results.erase(_results.begin());
+            }
+            _results.emplace(block_id, task->get_future().share());
+        }
+
+        _io_service->post([task]() {
+            (*task)();
+        });
+    }
+
+    std::shared_ptr<const prevalidated_block> block_prevalidator::take(const block_id_type& block_id) {
+        if (!is_started()) {
+            return nullptr;
+        }
+
+        std::shared_future<result_type> result;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto itr = _results.find(block_id);
+            if (itr == _results.end()) {
+                return nullptr;
+            }
+            result = itr->second;
+            _results.erase(itr);
+        }
+
+        try {
+            return result.get();
+        } catch (...) {
+            // a broken promise if the pool was stopped, the block will be checked as usual
+            return nullptr;
+        }
+    }
+
+    block_prevalidator::result_type block_prevalidator::prevalidate_block(
+        const signed_block& block, const block_id_type& block_id, bool recover_signatures
+    ) {
+        auto result = std::make_shared<prevalidated_block>();
+        result->block_id = block_id;
+        result->has_signature_keys = recover_signatures;
+        result->merkle_root = block.calculate_merkle_root();
+
+        const chain_id_type& chain_id = STEEMIT_CHAIN_ID;
+
+        result->transactions.resize(block.transactions.size());
+        for (std::size_t i = 0, e = block.transactions.size(); i < e; ++i) {
+            const auto& trx = block.transactions[i];
+            auto& info = result->transactions[i];
+            info.merkle_digest = trx.merkle_digest();
+            try {
+                trx.validate();
+                if (recover_signatures) {
+                    info.signature_keys = trx.get_signature_keys(chain_id);
+                }
+                info.is_valid = true;
+            } catch (...) {
+                // the write thread repeats the checks and reports the error
+                info.is_valid = false;
+            }
+        }
+
+        return result;
+    }
+
+} } // namespace golos::chain
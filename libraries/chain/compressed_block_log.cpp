@@ -0,0 +1,682 @@
+#include <golos/chain/compressed_block_log.hpp>
+#include <golos/protocol/exceptions.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <zlib.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace golos { namespace chain {
+    namespace detail {
+        using read_write_mutex = boost::shared_mutex;
+        using read_lock = boost::shared_lock<read_write_mutex>;
+        using write_lock = boost::unique_lock<read_write_mutex>;
+
+        static constexpr char compressed_log_magic[8] = {'G', 'O', 'L', 'O', 'S', 'Z', 'B', 'L'};
+        static constexpr uint32_t compressed_log_version = 1;
+        static constexpr uint32_t chunk_is_compressed = 1;
+
+        struct file_header {
+            char magic[8];
+            uint32_t version;
+            uint32_t chunk_blocks;
+        };
+
+        struct chunk_header {
+            uint32_t first_block_num;
+            uint32_t block_count;
+            uint32_t flags;
+            uint32_t raw_size;  ///< size of data after decompression
+            uint32_t data_size; ///< size of data in file
+        };
+
+        static_assert(sizeof(file_header) == 16, "Unexpected padding in the block log header");
+        static_assert(sizeof(chunk_header) == 20, "Unexpected padding in the chunk header");
+
+        static constexpr std::size_t min_valid_index_size = sizeof(uint64_t);
+
+        struct decoded_chunk {
+            uint32_t first_block_num = 0;
+            std::vector<char> data;
+            std::vector<std::pair<uint32_t, uint32_t>> blocks; ///< position and size of each block in data
+        };
+
+        using decoded_chunk_ptr = std::shared_ptr<const decoded_chunk>;
+
+        class compressed_block_log_impl {
+        public:
+            optional<signed_block> head;
+            block_id_type head_id;
+            uint32_t chunk_blocks = 0;
+
+            std::string block_path;
+            std::string index_path;
+            boost::iostreams::mapped_file block_mapped_file;
+            boost::iostreams::mapped_file index_mapped_file;
+            read_write_mutex mutex;
+
+            std::mutex cache_mutex;
+            uint32_t cache_size = 16;
+            std::list<uint32_t> cache_lru; ///< numbers of chunks, the most recently used first
+            std::unordered_map<uint32_t, std::pair<decoded_chunk_ptr, std::list<uint32_t>::iterator>> cache;
+            std::atomic<uint64_t> cache_hits{0};
+            std::atomic<uint64_t> cache_misses{0};
+
+            std::size_t get_block_file_size() const {
+                if (!block_mapped_file.is_open()) {
+                    return 0;
+                }
+                return block_mapped_file.size();
+            }
+
+            std::size_t get_index_file_size() const {
+                auto size = index_mapped_file.size();
+                if (size < min_valid_index_size) {
+                    return 0;
+                }
+                return size;
+            }
+
+            uint32_t get_chunk_count() const {
+                return get_index_file_size() / sizeof(uint64_t);
+            }
+
+            uint64_t get_chunk_pos(uint32_t chunk_num) const {
+                uint64_t value;
+                auto pos = std::size_t(chunk_num) * sizeof(value);
+                auto file_size = get_index_file_size();
+                GOLOS_CHECK_DATABASE(pos + sizeof(value) <= file_size,
+                        database_corrupted::reading_data_beyond_end_of_file,
+                        "Reading data beyond end of file",
+                        ("pos", pos)("size", sizeof(value))("file_size", file_size));
+
+                std::memcpy(&value, index_mapped_file.data() + pos, sizeof(value));
+                return value;
+            }
+
+            chunk_header read_chunk_header(uint64_t pos) const {
+                chunk_header header;
+                auto file_size = get_block_file_size();
+                GOLOS_CHECK_DATABASE(pos + sizeof(header) <= file_size,
+                        database_corrupted::reading_data_beyond_end_of_file,
+                        "Reading data beyond end of file",
+                        ("pos", pos)("size", sizeof(header))("file_size", file_size));
+
+                std::memcpy(&header, block_mapped_file.data() + pos, sizeof(header));
+
+                GOLOS_CHECK_DATABASE(
+                        header.block_count > 0 && header.block_count <= chunk_blocks &&
+                        header.first_block_num > 0 && (header.first_block_num - 1) % chunk_blocks == 0 &&
+                        pos + sizeof(header) + header.data_size <= file_size,
+                        database_corrupted::wrong_chunk_was_read,
+                        "Wrong chunk header was read at position ${pos}",
+                        ("pos", pos)("first_block_num", header.first_block_num)("block_count", header.block_count)
+                        ("data_size", header.data_size)("file_size", file_size));
+
+                return header;
+            }
+
+            void write_chunk_header(uint64_t pos, const chunk_header& header) {
+                std::memcpy(block_mapped_file.data() + pos, &header, sizeof(header));
+            }
+
+            /// Writes the range of the file to disk, so the following writes can't overtake it
+            void sync_block_file(uint64_t pos, uint64_t size) {
+                const auto page_size = uint64_t(sysconf(_SC_PAGESIZE));
+                const auto start = pos / page_size * page_size;
+                auto ret = msync(block_mapped_file.data() + start, pos + size - start, MS_SYNC);
+                FC_ASSERT(ret == 0, "Can't sync block log: ${e}", ("e", std::strerror(errno))("pos", pos)("size", size));
+            }
+
+            /**
+             * Replaces the raw data of the full chunk with its compressed data, so that the file can be
+             *   recovered if the daemon is killed at any moment:
+             *   1. the compressed copy of the chunk is written after the end of the file and synced with the raw chunk,
+             *   2. the compressed data is copied over the raw data, the header is updated after the data is synced,
+             *   3. the file is truncated after the compressed chunk.
+             * On opening, construct_index() repeats steps 2-3 if the copy is found after the raw chunk.
+             */
+            void seal_chunk(uint64_t chunk_pos, chunk_header& header) {
+                const auto* raw = block_mapped_file.const_data() + chunk_pos + sizeof(header);
+                uLongf compressed_size = compressBound(header.raw_size);
+                std::vector<char> compressed(compressed_size);
+
+                auto ret = compress2(
+                    reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                    reinterpret_cast<const Bytef*>(raw), header.raw_size, Z_DEFAULT_COMPRESSION);
+                FC_ASSERT(ret == Z_OK, "Can't compress chunk of block log", ("error", ret));
+
+                // the raw data should have room for the compressed data and the cleared header after it
+                if (compressed_size + sizeof(header) > header.raw_size) {
+                    return;
+                }
+
+                chunk_header copy = header;
+                copy.flags |= chunk_is_compressed;
+                copy.data_size = compressed_size;
+
+                const auto copy_pos = get_block_file_size();
+                block_mapped_file.resize(copy_pos + sizeof(copy) + compressed_size);
+                std::memcpy(block_mapped_file.data() + copy_pos + sizeof(copy), compressed.data(), compressed_size);
+                write_chunk_header(copy_pos, copy);
+                // the raw chunk is synced too, it is needed to find the copy on recovery
+                sync_block_file(chunk_pos, get_block_file_size() - chunk_pos);
+
+                apply_sealed_copy(chunk_pos, copy_pos);
+                header = copy;
+            }
+
+            void apply_sealed_copy(uint64_t chunk_pos, uint64_t copy_pos) {
+                chunk_header copy;
+                std::memcpy(&copy, block_mapped_file.const_data() + copy_pos, sizeof(copy));
+
+                auto* data = block_mapped_file.data() + chunk_pos + sizeof(copy);
+                std::memcpy(data, block_mapped_file.const_data() + copy_pos + sizeof(copy), copy.data_size);
+                // the rest of the raw data can't be taken for the next chunk
+                std::memset(data + copy.data_size, 0, sizeof(copy));
+                sync_block_file(chunk_pos + sizeof(copy), copy.data_size + sizeof(copy));
+
+                write_chunk_header(chunk_pos, copy);
+                sync_block_file(chunk_pos, sizeof(copy));
+
+                block_mapped_file.resize(chunk_pos + sizeof(copy) + copy.data_size);
+            }
+
+            /// Checks that the compressed copy of the raw chunk was completely written before the daemon was killed
+            bool is_sealed_copy(const chunk_header& header, uint64_t copy_pos) const {
+                chunk_header copy;
+                if (copy_pos + sizeof(copy) > get_block_file_size()) {
+                    return false;
+                }
+                std::memcpy(&copy, block_mapped_file.const_data() + copy_pos, sizeof(copy));
+
+                if ((header.flags & chunk_is_compressed) || !(copy.flags & chunk_is_compressed) ||
+                    copy.first_block_num != header.first_block_num || copy.block_count != header.block_count ||
+                    copy.raw_size != header.raw_size || copy.data_size + sizeof(copy) > header.raw_size ||
+                    copy_pos + sizeof(copy) + copy.data_size != get_block_file_size()
+                ) {
+                    return false;
+                }
+
+                try {
+                    decode_chunk(copy_pos);
+                    return true;
+                } catch (const fc::exception&) {
+                    return false;
+                }
+            }
+
+            decoded_chunk_ptr decode_chunk(uint64_t pos) const {
+                auto header = read_chunk_header(pos);
+                const auto* src = block_mapped_file.const_data() + pos + sizeof(header);
+
+                auto result = std::make_shared<decoded_chunk>();
+                result->first_block_num = header.first_block_num;
+                result->data.resize(header.raw_size);
+
+                if (header.flags & chunk_is_compressed) {
+                    uLongf size = header.raw_size;
+                    auto ret = uncompress(
+                        reinterpret_cast<Bytef*>(result->data.data()), &size,
+                        reinterpret_cast<const Bytef*>(src), header.data_size);
+                    GOLOS_CHECK_DATABASE(ret == Z_OK && size == header.raw_size,
+                            database_corrupted::wrong_chunk_was_read,
+                            "Can't decompress chunk at position ${pos}",
+                            ("pos", pos)("error", ret)("size", size)("expected", header.raw_size));
+                } else {
+                    GOLOS_CHECK_DATABASE(header.raw_size == header.data_size,
+                            database_corrupted::wrong_chunk_was_read,
+                            "Wrong size of uncompressed chunk at position ${pos}",
+                            ("pos", pos)("raw_size", header.raw_size)("data_size", header.data_size));
+                    std::memcpy(result->data.data(), src, header.raw_size);
+                }
+
+                result->blocks.reserve(header.block_count);
+                uint32_t offset = 0;
+                for (uint32_t i = 0; i < header.block_count; ++i) {
+                    uint32_t size;
+                    GOLOS_CHECK_DATABASE(offset + sizeof(size) <= header.raw_size,
+                            database_corrupted::wrong_chunk_was_read,
+                            "Wrong chunk data was read at position ${pos}", ("pos", pos)("block", i));
+                    std::memcpy(&size, result->data.data() + offset, sizeof(size));
+                    offset += sizeof(size);
+
+                    GOLOS_CHECK_DATABASE(offset + size <= header.raw_size,
+                            database_corrupted::wrong_chunk_was_read,
+                            "Wrong chunk data was read at position ${pos}", ("pos", pos)("block", i));
+                    result->blocks.emplace_back(offset, size);
+                    offset += size;
+                }
+
+                return result;
+            }
+
+            decoded_chunk_ptr get_chunk(uint32_t chunk_num) {
+                {
+                    std::lock_guard<std::mutex> lock(cache_mutex);
+                    auto itr = cache.find(chunk_num);
+                    if (itr != cache.end()) {
+                        cache_lru.splice(cache_lru.begin(), cache_lru, itr->second.second);
+                        ++cache_hits;
+                        return itr->second.first;
+                    }
+                }
+                ++cache_misses;
+
+                // decompression doesn't need the cache lock, so other readers aren't blocked
+                auto chunk = decode_chunk(get_chunk_pos(chunk_num));
+
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                if (cache_size && !cache.count(chunk_num)) {
+                    while (cache.size() >= cache_size) {
+                        cache.erase(cache_lru.back());
+                        cache_lru.pop_back();
+                    }
+                    cache_lru.push_front(chunk_num);
+                    cache.emplace(chunk_num, std::make_pair(chunk, cache_lru.begin()));
+                }
+                return chunk;
+            }
+
+            void forget_chunk(uint32_t chunk_num) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto itr = cache.find(chunk_num);
+                if (itr != cache.end()) {
+                    cache_lru.erase(itr->second.second);
+                    cache.erase(itr);
+                }
+            }
+
+            void clear_cache() {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                cache.clear();
+                cache_lru.clear();
+            }
+
+            void set_cache_size(uint32_t value) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                cache_size = value;
+                while (cache.size() > cache_size) {
+                    cache.erase(cache_lru.back());
+                    cache_lru.pop_back();
+                }
+            }
+
+            static void unpack_block(const decoded_chunk& chunk, uint32_t idx, signed_block& block) {
+                const auto& item = chunk.blocks[idx];
+                fc::datastream<const char*> ds(chunk.data.data() + item.first, item.second);
+                fc::raw::unpack(ds, block);
+            }
+
+            decoded_chunk_ptr get_chunk_with_block(uint32_t block_num, uint32_t& idx) {
+                auto chunk = get_chunk((block_num - 1) / chunk_blocks);
+                idx = block_num - chunk->first_block_num;
+                GOLOS_CHECK_DATABASE(idx < chunk->blocks.size(),
+                        database_corrupted::wrong_block_num_was_read,
+                        "Block ${block_num} is absent in its chunk",
+                        ("block_num", block_num)("first_block_num", chunk->first_block_num)
+                        ("block_count", chunk->blocks.size()));
+                return chunk;
+            }
+
+            void read_block(uint32_t block_num, signed_block& block) {
+                uint32_t idx;
+                auto chunk = get_chunk_with_block(block_num, idx);
+                unpack_block(*chunk, idx, block);
+            }
+
+            void read_block_data(uint32_t block_num, const block_data_handler& handler) {
+                uint32_t idx;
+                auto chunk = get_chunk_with_block(block_num, idx);
+                const auto& item = chunk->blocks[idx];
+                handler(chunk->data.data() + item.first, item.second);
+            }
+
+            uint64_t get_block_pos(uint32_t block_num) const {
+                if (head.valid() &&
+                    block_num <= protocol::block_header::num_from_id(head_id) &&
+                    block_num > 0
+                ) {
+                    return get_chunk_pos((block_num - 1) / chunk_blocks);
+                }
+                return compressed_block_log::npos;
+            }
+
+            signed_block read_head() const {
+                auto chunk = decode_chunk(get_chunk_pos(get_chunk_count() - 1));
+                signed_block block;
+                unpack_block(*chunk, chunk->blocks.size() - 1, block);
+                return block;
+            }
+
+            void create_nonexist_file(const std::string& path) const {
+                if (!boost::filesystem::is_regular_file(path) || boost::filesystem::file_size(path) == 0) {
+                    std::ofstream stream(path, std::ios::out|std::ios::binary);
+                    stream << '\0';
+                    stream.close();
+                }
+            }
+
+            void create_block_file(uint32_t new_chunk_blocks) const {
+                FC_ASSERT(new_chunk_blocks > 0, "Number of blocks in a chunk should be positive");
+
+                file_header header;
+                std::memcpy(header.magic, compressed_log_magic, sizeof(header.magic));
+                header.version = compressed_log_version;
+                header.chunk_blocks = new_chunk_blocks;
+
+                std::ofstream stream(block_path, std::ios::out|std::ios::binary|std::ios::trunc);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                stream.close();
+            }
+
+            void open_index_mapped_file() {
+                create_nonexist_file(index_path);
+                index_mapped_file.open(index_path, boost::iostreams::mapped_file::readwrite);
+            }
+
+            /**
+             * The index is valid if its last record points to the last chunk of the file,
+             * and the number of records matches the first block of this chunk.
+             */
+            bool is_index_valid() const {
+                auto index_size = get_index_file_size();
+                if (!index_size || index_size % sizeof(uint64_t)) {
+                    return false;
+                }
+
+                chunk_header header;
+                auto pos = get_chunk_pos(get_chunk_count() - 1);
+                auto file_size = get_block_file_size();
+                if (pos < sizeof(file_header) || pos + sizeof(header) > file_size) {
+                    return false;
+                }
+                std::memcpy(&header, block_mapped_file.const_data() + pos, sizeof(header));
+
+                return
+                    pos + sizeof(header) + header.data_size == file_size &&
+                    header.block_count > 0 && header.block_count <= chunk_blocks &&
+                    header.first_block_num == (get_chunk_count() - 1) * chunk_blocks + 1;
+            }
+
+            void construct_index() {
+                ilog("Reconstructing Block Log Index...");
+                index_mapped_file.close();
+                boost::filesystem::remove_all(index_path);
+                open_index_mapped_file();
+
+                std::vector<uint64_t> positions;
+                uint64_t pos = sizeof(file_header);
+                uint64_t file_size = get_block_file_size();
+
+                while (pos + sizeof(chunk_header) <= file_size) {
+                    chunk_header header;
+                    std::memcpy(&header, block_mapped_file.const_data() + pos, sizeof(header));
+
+                    if (header.first_block_num != positions.size() * chunk_blocks + 1 ||
+                        header.block_count == 0 || header.block_count > chunk_blocks ||
+                        pos + sizeof(header) + header.data_size > file_size
+                    ) {
+                        break;
+                    }
+
+                    positions.push_back(pos);
+                    pos += sizeof(header) + header.data_size;
+
+                    if (header.block_count < chunk_blocks) {
+                        // only the last chunk can be not full
+                        break;
+                    }
+
+                    if (is_sealed_copy(header, pos)) {
+                        wlog("Completing compression of the chunk at ${pos}, interrupted when the daemon was killed",
+                            ("pos", positions.back()));
+                        apply_sealed_copy(positions.back(), pos);
+                        file_size = get_block_file_size();
+                        pos = file_size;
+                        break;
+                    }
+                }
+
+                if (pos != file_size) {
+                    // it happens if the daemon was killed on appending of a block
+                    wlog("Truncating block log from ${size} to ${pos} bytes, after the last valid chunk",
+                        ("size", file_size)("pos", pos));
+                    block_mapped_file.resize(pos);
+                }
+
+                if (!positions.empty()) {
+                    index_mapped_file.resize(positions.size() * sizeof(uint64_t));
+                    std::memcpy(index_mapped_file.data(), positions.data(), positions.size() * sizeof(uint64_t));
+                }
+            }
+
+            void open(const fc::path& file, uint32_t new_chunk_blocks) { try {
+                close();
+
+                block_path = file.string();
+                index_path = boost::filesystem::path(file.string() + ".index").string();
+
+                if (!boost::filesystem::is_regular_file(block_path) ||
+                    boost::filesystem::file_size(block_path) < sizeof(file_header)
+                ) {
+                    ilog("Creating compressed block log with ${n} blocks in a chunk", ("n", new_chunk_blocks));
+                    create_block_file(new_chunk_blocks);
+                    boost::filesystem::remove_all(index_path);
+                }
+
+                block_mapped_file.open(block_path, boost::iostreams::mapped_file::readwrite);
+                open_index_mapped_file();
+
+                file_header header;
+                std::memcpy(&header, block_mapped_file.const_data(), sizeof(header));
+                GOLOS_CHECK_DATABASE(
+                        std::memcmp(header.magic, compressed_log_magic, sizeof(header.magic)) == 0 &&
+                        header.version == compressed_log_version && header.chunk_blocks > 0,
+                        database_corrupted::unsupported_block_log_version,
+                        "Unsupported format of block log ${path}",
+                        ("path", block_path)("version", header.version)("expected", compressed_log_version));
+                chunk_blocks = header.chunk_blocks;
+
+                if (get_block_file_size() > sizeof(file_header)) {
+                    ilog("Log is nonempty");
+                    if (!is_index_valid()) {
+                        construct_index();
+                    }
+                } else if (get_index_file_size()) {
+                    ilog("Index is nonempty, remove and recreate it");
+                    index_mapped_file.close();
+                    boost::filesystem::remove_all(index_path);
+                    open_index_mapped_file();
+                }
+
+                if (get_chunk_count()) {
+                    head = read_head();
+                    head_id = head->id();
+                }
+            } FC_LOG_AND_RETHROW() }
+
+            uint64_t append(const signed_block& b, const std::vector<char>& data) { try {
+                const uint32_t block_num = b.block_num();
+                const uint32_t head_num = head.valid() ? head->block_num() : 0;
+
+                GOLOS_CHECK_DATABASE(block_num == head_num + 1,
+                    database_corrupted::append_index_file_at_wrong_position,
+                    "Append to block log occuring at wrong position.",
+                    ("block_num", block_num)("expected", head_num + 1));
+
+                const uint32_t chunk_num = (block_num - 1) / chunk_blocks;
+                const uint32_t entry_size = sizeof(uint32_t) + data.size();
+                chunk_header header;
+                uint64_t chunk_pos;
+
+                if ((block_num - 1) % chunk_blocks == 0) {
+                    chunk_pos = get_block_file_size();
+                    header = {block_num, 0, 0, 0, 0};
+
+                    const auto index_pos = get_index_file_size();
+                    GOLOS_CHECK_DATABASE(index_pos == sizeof(uint64_t) * chunk_num,
+                        database_corrupted::append_index_file_at_wrong_position,
+                        "Append to index file occuring at wrong position.",
+                        ("position", index_pos)("expected", chunk_num * sizeof(uint64_t)));
+
+                    index_mapped_file.resize(index_pos + sizeof(chunk_pos));
+                    std::memcpy(index_mapped_file.data() + index_pos, &chunk_pos, sizeof(chunk_pos));
+
+                    block_mapped_file.resize(chunk_pos + sizeof(header));
+                } else {
+                    chunk_pos = get_chunk_pos(chunk_num);
+                    header = read_chunk_header(chunk_pos);
+                    GOLOS_CHECK_DATABASE(
+                        !(header.flags & chunk_is_compressed) &&
+                        chunk_pos + sizeof(header) + header.data_size == get_block_file_size(),
+                        database_corrupted::wrong_chunk_was_read,
+                        "The last chunk of block log can't be appended",
+                        ("pos", chunk_pos)("flags", header.flags));
+                }
+
+                const auto data_pos = get_block_file_size();
+                block_mapped_file.resize(data_pos + entry_size);
+                auto* ptr = block_mapped_file.data() + data_pos;
+                const uint32_t size = data.size();
+                std::memcpy(ptr, &size, sizeof(size));
+                std::memcpy(ptr + sizeof(size), data.data(), data.size());
+
+                header.block_count++;
+                header.raw_size += entry_size;
+                header.data_size += entry_size;
+                write_chunk_header(chunk_pos, header);
+
+                if (header.block_count == chunk_blocks) {
+                    seal_chunk(chunk_pos, header);
+                }
+
+                forget_chunk(chunk_num);
+
+                head = b;
+                head_id = b.id();
+                return chunk_pos;
+            } FC_LOG_AND_RETHROW() }
+
+            void close() {
+                block_mapped_file.close();
+                index_mapped_file.close();
+                head.reset();
+                head_id = block_id_type();
+                clear_cache();
+            }
+        };
+    }
+
+    compressed_block_log::compressed_block_log()
+            : my(std::make_unique<detail::compressed_block_log_impl>()) {
+    }
+
+    compressed_block_log::~compressed_block_log() {
+    }
+
+    bool compressed_block_log::is_compressed_file(const fc::path& file) {
+        if (!boost::filesystem::is_regular_file(file.string()) ||
+            boost::filesystem::file_size(file.string()) < sizeof(detail::file_header)
+        ) {
+            return false;
+        }
+
+        char magic[sizeof(detail::compressed_log_magic)];
+        std::ifstream stream(file.string(), std::ios::in|std::ios::binary);
+        stream.read(magic, sizeof(magic));
+        return stream && std::memcmp(magic, detail::compressed_log_magic, sizeof(magic)) == 0;
+    }
+
+    void compressed_block_log::open(const fc::path& file, uint32_t chunk_blocks) {
+        detail::write_lock lock(my->mutex);
+        my->open(file, chunk_blocks);
+    }
+
+    void compressed_block_log::close() {
+        detail::write_lock lock(my->mutex);
+        my->close();
+    }
+
+    bool compressed_block_log::is_open() const {
+        detail::read_lock lock(my->mutex);
+        return my->block_mapped_file.is_open();
+    }
+
+    uint64_t compressed_block_log::append(const signed_block& block, const std::vector<char>& data) {
+        detail::write_lock lock(my->mutex);
+        return my->append(block, data);
+    }
+
+    optional<signed_block> compressed_block_log::read_block_by_num(uint32_t block_num) const { try {
+        detail::read_lock lock(my->mutex);
+        optional<signed_block> result;
+        if (my->get_block_pos(block_num) != npos) {
+            signed_block block;
+            my->read_block(block_num, block);
+            GOLOS_CHECK_DATABASE(block.block_num() == block_num,
+                database_corrupted::wrong_block_num_was_read,
+                "Wrong block was read from block log (read ${block_num}, expected ${expected}).",
+                ("block_num", block.block_num())("expected", block_num));
+            result = std::move(block);
+        }
+        return result;
+    } FC_LOG_AND_RETHROW() }
+
+    bool compressed_block_log::read_block_data_by_num(
+        uint32_t block_num, const block_data_handler& handler
+    ) const { try {
+        detail::read_lock lock(my->mutex);
+        if (my->get_block_pos(block_num) == npos) {
+            return false;
+        }
+        my->read_block_data(block_num, handler);
+        return true;
+    } FC_LOG_AND_RETHROW() }
+
+    uint64_t compressed_block_log::get_block_pos(uint32_t block_num) const {
+        detail::read_lock lock(my->mutex);
+        return my->get_block_pos(block_num);
+    }
+
+    signed_block compressed_block_log::read_head() const {
+        detail::read_lock lock(my->mutex);
+        return my->read_head();
+    }
+
+    const optional<signed_block>& compressed_block_log::head() const {
+        detail::read_lock lock(my->mutex);
+        return my->head;
+    }
+
+    uint32_t compressed_block_log::chunk_blocks() const {
+        detail::read_lock lock(my->mutex);
+        return my->chunk_blocks;
+    }
+
+    void compressed_block_log::set_cache_size(uint32_t chunks) {
+        my->set_cache_size(chunks);
+    }
+
+    block_log_cache_stats compressed_block_log::get_cache_stats() const {
+        block_log_cache_stats stats;
+        stats.hits = my->cache_hits;
+        stats.misses = my->cache_misses;
+
+        std::lock_guard<std::mutex> lock(my->cache_mutex);
+        stats.size = my->cache.size();
+        stats.max_size = my->cache_size;
+        return stats;
+    }
+} } // golos::chain
@@ -3,7 +3,10 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 
 #include <golos/protocol/steem_operations.hpp>
+#include <golos/protocol/signature_cache.hpp>
 
+#include <golos/chain/block_prefetcher.hpp>
+#include <golos/chain/block_prevalidator.hpp>
 #include <golos/chain/block_summary_object.hpp>
 #include <golos/chain/compound.hpp>
 #include <golos/chain/custom_operation_interpreter.hpp>
@@ -74,6 +77,13 @@ namespace golos { namespace chain {
             return v;
         }
 
+        namespace {
+            /// Version of the layout of objects in shared memory, it should be increased when the layout changes,
+            ///   because the state of another version can't be read and should be replayed
+            const uint32_t state_version = 1;
+            const char state_version_name[] = "golos_state_version";
+        }
+
         class signal_guard {
             struct sigaction old_hup_action, old_int_action, old_term_action;
 
@@ -192,10 +202,31 @@ namespace golos { namespace chain {
                 wlog("Start opening database. Please wait, don't break application...");
 
                 init_schema();
+
+                auto huge_page_size = hugetlbfs_page_size(shared_mem_dir);
+                if (huge_page_size) {
+                    ilog("Shared memory is on hugetlbfs with ${n}K pages", ("n", huge_page_size / 1024));
+                    FC_ASSERT(shared_file_size % huge_page_size == 0 && _inc_shared_memory_size % huge_page_size == 0,
+                        "Sizes of shared memory on hugetlbfs should be multiples of the huge page size",
+                        ("shared_file_size", shared_file_size)("inc_shared_file_size", _inc_shared_memory_size)
+                        ("huge_page_size", huge_page_size));
+                }
+
                 chainbase::database::open(shared_mem_dir, chainbase_flags, shared_file_size);
+                _growth.set_file((shared_mem_dir / "shared_memory.bin").string());
+
+                auto mapping = get_shared_memory_mapping();
+                if (_shared_memory_advice != shared_memory_advice_normal) {
+                    ilog("Shared memory advice: ${a}", ("a", shared_memory_advice_to_string(_shared_memory_advice)));
+                    advise_shared_memory(mapping.first, mapping.second, _shared_memory_advice);
+                }
+                if (_shared_memory_prefault_threads) {
+                    prefault_shared_memory(mapping.first, mapping.second, _shared_memory_prefault_threads);
+                }
 
                 initialize_indexes();
                 initialize_evaluators();
+                check_state_version(chainbase_flags & chainbase::database::read_write);
 
                 auto end = fc::time_point::now();
                 wlog("Done opening database, elapsed time ${t} sec", ("t", double((end - start).count()) / 1000000.0));
@@ -206,11 +237,16 @@ namespace golos { namespace chain {
 
                     if (!find<dynamic_global_property_object>()) {
                         with_strong_write_lock([&]() {
-                            init_genesis(initial_supply);
+                            if (_snapshot_to_import.empty()) {
+                                init_genesis(initial_supply);
+                            } else {
+                                import_snapshot(_snapshot_to_import);
+                            }
                         });
                     }
 
-                    _block_log.open(data_dir / "block_log");
+                    _block_log.set_cache_size(_block_log_cache_chunks);
+                    _block_log.open(data_dir / "block_log", _block_log_chunk_blocks);
 
                     // Rewind all undo state. This should return us to the state at the last irreversible block.
                     with_strong_write_lock([&]() {
@@ -279,6 +315,10 @@ namespace golos { namespace chain {
                     auto last_block_pos = _block_log.get_block_pos(last_block_num);
                     int last_reindex_percent = 0;
 
+                    block_prefetcher prefetcher(
+                        _block_log, cur_block_num, last_block_num, _replay_reader_threads, _replay_prefetch_blocks);
+                    prefetcher.start();
+
                     set_reserved_memory(1024*1024*1024); // protect from memory fragmentations ...
                     while (cur_block_num < last_block_num) {
                         if (signal_guard::get_is_interrupted()) {
@@ -287,7 +327,7 @@ namespace golos { namespace chain {
 
                         auto end = fc::time_point::now();
                         auto cur_block_pos = _block_log.get_block_pos(cur_block_num);
-                        auto cur_block = *_block_log.read_block_by_num(cur_block_num);
+                        auto cur_block = prefetcher.next();
 
                         auto reindex_percent = cur_block_pos * 100 / last_block_pos;
                         if (reindex_percent - last_reindex_percent >= 1) {
@@ -295,7 +335,10 @@ namespace golos { namespace chain {
                                 << "   " << reindex_percent << "%   "
                                 << cur_block_num << " of " << last_block_num
                                 << "   ("  << (free_memory() / (1024 * 1024)) << "M free"
-                                << ", elapsed " << double((end - start).count()) / 1000000.0 << " sec)\n";
+                                << ", elapsed " << double((end - start).count()) / 1000000.0 << " sec"
+                                << ", prefetched " << prefetcher.queue_size()
+                                << ", stalls " << prefetcher.consumer_stalls() << "/" << prefetcher.producer_stalls()
+                                << ")\n";
 
                             last_reindex_percent = reindex_percent;
                         }
@@ -310,10 +353,21 @@ namespace golos { namespace chain {
                         cur_block_num++;
                     }
 
-                    auto cur_block = *_block_log.read_block_by_num(cur_block_num);
+                    auto cur_block = prefetcher.next();
                     apply_block(cur_block, skip_flags);
                     set_reserved_memory(0);
                     set_revision(head_block_num());
+
+                    prefetcher.stop();
+                    ilog(
+                        "Block prefetch stalls: apply thread waited for blocks ${c} times, "
+                        "readers waited for apply thread ${p} times",
+                        ("c", prefetcher.consumer_stalls())("p", prefetcher.producer_stalls()));
+
+                    if (_block_log.is_compressed()) {
+                        auto stats = _block_log.get_cache_stats();
+                        ilog("Block log chunk cache: ${h} hits, ${m} misses", ("h", stats.hits)("m", stats.misses));
+                    }
                 });
 
                 if (signal_guard::get_is_interrupted()) {
@@ -333,6 +387,207 @@ namespace golos { namespace chain {
 
         }
 
+        void database::apply_irreversible_block(const signed_block &block) {
+            try {
+                const uint32_t skip_flags =
+                        skip_block_size_check |
+                        skip_witness_signature |
+                        skip_transaction_signatures |
+                        skip_transaction_dupe_check |
+                        skip_tapos_check |
+                        skip_merkle_check |
+                        skip_witness_schedule_check |
+                        skip_authority_check |
+                        skip_validate_operations |
+                        skip_validate_invariants |
+                        skip_block_log;
+
+                FC_ASSERT(block.block_num() == head_block_num() + 1, "Block doesn't follow the head block",
+                    ("block_num", block.block_num())("head_block_num", head_block_num()));
+
+                apply_block(block, skip_flags);
+                set_revision(head_block_num());
+
+                _block_log.append(block);
+                _block_log.flush();
+            }
+            FC_CAPTURE_AND_RETHROW()
+        }
+
+        void database::add_reindexable_plugin(const std::string& plugin, plugin_reindex_handlers handlers) {
+            _plugin_reindex_handlers[plugin] = std::move(handlers);
+        }
+
+        plugins_reindex_info database::reindex_plugins(const std::vector<std::string>& plugins) {
+            try {
+                FC_ASSERT(!plugins.empty(), "No plugins to reindex");
+
+                std::vector<const plugin_reindex_handlers*> handlers;
+                for (const auto& plugin: plugins) {
+                    auto itr = _plugin_reindex_handlers.find(plugin);
+                    FC_ASSERT(itr != _plugin_reindex_handlers.end(),
+                        "Plugin ${plugin} can't be reindexed: it isn't enabled, or its state depends on virtual operations, "
+                        "which are generated only by the replay", ("plugin", plugin));
+                    handlers.push_back(&itr->second);
+                }
+
+                signal_guard sg;
+
+                auto start = fc::time_point::now();
+                plugins_reindex_info info;
+
+                with_strong_write_lock([&]() {
+                    auto last_block_num = head_block_num();
+                    FC_ASSERT(revision() == int64_t(last_block_num) && (!last_block_num || _block_log.head()),
+                        "Plugins can be reindexed only at the state of the block from the block log",
+                        ("revision", revision())("head_block_num", last_block_num));
+
+                    ilog("Reindexing plugins ${plugins} up to block ${n}...", ("plugins", plugins)("n", last_block_num));
+
+                    for (const auto& plugin: plugins) {
+                        auto itr = _plugin_index_cleaners.find(plugin);
+                        if (itr == _plugin_index_cleaners.end()) {
+                            continue;
+                        }
+                        for (const auto& clear: itr->second) {
+                            clear();
+                        }
+                    }
+
+                    if (!last_block_num) {
+                        return;
+                    }
+
+                    block_prefetcher prefetcher(
+                        _block_log, 1, last_block_num, _replay_reader_threads, _replay_prefetch_blocks);
+                    prefetcher.start();
+
+                    // plugins take the number and the time of block from the global properties,
+                    //   they are moved along the reindexed blocks and restored after reindexing
+                    const auto& props = get_dynamic_global_properties();
+                    const auto head_id = props.head_block_id;
+                    const auto head_time = props.time;
+                    auto restore_head = [&]() {
+                        modify(props, [&](dynamic_global_property_object& dgp) {
+                            dgp.head_block_number = last_block_num;
+                            dgp.head_block_id = head_id;
+                            dgp.time = head_time;
+                        });
+                        _is_reindexing_plugins = false;
+                        prefetcher.stop();
+                    };
+
+                    _is_reindexing_plugins = true;
+                    try {
+                        int last_reindex_percent = 0;
+                        for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+                            if (signal_guard::get_is_interrupted()) {
+                                break;
+                            }
+
+                            auto block = prefetcher.next();
+                            notify_block_operations(block, handlers, info);
+
+                            int reindex_percent = uint64_t(block_num) * 100 / last_block_num;
+                            if (reindex_percent - last_reindex_percent >= 1) {
+                                auto now = fc::time_point::now();
+                                std::cerr
+                                    << "   " << reindex_percent << "%   "
+                                    << block_num << " of " << last_block_num
+                                    << "   (" << info.operations << " operations"
+                                    << ", elapsed " << double((now - start).count()) / 1000000.0 << " sec)\n";
+                                last_reindex_percent = reindex_percent;
+                            }
+
+                            check_free_memory(true, block_num);
+                        }
+                    } catch (...) {
+                        restore_head();
+                        throw;
+                    }
+                    restore_head();
+                });
+
+                if (signal_guard::get_is_interrupted()) {
+                    sg.restore();
+                    wlog("Reindexing of plugins is interrupted, the state of plugins is incomplete");
+
+                    appbase::app().quit();
+                    return info;
+                }
+
+                auto end = fc::time_point::now();
+                ilog("Done reindexing plugins, ${o} operations (${f} failed in plugins), elapsed time: ${t} sec",
+                    ("o", info.operations)("f", info.failed_operations)
+                    ("t", double((end - start).count()) / 1000000.0));
+                return info;
+            }
+            FC_CAPTURE_AND_RETHROW((plugins))
+        }
+
+        void database::notify_block_operations(
+            const signed_block &block, const std::vector<const plugin_reindex_handlers*> &handlers,
+            plugins_reindex_info &info
+        ) {
+            const auto& props = get_dynamic_global_properties();
+
+            // operations are applied on the state of the previous block
+            modify(props, [&](dynamic_global_property_object& dgp) {
+                dgp.head_block_number = block.block_num() - 1;
+                dgp.head_block_id = block.previous;
+            });
+
+            // only handlers of the reindexed plugins are called, other subscribers (e.g. external sinks)
+            //   have already got these operations and blocks
+            uint32_t trx_in_block = 0;
+            for (const auto &trx : block.transactions) {
+                auto trx_id = trx.id();
+                uint16_t op_in_trx = 0;
+                for (const auto &op : trx.operations) {
+                    operation_notification note(op);
+                    note.trx_id = trx_id;
+                    note.block = block.block_num();
+                    note.trx_in_block = trx_in_block;
+                    note.op_in_trx = op_in_trx;
+
+                    try {
+                        for (auto h: handlers) {
+                            if (h->pre_apply_operation) {
+                                h->pre_apply_operation(note);
+                            }
+                        }
+                        for (auto h: handlers) {
+                            if (h->post_apply_operation) {
+                                h->post_apply_operation(note);
+                            }
+                        }
+                    } catch (const fc::exception &) {
+                        // plugin reads the state as of the head block, it can miss objects which were removed
+                        ++info.failed_operations;
+                    }
+                    ++info.operations;
+                    ++op_in_trx;
+                }
+                ++trx_in_block;
+            }
+
+            modify(props, [&](dynamic_global_property_object& dgp) {
+                dgp.head_block_number = block.block_num();
+                dgp.head_block_id = block.id();
+                dgp.time = block.timestamp;
+            });
+
+            for (auto h: handlers) {
+                if (h->applied_block) {
+                    try {
+                        h->applied_block(block);
+                    } catch (const fc::exception& e) {
+                        wlog("Plugin failed on reindexed block ${n}: ${e}", ("n", block.block_num())("e", e.to_detail_string()));
+                    }
+                }
+            }
+        }
+
         void database::set_min_free_shared_memory_size(size_t value) {
             _min_free_shared_memory_size = value;
         }
@@ -345,6 +600,69 @@ namespace golos { namespace chain {
             _block_num_check_free_memory = value;
         }
 
+        void database::set_recent_transaction_cache_size(uint32_t value) {
+            _recent_transactions.set_max_size(value);
+        }
+
+        void database::set_shared_memory_advice(uint32_t advice) {
+            _shared_memory_advice = advice;
+        }
+
+        void database::set_shared_memory_prefault_threads(uint32_t threads) {
+            _shared_memory_prefault_threads = threads;
+        }
+
+        void database::set_replay_reader_threads(uint32_t value) {
+            _replay_reader_threads = value;
+        }
+
+        void database::set_replay_prefetch_blocks(uint32_t value) {
+            _replay_prefetch_blocks = value;
+        }
+
+        void database::set_block_log_chunk_blocks(uint32_t value) {
+            _block_log_chunk_blocks = value;
+        }
+
+        void database::set_block_log_cache_chunks(uint32_t value) {
+            _block_log_cache_chunks = value;
+            _block_log.set_cache_size(value);
+        }
+
+        void database::check_state_version(bool is_writable) {
+            auto segment = get_segment_manager();
+            auto version = segment->find<uint32_t>(state_version_name).first;
+
+            if (!find<dynamic_global_property_object>()) {
+                // the new state is created by this version
+                if (is_writable && !version) {
+                    segment->construct<uint32_t>(state_version_name)(state_version);
+                }
+                return;
+            }
+
+            if (!version || *version != state_version) {
+                FC_THROW_EXCEPTION(database_state_version_exception,
+                    "Layout of the chain state was changed (state version ${version}, required ${required}), "
+                    "replay is required",
+                    ("version", version ? *version : 0)("required", state_version));
+            }
+        }
+
+        std::pair<char*, std::size_t> database::get_shared_memory_mapping() {
+            // the segment manager is placed after the header of the mapped file
+            auto segment = get_segment_manager();
+            return page_aligned_range(reinterpret_cast<char*>(segment), segment->get_size());
+        }
+
+        void database::set_apply_timing_log_interval(uint32_t value) {
+            _apply_timing_log_interval = value;
+        }
+
+        apply_timing_info database::clear_apply_timing_stats() {
+            return _apply_timing.clear();
+        }
+
 
         void database::set_store_account_metadata(store_metadata_modes store_account_metadata) {
             _store_account_metadata = store_account_metadata;
@@ -386,8 +704,22 @@ namespace golos { namespace chain {
             wlog(
                 "Memory is almost full on block ${block}, increasing to ${mem}M",
                 ("block", current_block_num)("mem", new_max / (1024 * 1024)));
+            wlog(
+                "Predicted allocation is ${rate} bytes/block, free memory is enough for ${blocks} blocks",
+                ("rate", uint64_t(_growth.bytes_per_block()))
+                ("blocks", _growth.blocks_left(free_memory(), _min_free_shared_memory_size)));
+
+            // the file is remapped
+            _flusher.cancel();
+            _growth.cancel();
             resize(new_max);
 
+            auto mapping = get_shared_memory_mapping();
+            advise_shared_memory(mapping.first, mapping.second, _shared_memory_advice);
+            // sizes are counted from the segment manager, which isn't aligned to the page
+            auto segment = reinterpret_cast<char*>(get_segment_manager());
+            _growth.resized(current_block_num, max_memory() - free_memory(), segment + max_mem, max_memory() - max_mem);
+
             uint64_t free_mem = free_memory();
             uint64_t reserved_mem = reserved_memory();
 
@@ -403,13 +735,29 @@ namespace golos { namespace chain {
         }
 
         void database::check_free_memory(bool skip_print, uint32_t current_block_num) {
+            uint64_t reserved_mem = reserved_memory();
+            uint64_t free_mem = free_memory();
+
+            _growth.add_block(current_block_num, max_memory() - free_mem);
+
+            if (_inc_shared_memory_size != 0 && _min_free_shared_memory_size != 0) {
+                // the growth is prepared before the next check, and the resize is done earlier
+                //   if the file is already allocated, so it only remaps the file
+                auto blocks_left = _growth.blocks_left(
+                    free_mem > reserved_mem ? free_mem - reserved_mem : 0, _min_free_shared_memory_size);
+                if (blocks_left < 2 * uint64_t(_block_num_check_free_memory)) {
+                    bool is_reserved = _growth.reserve(max_memory(), _inc_shared_memory_size);
+                    if (is_reserved && blocks_left < _block_num_check_free_memory) {
+                        _resize(current_block_num);
+                        return;
+                    }
+                }
+            }
+
             if (0 != current_block_num % _block_num_check_free_memory) {
                 return;
             }
 
-            uint64_t reserved_mem = reserved_memory();
-            uint64_t free_mem = free_memory();
-
             if (free_mem > reserved_mem) {
                 free_mem -= reserved_mem;
             } else {
@@ -454,6 +802,8 @@ namespace golos { namespace chain {
                 // DB state (issue #336).
                 clear_pending();
 
+                _flusher.stop();
+                _growth.stop();
                 chainbase::database::flush();
                 chainbase::database::close();
 
@@ -558,12 +908,9 @@ namespace golos { namespace chain {
 
         const signed_transaction database::get_recent_transaction(const transaction_id_type &trx_id) const {
             try {
-                auto &index = get_index<transaction_index>().indices().get<by_trx_id>();
-                auto itr = index.find(trx_id);
-                FC_ASSERT(itr != index.end());
                 signed_transaction trx;
-                fc::raw::unpack(itr->packed_trx, trx);
-                return trx;;
+                FC_ASSERT(_recent_transactions.find(trx_id, trx), "Transaction isn't in the cache of recent transactions");
+                return trx;
             } FC_CAPTURE_AND_RETHROW()
         }
 
@@ -932,12 +1279,15 @@ namespace golos { namespace chain {
         *
         * @return true if we switched forks as a result of this push.
         */
-        bool database::push_block(const signed_block &new_block, uint32_t skip) {
+        bool database::push_block(
+            const signed_block &new_block, uint32_t skip, std::shared_ptr<const prevalidated_block> prevalidated
+        ) {
             //fc::time_point begin_time = fc::time_point::now();
 
             bool result;
             with_strong_write_lock([&]() {
                 detail::without_pending_transactions(*this, skip, std::move(_pending_tx), [&]() {
+                    detail::prevalidated_block_helper prevalidated_helper(*this, std::move(prevalidated));
                     try {
                         result = _push_block(new_block, skip);
                         check_free_memory(false, new_block.block_num());
@@ -1070,19 +1420,57 @@ namespace golos { namespace chain {
         */
         void database::push_transaction(const signed_transaction &trx, uint32_t skip) {
             try {
-                GOLOS_ASSERT(fc::raw::pack_size(trx) <= (get_dynamic_global_properties().maximum_block_size - 256),
+                transaction_memo memo(trx);
+                GOLOS_ASSERT(memo.packed_size() <= (get_dynamic_global_properties().maximum_block_size - 256),
                         golos::protocol::tx_too_long, "Transaction data is too long. Maximum transaction size ${max} bytes",
                         ("max",get_dynamic_global_properties().maximum_block_size - 256));
                 with_weak_write_lock([&]() {
                     detail::with_producing(*this, [&]() {
-                        _push_transaction(trx, skip);
+                        _push_transaction(trx, memo, skip);
                     });
                 });
             }
             FC_CAPTURE_AND_RETHROW((trx))
         }
 
+        void database::push_transactions(std::vector<transaction_push_request> &requests) {
+            std::size_t pushed = 0;
+            try {
+                with_weak_write_lock([&]() {
+                    detail::with_producing(*this, [&]() {
+                        const auto max_size = get_dynamic_global_properties().maximum_block_size - 256;
+                        for (; pushed < requests.size(); ++pushed) {
+                            auto &request = requests[pushed];
+                            try {
+                                try {
+                                    transaction_memo memo(request.trx);
+                                    GOLOS_ASSERT(memo.packed_size() <= max_size,
+                                            golos::protocol::tx_too_long,
+                                            "Transaction data is too long. Maximum transaction size ${max} bytes",
+                                            ("max", max_size));
+                                    _push_transaction(request.trx, memo, request.skip);
+                                }
+                                FC_CAPTURE_AND_RETHROW((request.trx))
+                            } catch (...) {
+                                request.error = std::current_exception();
+                            }
+                        }
+                    });
+                });
+            } catch (...) {
+                // the write lock wasn't taken
+                auto error = std::current_exception();
+                for (; pushed < requests.size(); ++pushed) {
+                    requests[pushed].error = error;
+                }
+            }
+        }
+
         void database::_push_transaction(const signed_transaction &trx, uint32_t skip) {
+            _push_transaction(trx, transaction_memo(trx), skip);
+        }
+
+        void database::_push_transaction(const signed_transaction &trx, const transaction_memo &memo, uint32_t skip) {
             // If this is the first transaction pushed after applying a block, start a new undo session.
             // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
             if (!_pending_tx_session.valid()) {
@@ -1095,8 +1483,9 @@ namespace golos { namespace chain {
             // apply the changes.
 
             auto temp_session = start_undo_session();
-            _apply_transaction(trx, skip);
+            _apply_transaction(trx, memo, skip);
             _pending_tx.push_back(trx);
+            _pending_tx_info.push_back({memo.packed_size(), skip});
 
             notify_changed_objects();
             // The transaction applied successfully. Merge its changes into the pending block session.
@@ -1144,8 +1533,58 @@ namespace golos { namespace chain {
             size_t total_block_size = max_block_header_size;
 
             signed_block pending_block;
+            block_assembly_info assembly;
+            auto assembly_start = fc::time_point::now();
 
             with_strong_write_lock([&]() { detail::with_generating(*this, [&]() {
+                //
+                // Pending transactions were applied in the pending session on top of the head block,
+                // their validity can differ only for the expiration (depends on the "when" variable),
+                // for the block size limit, and for the checks which were skipped on pushing.
+                // If these don't affect a prefix of pending transactions, the prefix is taken as is,
+                // because its transactions are valid being applied in the same order.
+                //
+                // Checks of operations don't depend on the state, and all transactions are checked
+                // again in push_block() below.
+                //
+                const uint32_t state_dependent_checks =
+                    skip_authority_check |
+                    skip_transaction_signatures |
+                    skip_tapos_check |
+                    skip_transaction_dupe_check;
+
+                std::size_t reused_count = 0;
+                bool stopped_by_size = false;
+                if (_pending_tx_session.valid() || _pending_tx.empty()) {
+                    size_t reused_block_size = total_block_size;
+                    for (; reused_count < _pending_tx.size(); ++reused_count) {
+                        const auto& tx = _pending_tx[reused_count];
+                        const auto& info = _pending_tx_info[reused_count];
+
+                        if (tx.expiration < when || ((info.skip & ~skip) & state_dependent_checks)) {
+                            break;
+                        }
+
+                        if (reused_block_size + info.packed_size >= maximum_block_size) {
+                            stopped_by_size = true;
+                            break;
+                        }
+                        reused_block_size += info.packed_size;
+                    }
+                }
+
+                if (reused_count == _pending_tx.size() || stopped_by_size) {
+                    pending_block.transactions.assign(_pending_tx.begin(), _pending_tx.begin() + reused_count);
+                    assembly.reused_pending_state = true;
+                    assembly.postponed_transactions = _pending_tx.size() - reused_count;
+                    if (assembly.postponed_transactions > 0) {
+                        wlog("Postponed ${n} transactions due to block size limit",
+                            ("n", assembly.postponed_transactions));
+                    }
+                    _pending_tx_session.reset();
+                    return;
+                }
+
                 //
                 // The following code throws away existing pending_tx_session and
                 // rebuilds it by re-applying pending transactions.
@@ -1162,7 +1601,8 @@ namespace golos { namespace chain {
 
                 uint64_t postponed_tx_count = 0;
                 // pop pending state (reset to head block state)
-                for (const signed_transaction &tx : _pending_tx) {
+                for (std::size_t i = 0; i < _pending_tx.size(); ++i) {
+                    const signed_transaction &tx = _pending_tx[i];
                     // Only include transactions that have not expired yet for currently generating block,
                     // this should clear problem transactions and allow block production to continue
 
@@ -1170,8 +1610,7 @@ namespace golos { namespace chain {
                         continue;
                     }
 
-                    uint64_t new_total_size =
-                            total_block_size + fc::raw::pack_size(tx);
+                    uint64_t new_total_size = total_block_size + _pending_tx_info[i].packed_size;
 
                     // postpone transaction if it would make block too big
                     if (new_total_size >= maximum_block_size) {
@@ -1184,7 +1623,7 @@ namespace golos { namespace chain {
                         _apply_transaction(tx, skip);
                         temp_session.squash();
 
-                        total_block_size += fc::raw::pack_size(tx);
+                        total_block_size = new_total_size;
                         pending_block.transactions.push_back(tx);
                     }
                     catch (const fc::exception &e) {
@@ -1196,10 +1635,15 @@ namespace golos { namespace chain {
                 if (postponed_tx_count > 0) {
                     wlog("Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count));
                 }
+                assembly.postponed_transactions = postponed_tx_count;
 
                 _pending_tx_session.reset();
             }); });
 
+            assembly.transactions = pending_block.transactions.size();
+            assembly.assembly_time = fc::time_point::now() - assembly_start;
+            _last_block_assembly = assembly;
+
             // We have temporarily broken the invariant that
             // _pending_tx_session is the result of applying _pending_tx, as
             // _pending_tx now consists of the set of postponed transactions.
@@ -1282,6 +1726,7 @@ namespace golos { namespace chain {
                 assert((_pending_tx.size() == 0) ||
                        _pending_tx_session.valid());
                 _pending_tx.clear();
+                _pending_tx_info.clear();
                 _pending_tx_session.reset();
             }
             FC_CAPTURE_AND_RETHROW()
@@ -1306,6 +1751,10 @@ namespace golos { namespace chain {
             if (!is_producing() || _enable_plugins_on_push_transaction) {
                 STEEMIT_TRY_NOTIFY(post_apply_operation, note);
             }
+
+            if (_operation_batch) {
+                _operation_batch->operations.emplace_back(note);
+            }
         }
 
         inline const void database::push_virtual_operation(const operation &op, bool force) {
@@ -1317,12 +1766,23 @@ namespace golos { namespace chain {
             operation_notification note(op);
             ++_current_virtual_op;
             note.virtual_op = _current_virtual_op;
+            auto start = fc::time_point::now();
             notify_pre_apply_operation(note);
             notify_post_apply_operation(note);
+            _apply_timing.add_operation(op.which(), fc::time_point::now() - start);
         }
 
         void database::notify_applied_block(const signed_block &block) {
             STEEMIT_TRY_NOTIFY(applied_block, block)
+
+            if (_operation_batch) {
+                _operation_batch->block = std::make_shared<signed_block>(block);
+                _operation_batch->last_irreversible_block_num = last_non_undoable_block_num();
+
+                operation_batch_ptr batch = std::move(_operation_batch);
+                _operation_batch.reset();
+                STEEMIT_TRY_NOTIFY(applied_operation_batch, batch)
+            }
         }
 
         void database::notify_on_pending_transaction(const signed_transaction &tx) {
@@ -3070,6 +3530,9 @@ namespace golos { namespace chain {
         }
 
         void database::initialize_indexes() {
+            _snapshot_sections.clear();
+            _plugin_index_cleaners.clear();
+
             add_core_index<dynamic_global_property_index>(*this);
             add_core_index<account_index>(*this);
             add_core_index<account_authority_index>(*this);
@@ -3339,13 +3802,15 @@ namespace golos { namespace chain {
                 skip_validate_operations |
                 skip_tapos_check;
 
+            transaction_memo memo(trx);
+
             // in case of multi-thread application, it's allow to validate transaction in read-thread
             if ((skip & validate_transaction_steps) != validate_transaction_steps) {
                 // this method can be used only for push_transaction(),
                 //  because such transactions only added to pending list,
                 //  and they will be rechecked on block generation
                 auto validate_action = [&]() {
-                    _validate_transaction(trx, skip);
+                    _validate_transaction(trx, memo, skip);
                 };
 
                 if (!(skip & skip_database_locking)) {
@@ -3360,7 +3825,7 @@ namespace golos { namespace chain {
             if (!(skip & skip_apply_transaction)) {
                 auto apply_action = [&]() {
                     auto session = start_undo_session();
-                    _apply_transaction(trx, skip);
+                    _apply_transaction(trx, memo, skip);
                     session.undo();
                 };
 
@@ -3374,8 +3839,13 @@ namespace golos { namespace chain {
             return skip;
         }
 
-        void database::_validate_transaction(const signed_transaction &trx, uint32_t skip) {
-            if (!(skip & skip_validate_operations)) {   /* issue #505 explains why this skip_flag is disabled */
+        void database::_validate_transaction(const signed_transaction &trx, const transaction_memo &memo, uint32_t skip) {
+            const prevalidated_transaction* prevalidated = nullptr;
+            if (_current_prevalidated_trx && _current_prevalidated_trx->is_valid) {
+                prevalidated = _current_prevalidated_trx;
+            }
+
+            if (!(skip & skip_validate_operations) && !prevalidated) {   /* issue #505 explains why this skip_flag is disabled */
                 trx.validate();
             }
 
@@ -3395,7 +3865,31 @@ namespace golos { namespace chain {
                 };
 
                 try {
-                    trx.verify_authority(chain_id, get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                    if (prevalidated && _prevalidated_block->has_signature_keys) {
+                        try {
+                            protocol::verify_authority(
+                                trx.operations, prevalidated->signature_keys,
+                                get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                        } FC_CAPTURE_AND_RETHROW((trx))
+                    } else {
+                        try {
+                            auto sig_digest = memo.sig_digest(chain_id);
+                            auto& cache = protocol::signature_cache::instance();
+                            flat_set<public_key_type> keys;
+                            bool is_cached = cache.get(sig_digest, trx.signatures, keys);
+                            if (!is_cached) {
+                                keys = trx.get_signature_keys_for_digest(sig_digest);
+                            }
+                            protocol::verify_authority(
+                                trx.operations, keys,
+                                get_active, get_owner, get_posting, STEEMIT_MAX_SIG_CHECK_DEPTH);
+                            if (!is_cached) {
+                                // the expiration isn't checked yet, so it is limited to keep entries of valid lifetime
+                                auto max_expiration = head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION;
+                                cache.add(sig_digest, trx.signatures, std::min(trx.expiration, max_expiration), keys);
+                            }
+                        } FC_CAPTURE_AND_RETHROW((trx))
+                    }
                 }
                 catch (protocol::tx_missing_active_auth &e) {
                     if (get_shared_db_merkle().find(head_block_num() + 1) == get_shared_db_merkle().end()) {
@@ -3474,6 +3968,11 @@ namespace golos { namespace chain {
             _next_flush_block = 0;
         }
 
+        void database::set_async_flush(bool value, uint64_t max_bytes_per_sec) {
+            _async_flush = value;
+            _flusher.set_rate_limit(max_bytes_per_sec);
+        }
+
         const block_log &database::get_block_log() const {
             return _block_log;
         }
@@ -3508,7 +4007,13 @@ namespace golos { namespace chain {
                     }
                 }
 
-                _apply_block(next_block, skip);
+                try {
+                    _apply_block(next_block, skip);
+                } catch (...) {
+                    // operations of the failed block shouldn't be passed with the next one
+                    _operation_batch.reset();
+                    throw;
+                }
 
                 /*try
    {
@@ -3539,7 +4044,16 @@ namespace golos { namespace chain {
                     if (_next_flush_block == block_num) {
                         _next_flush_block = 0;
 //                        ilog("Flushing database shared memory at block ${b}", ("b", block_num));
-                        chainbase::database::flush();
+                        if (_async_flush) {
+                            auto mapping = get_shared_memory_mapping();
+                            if (!_flusher.mark(block_num, mapping.first, mapping.second)) {
+                                wlog("Previous flush of shared memory isn't finished at block ${b}", ("b", block_num));
+                            }
+                        } else {
+                            auto start = fc::time_point::now();
+                            chainbase::database::flush();
+                            _flusher.add_sync_flush(block_num, max_memory(), fc::time_point::now() - start);
+                        }
                     }
                 }
 
@@ -3548,6 +4062,7 @@ namespace golos { namespace chain {
 
         void database::_apply_block(const signed_block &next_block, uint32_t skip) {
             try {
+                apply_timing_stats::steps_timer timer(_apply_timing);
                 uint32_t next_block_num = next_block.block_num();
                 const auto &gprops = get_dynamic_global_properties();
                 //block_id_type next_block_id = next_block.id();
@@ -3560,6 +4075,12 @@ namespace golos { namespace chain {
                 _current_trx_in_block = 0;
                 _current_virtual_op = 0;
 
+                if (!applied_operation_batch.empty()) {
+                    _operation_batch = std::make_shared<operation_batch>();
+                } else {
+                    _operation_batch.reset();
+                }
+
                 /// modify current witness so transaction evaluators can know who included the transaction,
                 /// this is mostly for POW operations which must pay the current_witness
                 modify(gprops, [&](dynamic_global_property_object &dgp) {
@@ -3580,6 +4101,14 @@ namespace golos { namespace chain {
                     );
                 }
 
+                const prevalidated_block* prevalidated = nullptr;
+                if (_prevalidated_block &&
+                    _prevalidated_block->block_id == next_block.id() &&
+                    _prevalidated_block->matches(next_block)
+                ) {
+                    prevalidated = _prevalidated_block.get();
+                }
+
                 for (const auto &trx : next_block.transactions) {
                     /* We do not need to push the undo state for each transaction
                      * because they either all apply and are valid or the
@@ -3587,48 +4116,82 @@ namespace golos { namespace chain {
                      * for transactions when validating broadcast transactions or
                      * when building a block.
                      */
+                    if (prevalidated) {
+                        _current_prevalidated_trx = &prevalidated->transactions[_current_trx_in_block];
+                    }
                     apply_transaction(trx, skip);
+                    _current_prevalidated_trx = nullptr;
                     ++_current_trx_in_block;
                 }
+                timer.done(block_step::apply_transactions);
 
                 _current_trx_in_block = -1;
                 _current_op_in_trx = 0;
                 _current_virtual_op = 0;
 
                 update_global_dynamic_data(next_block, skip);
+                timer.done(block_step::update_global_dynamic_data);
                 update_signing_witness(signing_witness, next_block);
+                timer.done(block_step::update_signing_witness);
 
                 update_last_irreversible_block(skip);
+                timer.done(block_step::update_last_irreversible_block);
 
                 create_block_summary(next_block);
+                timer.done(block_step::create_block_summary);
                 clear_expired_proposals();
+                timer.done(block_step::clear_expired_proposals);
                 clear_expired_transactions();
+                timer.done(block_step::clear_expired_transactions);
                 clear_expired_orders();
+                timer.done(block_step::clear_expired_orders);
                 clear_expired_delegations();
+                timer.done(block_step::clear_expired_delegations);
                 update_witness_schedule();
+                timer.done(block_step::update_witness_schedule);
 
                 update_median_feed();
+                timer.done(block_step::update_median_feed);
                 update_virtual_supply();
+                timer.done_part(block_step::update_virtual_supply);
 
                 clear_null_account_balance();
+                timer.done(block_step::clear_null_account_balance);
                 process_funds();
+                timer.done(block_step::process_funds);
                 process_conversions();
+                timer.done(block_step::process_conversions);
                 process_comment_cashout();
+                timer.done(block_step::process_comment_cashout);
                 process_vesting_withdrawals();
+                timer.done(block_step::process_vesting_withdrawals);
                 process_savings_withdraws();
+                timer.done(block_step::process_savings_withdraws);
                 pay_liquidity_reward();
+                timer.done(block_step::pay_liquidity_reward);
                 update_virtual_supply();
+                timer.done(block_step::update_virtual_supply);
 
                 account_recovery_processing();
+                timer.done(block_step::account_recovery_processing);
                 expire_escrow_ratification();
+                timer.done(block_step::expire_escrow_ratification);
                 process_decline_voting_rights();
+                timer.done(block_step::process_decline_voting_rights);
 
                 process_hardforks();
+                timer.done(block_step::process_hardforks);
 
                 // notify observers that the block has been applied
                 notify_applied_block(next_block);
+                timer.done(block_step::notify_applied_block);
 
                 notify_changed_objects();
+                timer.done_total();
+
+                if (_apply_timing_log_interval && next_block_num % _apply_timing_log_interval == 0) {
+                    _apply_timing.log(next_block_num, 10);
+                }
 
             } FC_CAPTURE_LOG_AND_RETHROW((next_block.block_num()))
         }
@@ -3763,12 +4326,16 @@ namespace golos { namespace chain {
         }
 
         void database::_apply_transaction(const signed_transaction &trx, uint32_t skip) {
+            _apply_transaction(trx, transaction_memo(trx), skip);
+        }
+
+        void database::_apply_transaction(const signed_transaction &trx, const transaction_memo &memo, uint32_t skip) {
             try {
-                _current_trx_id = trx.id();
+                const auto& trx_id = memo.id();
+                _current_trx_id = trx_id;
                 _current_virtual_op = 0;
 
                 auto &trx_idx = get_index<transaction_index>();
-                auto trx_id = trx.id();
                 // idump((trx_id)(skip&skip_transaction_dupe_check));
                 if (!(skip & skip_transaction_dupe_check) &&
                           trx_idx.indices().get<by_trx_id>().find(trx_id) != trx_idx.indices().get<by_trx_id>().end()) {
@@ -3776,13 +4343,13 @@ namespace golos { namespace chain {
                           "Duplicate transaction check failed", ("trx_ix", trx_id));
                 }
 
-                _validate_transaction(trx, skip);
+                _validate_transaction(trx, memo, skip);
 
                 flat_set<account_name_type> required;
                 vector<authority> other;
                 trx.get_required_authorities(required, required, required, other);
 
-                auto trx_size = fc::raw::pack_size(trx);
+                uint64_t trx_size = memo.packed_size();
 
                 const auto& props = get_dynamic_global_properties();
 
@@ -3805,8 +4372,8 @@ namespace golos { namespace chain {
                     create<transaction_object>([&](transaction_object &transaction) {
                         transaction.trx_id = trx_id;
                         transaction.expiration = trx.expiration;
-                        fc::raw::pack(transaction.packed_trx, trx);
                     });
+                    _recent_transactions.add(trx_id, trx);
                 }
 
                 //Finally process the operations
@@ -3836,9 +4403,11 @@ namespace golos { namespace chain {
                 ++_current_virtual_op;
                 note.virtual_op = _current_virtual_op;
             }
+            auto start = fc::time_point::now();
             notify_pre_apply_operation(note);
             _my->_evaluator_registry.get_evaluator(op).apply(op);
             notify_post_apply_operation(note);
+            _apply_timing.add_operation(op.which(), fc::time_point::now() - start);
         }
 
         const witness_object &database::validate_block_header(uint32_t skip, const signed_block &next_block) const {
@@ -4272,6 +4841,10 @@ namespace golos { namespace chain {
                    (head_block_time() > dedupe_index.begin()->expiration)) {
                 remove(*dedupe_index.begin());
             }
+
+            // keys of expired transactions can't be used anymore
+            protocol::signature_cache::instance().remove_expired(head_block_time());
+            _recent_transactions.remove_expired(head_block_time());
         }
 
         void database::clear_expired_orders() {
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <golos/protocol/latency_stats.hpp>
+#include <golos/protocol/operations.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    using golos::protocol::latency_histogram;
+
+    /**
+     * Steps of applying of block, which are measured
+     */
+    enum class block_step: uint8_t {
+        apply_transactions,
+        update_global_dynamic_data,
+        update_signing_witness,
+        update_last_irreversible_block,
+        create_block_summary,
+        clear_expired_proposals,
+        clear_expired_transactions,
+        clear_expired_orders,
+        clear_expired_delegations,
+        update_witness_schedule,
+        update_median_feed,
+        update_virtual_supply,
+        clear_null_account_balance,
+        process_funds,
+        process_conversions,
+        process_comment_cashout,
+        process_vesting_withdrawals,
+        process_savings_withdraws,
+        pay_liquidity_reward,
+        account_recovery_processing,
+        expire_escrow_ratification,
+        process_decline_voting_rights,
+        process_hardforks,
+        notify_applied_block,
+        total
+    };
+
+    struct apply_timing_item: public latency_histogram {
+        std::string name;
+    };
+
+    struct apply_timing_info {
+        std::vector<apply_timing_item> operations;
+        std::vector<apply_timing_item> block_steps;
+    };
+
+    /**
+     * Counts and durations of applied operations by types and of steps of applying of blocks.
+     *
+     * The duration of operation includes notifications of plugins, so for virtual operations
+     *   it is the time of plugins only. Stats have their own lock, so they are read and cleared
+     *   without locks of the database.
+     */
+    class apply_timing_stats final {
+    public:
+        apply_timing_stats();
+
+        void add_operation(int which, const fc::microseconds& duration) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _operations[which].add(duration);
+        }
+
+        void add_step(block_step step, const fc::microseconds& duration) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _steps[static_cast<uint32_t>(step)].add(duration);
+        }
+
+        /**
+         * Measures consecutive steps of block applying, each call of done() finishes the step
+         *   which was started by the previous call
+         */
+        class steps_timer final {
+        public:
+            explicit steps_timer(apply_timing_stats& stats)
+                    : _stats(stats),
+                      _start(fc::time_point::now()),
+                      _last(_start) {
+            }
+
+            void done(block_step step) {
+                auto now = fc::time_point::now();
+                auto& part = _parts[static_cast<uint32_t>(step)];
+                _stats.add_step(step, now - _last + part);
+                part = fc::microseconds();
+                _last = now;
+            }
+
+            /// Finishes a part of the step, which is run several times per block, it is counted once by done()
+            void done_part(block_step step) {
+                auto now = fc::time_point::now();
+                _parts[static_cast<uint32_t>(step)] += now - _last;
+                _last = now;
+            }
+
+            void done_total() {
+                _stats.add_step(block_step::total, fc::time_point::now() - _start);
+            }
+
+        private:
+            apply_timing_stats& _stats;
+            fc::time_point _start;
+            fc::time_point _last;
+            std::array<fc::microseconds, static_cast<uint32_t>(block_step::total)> _parts;
+        };
+
+        /// Returns only operations and steps which were applied at least once
+        apply_timing_info get_info() const;
+
+        /// Writes the most expensive operations and steps to the log
+        void log(uint32_t block_num, uint32_t top) const;
+
+        /// Clears stats and returns them as they were before, nothing is lost between the reading and the clearing
+        apply_timing_info clear();
+
+    private:
+        apply_timing_info make_info() const;
+
+        mutable std::mutex _mutex;
+        std::vector<latency_histogram> _operations;
+        std::vector<latency_histogram> _steps;
+    };
+
+} } // golos::chain
+
+FC_REFLECT_ENUM(golos::chain::block_step,
+    (apply_transactions)(update_global_dynamic_data)(update_signing_witness)(update_last_irreversible_block)
+    (create_block_summary)(clear_expired_proposals)(clear_expired_transactions)(clear_expired_orders)
+    (clear_expired_delegations)(update_witness_schedule)(update_median_feed)(update_virtual_supply)
+    (clear_null_account_balance)(process_funds)(process_conversions)(process_comment_cashout)
+    (process_vesting_withdrawals)(process_savings_withdraws)(pay_liquidity_reward)(account_recovery_processing)
+    (expire_escrow_ratification)(process_decline_voting_rights)(process_hardforks)(notify_applied_block)(total))
+FC_REFLECT_DERIVED((golos::chain::apply_timing_item), ((golos::protocol::latency_histogram)), (name))
+FC_REFLECT((golos::chain::apply_timing_info), (operations)(block_steps))
@@ -2,6 +2,7 @@
 
 #include <fc/filesystem.hpp>
 #include <golos/protocol/block.hpp>
+#include <golos/chain/compressed_block_log.hpp>
 
 namespace golos {
     namespace chain {
@@ -33,6 +34,9 @@ namespace golos {
          *
          * The main file is the only file that needs to persist. The index file can be reconstructed during a
          * linear scan of the main file.
+         *
+         * The block log can be also stored in the compressed format (see compressed_block_log), the format
+         * of an existing file is detected on opening.
          */
 
         class block_log {
@@ -41,7 +45,11 @@ namespace golos {
 
             ~block_log();
 
-            void open(const fc::path& file);
+            /**
+             * @param chunk_blocks for a new log: 0 - the raw format,
+             *   otherwise - the compressed format with the number of blocks in a chunk
+             */
+            void open(const fc::path& file, uint32_t chunk_blocks = 0);
 
             void close();
 
@@ -51,12 +59,24 @@ namespace golos {
 
             void flush();
 
+            /**
+             * Reads block by position in the raw format, isn't supported by the compressed format.
+             */
             std::pair<signed_block, uint64_t> read_block(uint64_t file_pos) const;
 
             optional <signed_block> read_block_by_num(uint32_t block_num) const;
 
+            /**
+             * Calls the handler with the packed block as it is stored in the file, without deserialization.
+             * The data is valid only inside the handler, because the file can be remapped on appending.
+             *
+             * @return false if the block does not exist
+             */
+            bool read_block_data_by_num(uint32_t block_num, const block_data_handler& handler) const;
+
             /**
              * Return offset of block in file, or block_log::npos if it does not exist.
+             * For the compressed format, it is offset of the chunk with the block.
              */
             uint64_t get_block_pos(uint32_t block_num) const;
 
@@ -64,10 +84,19 @@ namespace golos {
 
             const optional <signed_block>& head() const;
 
+            bool is_compressed() const;
+
+            /// Number of decoded chunks kept in memory by the compressed format
+            void set_cache_size(uint32_t chunks);
+
+            block_log_cache_stats get_cache_stats() const;
+
             static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
         private:
             std::unique_ptr<detail::block_log_impl> my;
+            std::unique_ptr<compressed_block_log> compressed;
+            uint32_t cache_size = 16;
         };
 
     }
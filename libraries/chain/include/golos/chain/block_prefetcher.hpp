@@ -0,0 +1,79 @@
+#pragma once
+
+#include <golos/chain/block_log.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    /**
+     * Reads and deserializes blocks from the block_log ahead of the apply loop.
+     *
+     * Reader threads claim block numbers in order and put decoded blocks into a bounded ring,
+     * so the single apply thread gets the next block without waiting for disk and unpack.
+     * With zero reader threads blocks are read inline by the consumer.
+     */
+    class block_prefetcher final {
+    public:
+        block_prefetcher(
+            const block_log& log, uint32_t from_block_num, uint32_t last_block_num,
+            uint32_t reader_threads, uint32_t queue_depth);
+
+        ~block_prefetcher();
+
+        void start();
+
+        void stop();
+
+        /**
+         * Returns the next block in order, waits until it is decoded by readers.
+         * Rethrows the exception which was raised while reading of this block.
+         */
+        signed_block next();
+
+        /// Number of decoded blocks waiting for the apply thread
+        uint32_t queue_size() const;
+
+        /// How many times readers waited for a free slot (apply thread is the bottleneck)
+        uint64_t producer_stalls() const;
+
+        /// How many times the apply thread waited for a block (reading is the bottleneck)
+        uint64_t consumer_stalls() const;
+
+    private:
+        struct slot {
+            bool ready = false;
+            signed_block block;
+            std::exception_ptr error;
+        };
+
+        void read_loop();
+
+        slot& get_slot(uint32_t block_num);
+
+        const block_log& _block_log;
+        const uint32_t _last_block_num;
+        const uint32_t _reader_threads;
+
+        std::vector<slot> _slots;
+        std::vector<std::thread> _threads;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _producer_cv;
+        std::condition_variable _consumer_cv;
+
+        std::atomic<uint32_t> _next_read_num;
+        uint32_t _next_apply_num;
+        uint32_t _ready_count = 0;
+        bool _is_stopped = false;
+
+        std::atomic<uint64_t> _producer_stalls{0};
+        std::atomic<uint64_t> _consumer_stalls{0};
+    };
+
+} } // namespace golos::chain
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <golos/protocol/block.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace golos { namespace chain {
+
+    using namespace golos::protocol;
+
+    /**
+     * Results of the state-independent checks of one transaction
+     */
+    struct prevalidated_transaction {
+        bool is_valid = false; ///< trx.validate() passed and signature keys were recovered
+        digest_type merkle_digest; ///< identifies the checked body of the transaction
+        flat_set<public_key_type> signature_keys;
+    };
+
+    /**
+     * Results of the state-independent checks of a block
+     */
+    struct prevalidated_block {
+        block_id_type block_id;
+        checksum_type merkle_root; ///< calculated from the transactions, not taken from the header
+        bool has_signature_keys = false;
+        std::vector<prevalidated_transaction> transactions;
+
+        /**
+         * True if the results were made from the same transactions as the block has.
+         * The block id covers only the header, so a block with other transactions can have the same id.
+         */
+        bool matches(const signed_block& block) const;
+    };
+
+    /**
+     * Runs the checks of a block which don't need chain state in a thread pool:
+     * validation of operations, recovery of signature keys and calculation of the merkle root.
+     *
+     * Blocks are submitted as soon as they are received from the network, so the work is done
+     * while the previous blocks are applied. The write thread later takes the results by block id.
+     */
+    class block_prevalidator final {
+    public:
+        block_prevalidator();
+
+        ~block_prevalidator();
+
+        void start(uint32_t threads, uint32_t max_blocks);
+
+        void stop();
+
+        bool is_started() const;
+
+        /**
+         * Schedules the checks of a block, does nothing if the block is already scheduled.
+         * If there are max_blocks not taken results, results for the oldest block are dropped.
+         *
+         * @param recover_signatures if false, only operations and merkle root are checked
+         */
+        void prevalidate(const signed_block& block, const block_id_type& block_id, bool recover_signatures);
+
+        /**
+         * Returns results for the block and forgets them, waits if the checks are still running.
+         * Returns nullptr if the block wasn't scheduled.
+         */
+        std::shared_ptr<const prevalidated_block> take(const block_id_type& block_id);
+
+    private:
+        using result_type = std::shared_ptr<const prevalidated_block>;
+
+        static result_type prevalidate_block(
+            const signed_block& block, const block_id_type& block_id, bool recover_signatures);
+
+        std::unique_ptr<boost::asio::io_service> _io_service;
+        std::unique_ptr<boost::asio::io_service::work> _work;
+        boost::thread_group _thread_pool;
+
+        uint32_t _max_blocks = 0;
+
+        std::mutex _mutex;
+        /// block id starts with the block number, so the first item is the oldest block
+        std::map<block_id_type, std::shared_future<result_type>> _results;
+    };
+
+} } // namespace golos::chain
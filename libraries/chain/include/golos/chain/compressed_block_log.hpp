@@ -0,0 +1,107 @@
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <golos/protocol/block.hpp>
+
+#include <functional>
+
+namespace golos { namespace chain {
+
+    using namespace golos::protocol;
+
+    namespace detail { class compressed_block_log_impl; }
+
+    /**
+     * Receives packed block, the data is valid only inside the call
+     */
+    using block_data_handler = std::function<void(const char* data, std::size_t size)>;
+
+    struct block_log_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint32_t size = 0;
+        uint32_t max_size = 0;
+    };
+
+    /* The compressed block log keeps blocks in chunks of a fixed number of blocks. The chunk with
+     * block_num belongs to the (block_num - 1) / chunk_blocks position of the index file, which gives
+     * O(1) random access lookup by block number like the raw block log.
+     *
+     * +--------+---------------+---------+---------------+---------+-----+---------------+---------+
+     * | Header | Chunk 1 Header| Chunk 1 | Chunk 2 Header| Chunk 2 | ... | Last Ch Header| Last Ch |
+     * +--------+---------------+---------+---------------+---------+-----+---------------+---------+
+     *
+     * +----------------+----------------+-----+-------------------+
+     * | Pos of Chunk 1 | Pos of Chunk 2 | ... | Pos of Last Chunk |
+     * +----------------+----------------+-----+-------------------+
+     *
+     * The data of a chunk is a sequence of blocks, each block is prefixed by its 4-byte packed size.
+     * The data of a full chunk is compressed with zlib. The last chunk is stored as is until it is full,
+     * so an appending of a block doesn't need to recompress the chunk. The compressed chunk is first written
+     * after the end of the file, so the daemon can be killed on its compression without loss of blocks.
+     *
+     * Decoded chunks are kept in a LRU cache, so sequential readers decompress each chunk only once.
+     *
+     * The main file is the only file that needs to persist. The index file can be reconstructed during a
+     * linear scan of chunk headers of the main file.
+     */
+    class compressed_block_log {
+    public:
+        compressed_block_log();
+
+        ~compressed_block_log();
+
+        /**
+         * Checks whether the file is a compressed block log
+         */
+        static bool is_compressed_file(const fc::path& file);
+
+        /**
+         * Opens the existing log or creates a new one
+         *
+         * @param chunk_blocks number of blocks in a chunk for a new log, existing log keeps its own value
+         */
+        void open(const fc::path& file, uint32_t chunk_blocks);
+
+        void close();
+
+        bool is_open() const;
+
+        /**
+         * @return position of the chunk with the block
+         */
+        uint64_t append(const signed_block& b, const std::vector<char>& data);
+
+        optional<signed_block> read_block_by_num(uint32_t block_num) const;
+
+        /**
+         * Calls the handler with the packed block from the decoded chunk, without deserialization.
+         * @return false if the block does not exist
+         */
+        bool read_block_data_by_num(uint32_t block_num, const block_data_handler& handler) const;
+
+        /**
+         * Return offset of the chunk with the block in file, or npos if the block does not exist.
+         */
+        uint64_t get_block_pos(uint32_t block_num) const;
+
+        signed_block read_head() const;
+
+        const optional<signed_block>& head() const;
+
+        uint32_t chunk_blocks() const;
+
+        /// 0 - disables the cache of decoded chunks
+        void set_cache_size(uint32_t chunks);
+
+        block_log_cache_stats get_cache_stats() const;
+
+        static const uint64_t npos = std::numeric_limits<uint64_t>::max();
+
+    private:
+        std::unique_ptr<detail::compressed_block_log_impl> my;
+    };
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::block_log_cache_stats), (hits)(misses)(size)(max_size))
@@ -4,13 +4,23 @@
 #include <golos/chain/node_property_object.hpp>
 #include <golos/chain/fork_database.hpp>
 #include <golos/chain/block_log.hpp>
+#include <golos/chain/snapshot.hpp>
 #include <golos/chain/hardfork.hpp>
+#include <golos/chain/apply_timing_stats.hpp>
+#include <golos/chain/priority_lock.hpp>
+#include <golos/chain/shared_memory_flusher.hpp>
+#include <golos/chain/shared_memory_growth.hpp>
+#include <golos/chain/shared_memory_mapping.hpp>
+#include <golos/chain/recent_transaction_cache.hpp>
+#include <golos/chain/operation_notification.hpp>
 #include <golos/protocol/protocol.hpp>
+#include <golos/protocol/transaction_memo.hpp>
 
 #include <fc/signals.hpp>
 
 #include <fc/log/logger.hpp>
 
+#include <functional>
 #include <map>
 
 namespace golos { namespace chain {
@@ -26,10 +36,41 @@ namespace golos { namespace chain {
 
         class custom_operation_interpreter;
 
-        struct operation_notification;
-
         struct comment_curation_info;
 
+        struct prevalidated_block;
+
+        struct prevalidated_transaction;
+
+        /**
+         * Transaction pushed by @ref database::push_transactions, error is set if it wasn't accepted
+         */
+        struct transaction_push_request {
+            signed_transaction trx;
+            uint32_t skip = 0;
+            std::exception_ptr error;
+        };
+
+        /**
+         * Handlers of a plugin, which are called by @ref database::reindex_plugins instead of signals,
+         *   empty handlers are skipped
+         */
+        struct plugin_reindex_handlers {
+            std::function<void(operation_notification&)> pre_apply_operation;
+            std::function<void(const operation_notification&)> post_apply_operation;
+            std::function<void(const signed_block&)> applied_block;
+        };
+
+        /// Counts of operations passed to plugins by @ref database::reindex_plugins
+        struct plugins_reindex_info {
+            uint64_t operations = 0;
+            uint64_t failed_operations = 0; ///< operations, on which handlers threw
+        };
+
+        namespace detail {
+            struct prevalidated_block_helper;
+        }
+
         /**
          *   @class database
          *   @brief tracks the blockchain state in an extensible manner
@@ -58,6 +99,69 @@ namespace golos { namespace chain {
                 _is_generating = p;
             }
 
+            /**
+             * Locks of chainbase are taken through the priority gate (see priority_lock),
+             *   the weak locks wait for it not longer than all retries of the chainbase lock
+             */
+            template <typename Lambda>
+            auto with_weak_read_lock(Lambda&& callback, lock_source source = lock_source::api_read)
+                -> decltype(callback())
+            {
+                priority_lock::guard guard(_priority_lock, source,
+                    fc::microseconds(read_wait_micro() * max_read_wait_retries()));
+                return chainbase::database::with_weak_read_lock([&]() -> decltype(callback()) {
+                    guard.locked();
+                    return callback();
+                });
+            }
+
+            template <typename Lambda>
+            auto with_strong_read_lock(Lambda&& callback, lock_source source = lock_source::api_read)
+                -> decltype(callback())
+            {
+                priority_lock::guard guard(_priority_lock, source, fc::microseconds::maximum());
+                return chainbase::database::with_strong_read_lock([&]() -> decltype(callback()) {
+                    guard.locked();
+                    return callback();
+                });
+            }
+
+            template <typename Lambda>
+            auto with_weak_write_lock(Lambda&& callback, lock_source source = lock_source::transaction_write)
+                -> decltype(callback())
+            {
+                priority_lock::guard guard(_priority_lock, source,
+                    fc::microseconds(write_wait_micro() * max_write_wait_retries()));
+                return chainbase::database::with_weak_write_lock([&]() -> decltype(callback()) {
+                    guard.locked();
+                    return callback();
+                });
+            }
+
+            template <typename Lambda>
+            auto with_strong_write_lock(Lambda&& callback, lock_source source = lock_source::block_write)
+                -> decltype(callback())
+            {
+                priority_lock::guard guard(_priority_lock, source, fc::microseconds::maximum());
+                return chainbase::database::with_strong_write_lock([&]() -> decltype(callback()) {
+                    guard.locked();
+                    return callback();
+                });
+            }
+
+            void set_priority_lock(bool value) {
+                _priority_lock.set_enabled(value);
+            }
+
+            /// Wait and hold times of the database lock by kinds of acquisitions
+            std::vector<lock_stats_item> get_lock_stats() const {
+                return _priority_lock.get_stats();
+            }
+
+            void clear_lock_stats() {
+                _priority_lock.clear_stats();
+            }
+
             bool _is_producing = false;
             bool _is_generating = false;
             bool _is_testing = false;           ///< set for tests to avoid low free memory spam
@@ -108,9 +212,79 @@ namespace golos { namespace chain {
             void reindex(const fc::path &data_dir, const fc::path &shared_mem_dir, uint32_t from_block_num, uint64_t shared_file_size = (
                     1024l * 1024l * 1024l * 8l));
 
+            /**
+             * @brief Rebuild the state of the given plugins from the block log without applying of blocks
+             *
+             * Objects of indexes added for the plugins are removed, then operations of blocks up to the head block
+             * are passed only to handlers of the plugins, other plugins and signals aren't notified. Evaluators
+             * aren't called, so plugins read the consensus state as of the head block, only the number, the id and
+             * the time of the head block follow the reindexed blocks. Virtual operations aren't generated, because
+             * only evaluators create them, so only plugins registered by @ref add_reindexable_plugin are accepted.
+             *
+             * Should be called after @ref database::open, when the state is at the block from the block log.
+             */
+            plugins_reindex_info reindex_plugins(const std::vector<std::string>& plugins);
+
+            /**
+             * Allows to rebuild the plugin by @ref reindex_plugins, it is called on initialization of the plugin.
+             *   The state of the plugin shouldn't depend on virtual operations, its indexes should be added
+             *   by @ref add_plugin_index with the name of the plugin.
+             */
+            void add_reindexable_plugin(const std::string& plugin, plugin_reindex_handlers handlers);
+
+            /// true while @ref database::reindex_plugins passes operations to plugins
+            bool is_reindexing_plugins() const {
+                return _is_reindexing_plugins;
+            }
+
+            /**
+             * Applies the next irreversible block without undo history, like the replay does, and appends it
+             * to the block log. Used to keep a copy of the state at the last irreversible block of other database,
+             * the caller should hold the write lock.
+             */
+            void apply_irreversible_block(const signed_block &block);
+
+            /**
+             * @brief Open a database with the state loaded from the snapshot
+             *
+             * The existing state is wiped. The block log is kept and has to contain the block of the snapshot,
+             * so the database continues from it as after a replay up to this block.
+             *
+             * @param snapshot Path to the snapshot written by @ref database::export_snapshot
+             */
+            void open_from_snapshot(const fc::path &data_dir, const fc::path &shared_mem_dir, const fc::path &snapshot,
+                    uint64_t shared_file_size = 0, uint32_t chainbase_flags = chainbase::database::read_write);
+
+            /**
+             * @brief Write the state of the database to the snapshot
+             *
+             * The head block has to be in the block log, i.e. the state has to be irreversible.
+             * Sections are written in parallel to temporary files, which are joined into the snapshot.
+             *
+             * @param include_plugins Write also sections of plugin indexes with reflected objects
+             * @param threads Number of threads writing sections
+             */
+            void export_snapshot(const fc::path &snapshot, bool include_plugins, uint32_t threads);
+
+            void add_snapshot_section(std::unique_ptr<snapshot_section> section);
+
             void set_min_free_shared_memory_size(size_t);
             void set_inc_shared_memory_size(size_t);
             void set_block_num_check_free_size(uint32_t);
+
+            /// @param advice combination of shared_memory_advice flags applied to the mapping on open and resize
+            void set_shared_memory_advice(uint32_t advice);
+
+            /// @param threads number of threads reading all pages of shared memory on open, 0 - disable
+            void set_shared_memory_prefault_threads(uint32_t threads);
+
+            /// The page-aligned start and the size of the mapping of the shared memory file
+            std::pair<char*, std::size_t> get_shared_memory_mapping();
+            void set_replay_reader_threads(uint32_t);
+            void set_replay_prefetch_blocks(uint32_t);
+            void set_block_log_chunk_blocks(uint32_t);
+            void set_block_log_cache_chunks(uint32_t);
+            void set_apply_timing_log_interval(uint32_t);
             void check_free_memory(bool skip_print, uint32_t current_block_num);
 
             void set_skip_virtual_ops();
@@ -154,8 +328,16 @@ namespace golos { namespace chain {
 
             optional<signed_block> fetch_block_by_number(uint32_t num) const;
 
+            /// Takes the transaction from the cache of recent transactions, throws if it isn't there
             const signed_transaction get_recent_transaction(const transaction_id_type &trx_id) const;
 
+            /// @param value maximum number of transactions kept for get_recent_transaction, 0 - disable
+            void set_recent_transaction_cache_size(uint32_t value);
+
+            recent_transaction_cache_stats get_recent_transaction_cache_stats() const {
+                return _recent_transactions.get_stats();
+            }
+
             std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
             chain_id_type get_chain_id() const;
@@ -247,18 +429,32 @@ namespace golos { namespace chain {
 
             uint32_t validate_block(const signed_block &b, uint32_t skip = skip_nothing);
 
-            bool push_block(const signed_block &b, uint32_t skip = skip_nothing);
+            /**
+             * @param prevalidated results of the state-independent checks of the block made in advance,
+             *        see @ref block_prevalidator
+             */
+            bool push_block(
+                const signed_block &b, uint32_t skip = skip_nothing,
+                std::shared_ptr<const prevalidated_block> prevalidated = nullptr);
 
             void enable_plugins_on_push_transaction(bool);
 
             void push_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing);
 
+            /**
+             * Pushes transactions in order under one acquisition of the write lock,
+             *   a failed transaction doesn't stop pushing of others
+             */
+            void push_transactions(std::vector<transaction_push_request> &requests);
+
             void _maybe_warn_multiple_production(uint32_t height) const;
 
             bool _push_block(const signed_block &b, uint32_t skip);
 
             void _push_transaction(const signed_transaction &trx, uint32_t skip);
 
+            void _push_transaction(const signed_transaction &trx, const transaction_memo &memo, uint32_t skip);
+
             void push_proposal(const proposal_object&);
 
             void remove(const proposal_object&);
@@ -279,6 +475,31 @@ namespace golos { namespace chain {
                     uint32_t skip
             );
 
+            /**
+             * Information about the last block assembled by generate_block()
+             */
+            struct block_assembly_info {
+                fc::microseconds assembly_time; ///< selection of pending transactions, without applying the block
+                uint32_t transactions = 0;
+                uint32_t postponed_transactions = 0;
+                bool reused_pending_state = false; ///< pending transactions were not reapplied
+            };
+
+            const block_assembly_info& last_block_assembly() const {
+                return _last_block_assembly;
+            }
+
+            /**
+             * Counts and durations of operations and steps of block applying since the start of the node,
+             *   they can be read without locks of the database
+             */
+            const apply_timing_stats& get_apply_timing_stats() const {
+                return _apply_timing;
+            }
+
+            /// @return stats before the clearing
+            apply_timing_info clear_apply_timing_stats();
+
             void pop_block();
 
             void clear_pending();
@@ -316,6 +537,16 @@ namespace golos { namespace chain {
              */
             fc::signal<void(const signed_block &)> applied_block;
 
+            /**
+             *  This signal is emitted after applied_block with all operations and virtual operations
+             *  of the block in the order of applying. The batch is immutable and can be kept by
+             *  the receiver to process it later in other thread, so the plugins without the state
+             *  in the database can take their work out of the block applying.
+             *
+             *  Operations are collected only if the signal has connected slots.
+             */
+            fc::signal<void(const operation_batch_ptr &)> applied_operation_batch;
+
             /**
              * This signal is emitted any time a new transaction is added to the pending
              * block state.
@@ -489,6 +720,9 @@ namespace golos { namespace chain {
             /// Reset the object graph in-memory
             void initialize_indexes();
 
+            /// Throws database_state_version_exception if the existing state has another layout of objects
+            void check_state_version(bool is_writable);
+
             void init_schema();
 
             void init_genesis(uint64_t initial_supply = STEEMIT_INIT_SUPPLY);
@@ -541,6 +775,16 @@ namespace golos { namespace chain {
 
             void set_flush_interval(uint32_t flush_blocks);
 
+            /**
+             * Flush the shared memory in the background thread instead of the applying one
+             * @param max_bytes_per_sec the rate limit of the flush, 0 - without the limit
+             */
+            void set_async_flush(bool value, uint64_t max_bytes_per_sec);
+
+            shared_memory_flush_stats get_flush_stats() const {
+                return _flusher.get_stats();
+            }
+
 #ifdef STEEMIT_BUILD_TESTNET
             bool liquidity_rewards_enabled = true;
             bool skip_price_feed_limit_check = true;
@@ -567,7 +811,10 @@ namespace golos { namespace chain {
 
             void _apply_transaction(const signed_transaction &trx, uint32_t skip);
 
-            void _validate_transaction(const signed_transaction& trx, uint32_t skip);
+            /// @param memo the id, digests and size of trx computed once for the whole push and apply path
+            void _apply_transaction(const signed_transaction &trx, const transaction_memo &memo, uint32_t skip);
+
+            void _validate_transaction(const signed_transaction& trx, const transaction_memo& memo, uint32_t skip);
 
             void apply_operation(const operation &op, bool is_virtual = false);
 
@@ -616,6 +863,15 @@ namespace golos { namespace chain {
             std::unique_ptr<database_impl> _my;
 
             vector<signed_transaction> _pending_tx;
+
+            /// Packed size and skip flags of the each pending transaction, in the same order as _pending_tx
+            struct pending_transaction_info {
+                uint32_t packed_size = 0;
+                uint32_t skip = 0;
+            };
+            vector<pending_transaction_info> _pending_tx_info;
+
+            block_assembly_info _last_block_assembly;
             fork_database _fork_db;
             fc::time_point_sec _hardfork_times[STEEMIT_NUM_HARDFORKS + 1];
             protocol::hardfork_version _hardfork_versions[STEEMIT_NUM_HARDFORKS + 1];
@@ -624,30 +880,71 @@ namespace golos { namespace chain {
 
             // this function needs access to _plugin_index_signal
             template<typename MultiIndexType>
-            friend void add_plugin_index(database &db);
+            friend void add_plugin_index(database &db, const std::string& plugin);
 
             friend struct database_fixture;
 
+            friend struct detail::prevalidated_block_helper;
+
             fc::signal<void()> _plugin_index_signal;
 
+            /// cleaners of indexes by names of plugins
+            std::map<std::string, std::vector<std::function<void()>>> _plugin_index_cleaners;
+            std::map<std::string, plugin_reindex_handlers> _plugin_reindex_handlers;
+            bool _is_reindexing_plugins = false;
+
+            void notify_block_operations(
+                const signed_block &block, const std::vector<const plugin_reindex_handlers*> &handlers,
+                plugins_reindex_info &info);
+
+            void import_snapshot(const fc::path &snapshot);
+
+            std::vector<std::unique_ptr<snapshot_section>> _snapshot_sections;
+            fc::path _snapshot_to_import;
+
+            std::shared_ptr<operation_batch> _operation_batch;
+
             transaction_id_type _current_trx_id;
             uint32_t _current_block_num = 0;
             uint16_t _current_trx_in_block = 0;
             uint16_t _current_op_in_trx = 0;
             uint32_t _current_virtual_op = 0;
 
+            std::shared_ptr<const prevalidated_block> _prevalidated_block;
+            const prevalidated_transaction* _current_prevalidated_trx = nullptr;
+
             flat_map<uint32_t, block_id_type> _checkpoints;
 
             uint32_t _flush_blocks = 0;
             uint32_t _next_flush_block = 0;
+            bool _async_flush = false;
+            shared_memory_flusher _flusher;
 
             uint32_t _last_free_gb_printed = 0;
 
+            shared_memory_growth _growth;
+
+            recent_transaction_cache _recent_transactions;
+
+            uint32_t _shared_memory_advice = shared_memory_advice_normal;
+            uint32_t _shared_memory_prefault_threads = 0;
+
             size_t _inc_shared_memory_size = 0;
             size_t _min_free_shared_memory_size = 0;
 
             uint32_t _block_num_check_free_memory = 1000;
 
+            uint32_t _replay_reader_threads = 2;
+            uint32_t _replay_prefetch_blocks = 1000;
+
+            uint32_t _block_log_chunk_blocks = 0;
+            uint32_t _block_log_cache_chunks = 16;
+
+            apply_timing_stats _apply_timing;
+            uint32_t _apply_timing_log_interval = 0;
+
+            priority_lock _priority_lock;
+
             uint32_t _clear_votes_block = 0;
             bool _skip_virtual_ops = false;
             bool _enable_plugins_on_push_transaction = true;
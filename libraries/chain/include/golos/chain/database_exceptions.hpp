@@ -42,6 +42,10 @@ namespace golos {
 
         FC_DECLARE_DERIVED_EXCEPTION(database_signal_exception, golos::chain::chain_exception, 4130000, "database signal exception")
 
+        FC_DECLARE_DERIVED_EXCEPTION(lock_timeout_exception, golos::chain::chain_exception, 4140000, "database lock timeout")
+
+        FC_DECLARE_DERIVED_EXCEPTION(database_state_version_exception, golos::chain::chain_exception, 4150000, "database state version exception")
+
     }
 } // golos::chain
 
@@ -97,6 +97,22 @@ namespace golos {
                 database &_db;
             };
 
+            /**
+             * Class is used to pass results of block prevalidation to push_block
+             */
+            struct prevalidated_block_helper final {
+                prevalidated_block_helper(database& db, std::shared_ptr<const prevalidated_block> block): _db(db) {
+                    _db._prevalidated_block = std::move(block);
+                }
+
+                ~prevalidated_block_helper() {
+                    _db._current_prevalidated_trx = nullptr;
+                    _db._prevalidated_block.reset();
+                }
+
+                database &_db;
+            };
+
             /**
              * Empty pending_transactions, call callback,
              * then reset pending_transactions after callback is done.
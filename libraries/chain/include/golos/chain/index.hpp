@@ -6,18 +6,52 @@ namespace golos {
     namespace chain {
 
         template<typename MultiIndexType>
-        void _add_index_impl(database &db) {
+        void _add_snapshot_section(database &db, bool is_core, std::true_type) {
+            db.add_snapshot_section(std::make_unique<index_snapshot_section<MultiIndexType>>(db, is_core));
+        }
+
+        template<typename MultiIndexType>
+        void _add_snapshot_section(database &db, bool is_core, std::false_type) {
+            // objects aren't reflected, the index isn't written to snapshots
+        }
+
+        template<typename MultiIndexType>
+        void _add_index_impl(database &db, bool is_core) {
             db.add_index<MultiIndexType>();
+
+            using object_type = typename MultiIndexType::value_type;
+            _add_snapshot_section<MultiIndexType>(db, is_core,
+                std::integral_constant<bool, fc::reflector<object_type>::is_defined::value>());
         }
 
         template<typename MultiIndexType>
         void add_core_index(database &db) {
-            _add_index_impl<MultiIndexType>(db);
+            static_assert(fc::reflector<typename MultiIndexType::value_type>::is_defined::value,
+                "Objects of core index should be reflected to be written to snapshots");
+            _add_index_impl<MultiIndexType>(db, true);
+        }
+
+        /// @param plugin the name of the plugin, its indexes are cleared by database::reindex_plugins
+        template<typename MultiIndexType>
+        void add_plugin_index(database &db, const std::string& plugin) {
+            db._plugin_index_signal.connect([&db, plugin]() {
+                _add_index_impl<MultiIndexType>(db, false);
+
+                if (plugin.empty()) {
+                    return;
+                }
+                db._plugin_index_cleaners[plugin].push_back([&db]() {
+                    const auto& idx = db.get_index<MultiIndexType>().indices();
+                    while (!idx.empty()) {
+                        db.remove(*idx.begin());
+                    }
+                });
+            });
         }
 
         template<typename MultiIndexType>
         void add_plugin_index(database &db) {
-            db._plugin_index_signal.connect([&db]() { _add_index_impl<MultiIndexType>(db); });
+            add_plugin_index<MultiIndexType>(db, std::string());
         }
 
     }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    /**
+     * Processes batches from database::applied_operation_batch in own thread.
+     *
+     * The handler is called under the read lock of the database in order of blocks, so it can read
+     * the state, but the state can be ahead of the processed block. When the queue reaches max_lag
+     * blocks, all queued batches are processed synchronously in the applying thread, which holds
+     * the write lock, so the lag is bounded and the replay (which doesn't release the lock) works.
+     * With zero max_lag or before start() batches are processed synchronously.
+     */
+    class operation_batch_worker final {
+    public:
+        using handler_type = std::function<void(const operation_batch&)>;
+
+        operation_batch_worker(database& db, std::string name, handler_type handler);
+
+        ~operation_batch_worker();
+
+        void start(uint32_t max_lag);
+
+        /// Processes queued batches and stops the thread
+        void stop();
+
+        /// Called from the slot of database::applied_operation_batch
+        void push(operation_batch_ptr batch);
+
+        /// Number of batches waiting for the worker
+        uint32_t queue_size() const;
+
+        uint64_t processed_batches() const;
+
+        /// How many times the queue was processed in the applying thread because of the lag
+        uint64_t sync_drains() const;
+
+    private:
+        void work_loop();
+
+        /// Logs only the first failure of the stall
+        void log_stall(const std::string& error);
+
+        void process_queue(std::size_t max_batches);
+
+        database& _db;
+        const std::string _name;
+        const handler_type _handler;
+        uint32_t _max_lag = 0;
+
+        std::thread _thread;
+        mutable std::mutex _queue_mutex;
+        std::mutex _process_mutex;
+        std::condition_variable _cv;
+        std::deque<operation_batch_ptr> _queue;
+        bool _is_stopped = false;
+        bool _is_stalled = false; ///< is accessed only by the worker thread
+
+        std::atomic<uint64_t> _processed_batches{0};
+        std::atomic<uint64_t> _sync_drains{0};
+    };
+
+} } // namespace golos::chain
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <golos/protocol/block.hpp>
 #include <golos/protocol/operations.hpp>
 #include <golos/chain/steem_object_types.hpp>
 
+#include <memory>
+
 namespace golos { namespace chain {
 
 using protocol::operation;
+using protocol::signed_block;
 
 struct operation_notification {
     operation_notification(const operation &o) : op(o) {
@@ -21,4 +25,36 @@ struct operation_notification {
     const operation& op;
 };
 
+/**
+ * Copy of the notification, which stays valid after the operation is applied
+ */
+struct applied_operation_notification {
+    applied_operation_notification(const operation_notification &note)
+            : trx_id(note.trx_id),
+              block(note.block),
+              trx_in_block(note.trx_in_block),
+              op_in_trx(note.op_in_trx),
+              virtual_op(note.virtual_op),
+              op(note.op) {
+    }
+
+    transaction_id_type trx_id;
+    uint32_t block = 0;
+    uint32_t trx_in_block = 0;
+    uint16_t op_in_trx = 0;
+    uint32_t virtual_op = 0;
+    operation op;
+};
+
+/**
+ * Immutable operations of the applied block, in the order of applying
+ */
+struct operation_batch {
+    std::shared_ptr<const signed_block> block;
+    uint32_t last_irreversible_block_num = 0;
+    std::vector<applied_operation_notification> operations;
+};
+
+using operation_batch_ptr = std::shared_ptr<const operation_batch>;
+
 } } // golos::chain
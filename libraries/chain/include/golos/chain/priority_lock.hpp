@@ -0,0 +1,116 @@
+#pragma once
+
+#include <golos/chain/apply_timing_stats.hpp>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace golos { namespace chain {
+
+    /**
+     * Who takes the database lock, wait and hold times are counted separately for each kind
+     */
+    enum class lock_source: uint8_t {
+        api_read,
+        p2p_read,
+        block_write,
+        transaction_write,
+        count
+    };
+
+    struct lock_stats_item {
+        std::string source;
+        latency_histogram wait;
+        latency_histogram hold;
+        uint64_t timeouts = 0;
+        uint32_t waiting = 0; ///< acquisitions waiting for the gate now
+    };
+
+    using golos::protocol::read_lock_timer;
+
+    /**
+     * Gate in front of the chainbase lock, which gives priority to writers.
+     *
+     * A block writer waits only for current holders: new readers and transaction writers wait while it waits.
+     *   Readers, which came while a writer waits, are queued and enter all together after it, so readers and
+     *   transaction writers alternate instead of retrying the chainbase lock. The chainbase lock is free when
+     *   the gate is passed, and the weak acquisitions fail with lock_timeout_exception after the maximum wait.
+     *
+     * Nested acquisitions in a thread, which already holds the gate, pass through it.
+     *   If the gate is disabled, only wait and hold times are counted.
+     */
+    class priority_lock final {
+    public:
+        priority_lock();
+
+        void set_enabled(bool value) {
+            _is_enabled = value;
+        }
+
+        bool enabled() const {
+            return _is_enabled;
+        }
+
+        /**
+         * Passes the gate in constructor and leaves it in destructor,
+         *   locked() should be called when the chainbase lock is taken.
+         */
+        class guard final {
+        public:
+            /// @param max_wait fc::microseconds::maximum() - wait without limit
+            guard(priority_lock& lock, lock_source source, const fc::microseconds& max_wait);
+
+            ~guard();
+
+            void locked();
+
+        private:
+            priority_lock& _lock;
+            lock_source _source;
+            bool _is_nested;
+            bool _is_gated = false;
+            bool _is_locked = false;
+            fc::time_point _start;
+            fc::time_point _locked;
+        };
+
+        std::vector<lock_stats_item> get_stats() const;
+
+        void clear_stats();
+
+    private:
+        static bool is_read(lock_source source) {
+            return source == lock_source::api_read || source == lock_source::p2p_read;
+        }
+
+        void acquire_read(lock_source source, const fc::microseconds& max_wait);
+        void release_read();
+
+        void acquire_write(lock_source source, const fc::microseconds& max_wait);
+        void release_write();
+
+        void add_wait(lock_source source, const fc::microseconds& duration);
+        void add_hold(lock_source source, const fc::microseconds& duration);
+        void add_timeout(lock_source source);
+        void add_waiting(lock_source source, int32_t delta);
+
+        bool _is_enabled = false;
+
+        std::mutex _mutex;
+        std::condition_variable _readers_cv;
+        std::condition_variable _writers_cv;
+        uint32_t _readers = 0;
+        uint32_t _waiting_readers = 0;
+        uint64_t _read_phase = 0; ///< is changed when a writer lets in all waiting readers
+        bool _writer = false;
+        uint32_t _waiting_block_writers = 0;
+        uint32_t _waiting_writers = 0;
+
+        mutable std::mutex _stats_mutex;
+        std::vector<lock_stats_item> _stats;
+    };
+
+} } // golos::chain
+
+FC_REFLECT_ENUM(golos::chain::lock_source, (api_read)(p2p_read)(block_write)(transaction_write)(count))
+FC_REFLECT((golos::chain::lock_stats_item), (source)(wait)(hold)(timeouts)(waiting))
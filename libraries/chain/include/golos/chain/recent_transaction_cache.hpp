@@ -0,0 +1,78 @@
+#pragma once
+
+#include <golos/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <mutex>
+
+namespace golos { namespace chain {
+
+    using golos::protocol::signed_transaction;
+    using golos::protocol::transaction_id_type;
+
+    struct recent_transaction_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint32_t size = 0;
+        uint32_t max_size = 0;
+    };
+
+    /**
+     * Keeps bodies of applied transactions until they expire, so they can be served to peers by id.
+     *
+     * The dedupe index in shared memory has only ids and expirations of transactions, bodies are kept
+     *   here in the process memory, out of the undo log. The cache isn't reverted on pop of blocks,
+     *   so a transaction can be found here after it was popped.
+     */
+    class recent_transaction_cache final {
+    public:
+        /// 0 - disables the cache
+        void set_max_size(uint32_t value);
+
+        void add(const transaction_id_type& trx_id, const signed_transaction& trx);
+
+        /// @return true and fills trx if the transaction is in the cache
+        bool find(const transaction_id_type& trx_id, signed_transaction& trx) const;
+
+        /// Removes transactions which expired before the time
+        void remove_expired(fc::time_point_sec now);
+
+        void clear();
+
+        recent_transaction_cache_stats get_stats() const;
+
+    private:
+        struct item {
+            transaction_id_type trx_id;
+            fc::time_point_sec expiration;
+            signed_transaction trx;
+        };
+
+        struct by_trx_id;
+        struct by_expiration;
+
+        using item_index = boost::multi_index_container<
+            item,
+            boost::multi_index::indexed_by<
+                boost::multi_index::hashed_unique<
+                    boost::multi_index::tag<by_trx_id>,
+                    boost::multi_index::member<item, transaction_id_type, &item::trx_id>,
+                    std::hash<transaction_id_type>>,
+                boost::multi_index::ordered_non_unique<
+                    boost::multi_index::tag<by_expiration>,
+                    boost::multi_index::member<item, fc::time_point_sec, &item::expiration>>>>;
+
+        mutable std::mutex _mutex;
+        item_index _items;
+        uint32_t _max_size = 0;
+        mutable uint64_t _hits = 0;
+        mutable uint64_t _misses = 0;
+    };
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::recent_transaction_cache_stats), (hits)(misses)(size)(max_size))
@@ -110,3 +110,19 @@ namespace golos {
 
 FC_REFLECT_TYPENAME((golos::chain::shared_authority::account_authority_map))
 FC_REFLECT((golos::chain::shared_authority), (weight_threshold)(account_auths)(key_auths))
+
+namespace fc { namespace raw {
+
+    template<typename Stream>
+    inline void pack(Stream &s, const golos::chain::shared_authority &a) {
+        pack(s, golos::protocol::authority(a));
+    }
+
+    template<typename Stream>
+    inline void unpack(Stream &s, golos::chain::shared_authority &a, uint32_t depth = 0) {
+        golos::protocol::authority auth;
+        unpack(s, auth, depth);
+        a = auth;
+    }
+
+} } // fc::raw
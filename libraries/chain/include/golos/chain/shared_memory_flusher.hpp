@@ -0,0 +1,84 @@
+#pragma once
+
+#include <golos/chain/apply_timing_stats.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    struct shared_memory_flush_stats {
+        uint64_t flushes = 0;            ///< finished flushes of the whole file
+        uint64_t synced_bytes = 0;       ///< size of synced ranges, clean pages are skipped by the kernel
+        uint64_t errors = 0;             ///< failed msync calls, the flush is dropped on an error
+        latency_histogram duration;      ///< durations of whole flushes
+        uint32_t last_flushed_block = 0; ///< the block, which was applied when the last finished flush started
+        uint32_t flushing_block = 0;     ///< the block of the current flush, 0 - nothing is flushed now
+    };
+
+    /**
+     * Flushes the shared memory file in the background thread.
+     *
+     * The applying thread only marks the block after which the flush should be made, the background thread
+     *   syncs the mapping by chunks with the rate limit. Pages, which are changed during the flush, are written
+     *   with their new contents, so as with the synchronous flush, the file on disk is consistent only after
+     *   a clean close, and the revision of chainbase is still checked on opening.
+     */
+    class shared_memory_flusher final {
+    public:
+        shared_memory_flusher() = default;
+
+        ~shared_memory_flusher();
+
+        /// @param max_bytes_per_sec 0 - without the rate limit
+        void set_rate_limit(uint64_t max_bytes_per_sec) {
+            _max_bytes_per_sec = max_bytes_per_sec;
+        }
+
+        /**
+         * Starts the flush of the mapping, if the previous one is finished, should be called under the write lock.
+         * The base should be aligned to the page.
+         * @return false if the previous flush isn't finished yet
+         */
+        bool mark(uint32_t block_num, char* base, std::size_t size);
+
+        /// Waits for the current chunk and drops the current flush, the mapping can be changed after it
+        void cancel();
+
+        /// Drops the current flush and stops the thread
+        void stop();
+
+        /// Counts the synchronous flush of the whole file
+        void add_sync_flush(uint32_t block_num, std::size_t size, const fc::microseconds& duration);
+
+        shared_memory_flush_stats get_stats() const;
+
+    private:
+        void work_loop();
+
+        static constexpr std::size_t chunk_size = 16 * 1024 * 1024;
+
+        std::atomic<uint64_t> _max_bytes_per_sec{0};
+
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        std::thread _thread;
+        bool _is_stopped = false;
+
+        char* _base = nullptr;
+        std::size_t _size = 0;
+        std::size_t _offset = 0;
+        fc::time_point _start;
+
+        /// held while a chunk is synced, so cancel() waits for it
+        std::mutex _sync_mutex;
+
+        shared_memory_flush_stats _stats;
+    };
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::shared_memory_flush_stats),
+    (flushes)(synced_bytes)(errors)(duration)(last_flushed_block)(flushing_block))
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <fc/time.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    /**
+     * Predicts the growth of the shared memory and prepares it ahead of need.
+     *
+     * The rate of allocation is the exponential moving average of used bytes per block. When the free memory
+     *   is going to end soon, disk space for the next increment of the file is reserved in the background thread,
+     *   so the resize at the block boundary only remaps the file. After the resize, pages of the new tail
+     *   are prefaulted in the background thread too, so the applying thread doesn't pay for page faults.
+     */
+    class shared_memory_growth final {
+    public:
+        shared_memory_growth() = default;
+
+        ~shared_memory_growth();
+
+        /// The file of the shared memory, its space is reserved before resizes
+        void set_file(std::string file);
+
+        /// Counts the used memory after the block
+        void add_block(uint32_t block_num, uint64_t used_memory);
+
+        /// Predicted allocation rate, not less than 0
+        double bytes_per_block() const;
+
+        /// Predicted number of blocks until the free memory drops below min_free
+        uint32_t blocks_left(uint64_t free_memory, uint64_t min_free) const;
+
+        /**
+         * Reserves the disk space of the file from file_size to file_size + inc_size in the background thread,
+         *   the size of the file isn't changed.
+         * @return true if the space is already reserved
+         */
+        bool reserve(uint64_t file_size, uint64_t inc_size);
+
+        /// Waits for the current chunk and drops the prefault, the mapping can be changed after it
+        void cancel();
+
+        /**
+         * Logs the predicted and actual growth since the previous resize and starts the prefault
+         *   of the new tail of the mapping, should be called after the resize under the write lock.
+         * @param tail the start of the new tail, the prefault starts from the page with it
+         */
+        void resized(uint32_t block_num, uint64_t used_memory, char* tail, std::size_t tail_size);
+
+        /// True while the new tail is prefaulted
+        bool is_populating() const;
+
+        /// Bytes prefaulted since the start
+        uint64_t populated_bytes() const;
+
+        /// Chunks which weren't prefaulted, because madvise() failed
+        uint64_t populate_errors() const;
+
+        /// Drops pending work and stops the thread
+        void stop();
+
+    private:
+        void start_thread();
+
+        void work_loop();
+
+        void reserve_space(uint64_t offset, uint64_t size);
+
+        static constexpr std::size_t chunk_size = 16 * 1024 * 1024;
+
+        /// weight of the last block in the average, it covers the last several thousands of blocks
+        static constexpr double rate_weight = 0.001;
+
+        uint32_t _last_block_num = 0;
+        uint64_t _last_used_memory = 0;
+        double _rate = 0;
+
+        uint32_t _resize_block_num = 0;
+        uint64_t _resize_used_memory = 0;
+        double _resize_rate = 0;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        std::thread _thread;
+        bool _is_stopped = false;
+
+        std::string _file;
+        uint64_t _reserve_offset = 0;
+        uint64_t _reserve_size = 0;
+        bool _is_reserve_pending = false;
+        bool _is_reserved = false;
+
+        char* _populate_base = nullptr;
+        std::size_t _populate_offset = 0;
+        std::size_t _populate_end = 0;
+        std::size_t _populate_size = 0;
+        fc::time_point _populate_start;
+        uint64_t _populated_bytes = 0;
+        uint64_t _populate_errors = 0;
+
+        /// held while a chunk is prefaulted, so cancel() waits for it
+        std::mutex _populate_mutex;
+    };
+
+} } // golos::chain
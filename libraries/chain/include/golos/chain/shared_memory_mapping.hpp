@@ -0,0 +1,43 @@
+#pragma once
+
+#include <fc/filesystem.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace golos { namespace chain {
+
+    /// Hints passed to madvise() for the mapping of the shared memory, can be combined
+    enum shared_memory_advice : uint32_t {
+        shared_memory_advice_normal = 0,
+        shared_memory_advice_random = 1 << 0,   ///< disables readahead on page faults
+        shared_memory_advice_willneed = 1 << 1, ///< starts reading of the whole file into the page cache
+        shared_memory_advice_hugepage = 1 << 2, ///< transparent huge pages, the file should be on tmpfs
+    };
+
+    /// Parses names of advices ("normal", "random", "willneed", "hugepage")
+    uint32_t parse_shared_memory_advice(const std::vector<std::string>& names);
+
+    std::string shared_memory_advice_to_string(uint32_t advice);
+
+    /**
+     * The range of whole pages, which covers the range, as madvise() and msync() need the address aligned to the page.
+     * The segment manager lies after the header of the mapping, so its range is extended to the whole mapping.
+     */
+    std::pair<char*, std::size_t> page_aligned_range(char* addr, std::size_t size);
+
+    /**
+     * Applies advices to the mapping, should be repeated after each remap
+     * @param base the start of the mapping, it should be aligned to the page
+     * @return false if some advice failed
+     */
+    bool advise_shared_memory(char* base, std::size_t size, uint32_t advice);
+
+    /// Reads all pages of the mapping in several threads, so the first blocks don't wait for page faults
+    void prefault_shared_memory(const char* base, std::size_t size, uint32_t threads);
+
+    /// @return size of the huge page if the directory is on hugetlbfs, 0 otherwise
+    uint64_t hugetlbfs_page_size(const fc::path& dir);
+
+} } // golos::chain
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <golos/chain/steem_object_types.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+namespace golos { namespace chain {
+
+    /* The snapshot keeps the state of the database at the block from the block log.
+     *
+     * +-------+--------+------------------+-----------+-----------+-----+-----------+
+     * | Magic | Header | Section Headers  | Section 1 | Section 2 | ... | Section N |
+     * +-------+--------+------------------+-----------+-----------+-----+-----------+
+     *
+     * Each section keeps all objects of one index in order of their ids, each object is prefixed by
+     * its 4-byte packed size. The header of a section has the number of objects, the size and the sha256
+     * of the section data, so a section can be verified or skipped without unpacking of objects.
+     */
+
+    struct snapshot_header {
+        uint32_t version = 0;
+        chain_id_type chain_id;
+        uint32_t head_block_num = 0;
+        block_id_type head_block_id;
+        fc::time_point_sec head_block_time;
+    };
+
+    struct snapshot_section_header {
+        std::string name;
+        bool is_core = false;
+        uint64_t objects = 0;
+        int64_t next_id = 0;
+        uint64_t size = 0;
+        fc::sha256 checksum;
+    };
+
+    /**
+     * Writes objects of a section to the file and calculates its checksum
+     */
+    class snapshot_section_writer final {
+    public:
+        explicit snapshot_section_writer(const fc::path& file);
+
+        template<typename T>
+        void write(const T& o) {
+            _buffer.resize(fc::raw::pack_size(o));
+            fc::datastream<char*> ds(_buffer.data(), _buffer.size());
+            fc::raw::pack(ds, o);
+            write_data(_buffer.data(), _buffer.size());
+        }
+
+        /// Flushes the file and fills the size, the number of objects and the checksum of the section
+        void finish(snapshot_section_header& header);
+
+    private:
+        void write_data(const char* data, uint32_t size);
+
+        std::ofstream _out;
+        fc::sha256::encoder _encoder;
+        uint64_t _size = 0;
+        uint64_t _objects = 0;
+        std::vector<char> _buffer;
+    };
+
+    /**
+     * Reads objects of a section from the snapshot and calculates its checksum
+     */
+    class snapshot_section_reader final {
+    public:
+        snapshot_section_reader(std::istream& in, const snapshot_section_header& header);
+
+        /**
+         * Reads the next object of the section
+         * @return false if all objects were read
+         */
+        bool next();
+
+        template<typename T>
+        void read(T& o) {
+            fc::datastream<const char*> ds(_buffer.data(), _buffer.size());
+            fc::raw::unpack(ds, o);
+        }
+
+        /// Checks the size and the checksum of the read section
+        void finish();
+
+    private:
+        std::istream& _in;
+        const snapshot_section_header& _header;
+        fc::sha256::encoder _encoder;
+        uint64_t _size = 0;
+        uint64_t _objects = 0;
+        std::vector<char> _buffer;
+    };
+
+    class snapshot_section {
+    public:
+        virtual ~snapshot_section() = default;
+
+        virtual const std::string& name() const = 0;
+
+        /// Core sections are required in snapshot, sections of plugins are optional
+        virtual bool is_core() const = 0;
+
+        virtual void write(snapshot_section_writer& out, snapshot_section_header& header) const = 0;
+
+        virtual void read(snapshot_section_reader& in, const snapshot_section_header& header) = 0;
+    };
+
+    namespace detail {
+        template<typename Index, typename = void>
+        struct has_set_next_id: std::false_type {};
+
+        template<typename Index>
+        struct has_set_next_id<Index, decltype(std::declval<Index&>().set_next_id(int64_t()), void())>
+                : std::true_type {};
+
+        template<typename Index>
+        void set_next_id(Index& idx, int64_t next_id, std::true_type) {
+            idx.set_next_id(next_id);
+        }
+
+        template<typename Index>
+        void set_next_id(Index&, int64_t, std::false_type) {
+        }
+    } // namespace detail
+
+    template<typename MultiIndexType>
+    class index_snapshot_section final : public snapshot_section {
+    public:
+        using object_type = typename MultiIndexType::value_type;
+
+        index_snapshot_section(chainbase::database& db, bool is_core)
+                : _db(db),
+                  _name(fc::get_typename<object_type>::name()),
+                  _is_core(is_core) {
+        }
+
+        const std::string& name() const override {
+            return _name;
+        }
+
+        bool is_core() const override {
+            return _is_core;
+        }
+
+        void write(snapshot_section_writer& out, snapshot_section_header& header) const override {
+            const auto& idx = _db.get_index<MultiIndexType>().indices();
+            for (const auto& o: idx) {
+                out.write(o);
+            }
+            header.next_id = idx.empty() ? 0 : idx.rbegin()->id._id + 1;
+        }
+
+        void read(snapshot_section_reader& in, const snapshot_section_header& header) override {
+            FC_ASSERT(_db.get_index<MultiIndexType>().indices().empty(),
+                "Index ${name} should be empty to load snapshot", ("name", _name));
+
+            auto& idx = _db.get_mutable_index<MultiIndexType>();
+            using index_type = typename std::decay<decltype(idx)>::type;
+            using can_set_next_id = detail::has_set_next_id<index_type>;
+
+            // The index assigns ids in order of creation. If its next id can't be set directly,
+            //   ids of the removed objects are spent first to continue the same sequence of ids.
+            if (!can_set_next_id::value) {
+                for (auto gaps = header.next_id - int64_t(header.objects); gaps > 0; --gaps) {
+                    _db.remove(_db.create<object_type>([](object_type&) {}));
+                }
+            }
+
+            while (in.next()) {
+                // the id is replaced by the id from the snapshot
+                _db.create<object_type>([&](object_type& o) {
+                    in.read(o);
+                });
+            }
+
+            detail::set_next_id(idx, header.next_id, can_set_next_id());
+        }
+
+    private:
+        chainbase::database& _db;
+        std::string _name;
+        bool _is_core;
+    };
+
+} } // golos::chain
+
+FC_REFLECT((golos::chain::snapshot_header), (version)(chain_id)(head_block_num)(head_block_id)(head_block_time))
+FC_REFLECT((golos::chain::snapshot_section_header), (name)(is_core)(objects)(next_id)(size)(checksum))
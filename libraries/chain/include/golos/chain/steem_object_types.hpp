@@ -7,6 +7,9 @@
 
 #include <chainbase/chainbase.hpp>
 
+#include <boost/interprocess/containers/deque.hpp>
+#include <boost/interprocess/containers/flat_set.hpp>
+
 #include <golos/protocol/types.hpp>
 #include <golos/protocol/authority.hpp>
 
@@ -201,6 +204,104 @@ namespace fc {
             unpack(ds, v, depth);
             return v;
         }
+
+        // Containers of objects are unpacked in place, because their memory is allocated in the shared memory
+
+        template<typename Stream>
+        inline void pack(Stream &s, const golos::chain::shared_string &v) {
+            pack(s, unsigned_int((uint32_t)v.size()));
+            if (v.size()) {
+                s.write(v.data(), v.size());
+            }
+        }
+
+        template<typename Stream>
+        inline void unpack(Stream &s, golos::chain::shared_string &v, uint32_t depth = 0) {
+            unsigned_int size;
+            unpack(s, size, depth);
+            v.resize(size.value);
+            if (size.value) {
+                s.read(&v[0], size.value);
+            }
+        }
+
+        template<typename Stream>
+        inline void pack(Stream &s, const golos::chain::buffer_type &v) {
+            pack(s, unsigned_int((uint32_t)v.size()));
+            if (v.size()) {
+                s.write(v.data(), v.size());
+            }
+        }
+
+        template<typename Stream>
+        inline void unpack(Stream &s, golos::chain::buffer_type &v, uint32_t depth = 0) {
+            unsigned_int size;
+            unpack(s, size, depth);
+            v.resize(size.value);
+            if (size.value) {
+                s.read(v.data(), size.value);
+            }
+        }
+
+        template<typename Stream, typename T>
+        inline void pack(Stream &s, const boost::interprocess::vector<T, allocator<T>> &v) {
+            pack(s, unsigned_int((uint32_t)v.size()));
+            for (const auto &item: v) {
+                pack(s, item);
+            }
+        }
+
+        template<typename Stream, typename T>
+        inline void unpack(Stream &s, boost::interprocess::vector<T, allocator<T>> &v, uint32_t depth = 0) {
+            unsigned_int size;
+            unpack(s, size, depth);
+            v.clear();
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                unpack(s, item, depth);
+                v.push_back(std::move(item));
+            }
+        }
+
+        template<typename Stream, typename T>
+        inline void pack(Stream &s, const boost::interprocess::deque<T, allocator<T>> &v) {
+            pack(s, unsigned_int((uint32_t)v.size()));
+            for (const auto &item: v) {
+                pack(s, item);
+            }
+        }
+
+        template<typename Stream, typename T>
+        inline void unpack(Stream &s, boost::interprocess::deque<T, allocator<T>> &v, uint32_t depth = 0) {
+            unsigned_int size;
+            unpack(s, size, depth);
+            v.clear();
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                unpack(s, item, depth);
+                v.push_back(std::move(item));
+            }
+        }
+
+        template<typename Stream, typename T, typename Compare>
+        inline void pack(Stream &s, const boost::interprocess::flat_set<T, Compare, allocator<T>> &v) {
+            pack(s, unsigned_int((uint32_t)v.size()));
+            for (const auto &item: v) {
+                pack(s, item);
+            }
+        }
+
+        template<typename Stream, typename T, typename Compare>
+        inline void unpack(Stream &s, boost::interprocess::flat_set<T, Compare, allocator<T>> &v, uint32_t depth = 0) {
+            unsigned_int size;
+            unpack(s, size, depth);
+            v.clear();
+            for (uint32_t i = 0; i < size.value; ++i) {
+                T item;
+                unpack(s, item, depth);
+                v.insert(v.end(), std::move(item));
+            }
+        }
     }
 }
 
@@ -15,6 +15,8 @@ namespace golos {
          * The purpose of this object is to enable the detection of duplicate transactions. When a transaction is included
          * in a block a transaction_object is added. At the end of block processing all transaction_objects that have
          * expired can be removed from the index.
+         *
+         * Only the id and the expiration are kept, bodies of recent transactions are in recent_transaction_cache.
          */
         class transaction_object
                 : public object<transaction_object_type, transaction_object> {
@@ -22,14 +24,12 @@ namespace golos {
 
         public:
             template<typename Constructor, typename Allocator>
-            transaction_object(Constructor &&c, allocator <Allocator> a)
-                    : packed_trx(a) {
+            transaction_object(Constructor &&c, allocator <Allocator> a) {
                 c(*this);
             }
 
             id_type id;
 
-            bip::vector<char, allocator<char>> packed_trx;
             transaction_id_type trx_id;
             time_point_sec expiration;
         };
@@ -51,5 +51,5 @@ namespace golos {
     }
 } // golos::chain
 
-FC_REFLECT((golos::chain::transaction_object), (id)(packed_trx)(trx_id)(expiration))
+FC_REFLECT((golos::chain::transaction_object), (id)(trx_id)(expiration))
 CHAINBASE_SET_INDEX_TYPE(golos::chain::transaction_object, golos::chain::transaction_index)
@@ -0,0 +1,152 @@
+#include <golos/chain/operation_batch_worker.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <chrono>
+#include <limits>
+
+namespace golos { namespace chain {
+
+    namespace {
+        /// Delay between attempts to take the read lock, while it is held by a writer
+        const std::chrono::milliseconds stall_delay(100);
+    }
+
+    operation_batch_worker::operation_batch_worker(database& db, std::string name, handler_type handler)
+            : _db(db),
+              _name(std::move(name)),
+              _handler(std::move(handler)) {
+    }
+
+    operation_batch_worker::~operation_batch_worker() {
+        stop();
+    }
+
+    void operation_batch_worker::start(uint32_t max_lag) {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        FC_ASSERT(!_thread.joinable(), "Worker ${name} is already started", ("name", _name));
+
+        _max_lag = max_lag;
+        _is_stopped = false;
+        if (_max_lag > 0) {
+            _thread = std::thread([this]{ work_loop(); });
+        }
+    }
+
+    void operation_batch_worker::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            _is_stopped = true;
+            _max_lag = 0;
+        }
+        _cv.notify_all();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+
+        // batches, which were pushed while the worker was stopping
+        process_queue(std::numeric_limits<std::size_t>::max());
+    }
+
+    void operation_batch_worker::push(operation_batch_ptr batch) {
+        std::unique_lock<std::mutex> lock(_queue_mutex);
+        _queue.push_back(std::move(batch));
+
+        if (_queue.size() > _max_lag) {
+            lock.unlock();
+            if (_max_lag > 0) {
+                ++_sync_drains;
+            }
+            // the applying thread holds the write lock, so the worker can't process batches at this moment
+            process_queue(std::numeric_limits<std::size_t>::max());
+            return;
+        }
+
+        lock.unlock();
+        _cv.notify_one();
+    }
+
+    void operation_batch_worker::work_loop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_queue_mutex);
+                _cv.wait(lock, [&]{ return _is_stopped || !_queue.empty(); });
+                // stop() processes the rest of the queue by itself
+                if (_is_stopped) {
+                    return;
+                }
+            }
+
+            // the batch stays in the queue until the lock is taken, so the applying thread
+            //   can process it by itself if the worker waits for the lock too long
+            try {
+                _db.with_weak_read_lock([&]() {
+                    process_queue(1);
+                });
+                if (_is_stalled) {
+                    _is_stalled = false;
+                    ilog("Worker ${name} resumed", ("name", _name));
+                }
+                continue;
+            } catch (const fc::exception& e) {
+                log_stall(e.to_detail_string());
+            } catch (const std::exception& e) {
+                log_stall(e.what());
+            }
+
+            // the lock is held by a long writer (e.g. replay), retrying at once only loads the lock
+            std::unique_lock<std::mutex> lock(_queue_mutex);
+            _cv.wait_for(lock, stall_delay, [&]{ return _is_stopped; });
+        }
+    }
+
+    void operation_batch_worker::log_stall(const std::string& error) {
+        if (!_is_stalled) {
+            _is_stalled = true;
+            wlog("Worker ${name} can't take read lock, it retries until the lock is free: ${e}",
+                ("name", _name)("e", error));
+        }
+    }
+
+    void operation_batch_worker::process_queue(std::size_t max_batches) {
+        std::lock_guard<std::mutex> process_lock(_process_mutex);
+
+        for (std::size_t i = 0; i < max_batches; ++i) {
+            operation_batch_ptr batch;
+            {
+                std::lock_guard<std::mutex> lock(_queue_mutex);
+                if (_queue.empty()) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+
+            try {
+                _handler(*batch);
+            } catch (const fc::exception& e) {
+                elog("Worker ${name} failed to process block ${block}: ${e}",
+                    ("name", _name)("block", batch->block->block_num())("e", e.to_detail_string()));
+            } catch (const std::exception& e) {
+                elog("Worker ${name} failed to process block ${block}: ${e}",
+                    ("name", _name)("block", batch->block->block_num())("e", e.what()));
+            }
+            ++_processed_batches;
+        }
+    }
+
+    uint32_t operation_batch_worker::queue_size() const {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        return _queue.size();
+    }
+
+    uint64_t operation_batch_worker::processed_batches() const {
+        return _processed_batches;
+    }
+
+    uint64_t operation_batch_worker::sync_drains() const {
+        return _sync_drains;
+    }
+
+} } // namespace golos::chain
@@ -0,0 +1,197 @@
+#include <golos/chain/priority_lock.hpp>
+#include <golos/chain/database_exceptions.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace golos { namespace chain {
+
+    namespace {
+        /// Gates, which are held by the current thread
+        thread_local std::vector<const priority_lock*> held_locks;
+
+        template <typename Predicate>
+        bool wait_for(
+            std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+            const fc::microseconds& max_wait, Predicate&& predicate
+        ) {
+            if (max_wait == fc::microseconds::maximum()) {
+                cv.wait(lock, predicate);
+                return true;
+            }
+            return cv.wait_for(lock, std::chrono::microseconds(max_wait.count()), predicate);
+        }
+    }
+
+    priority_lock::priority_lock()
+            : _stats(static_cast<uint32_t>(lock_source::count)) {
+        clear_stats();
+    }
+
+    priority_lock::guard::guard(priority_lock& lock, lock_source source, const fc::microseconds& max_wait)
+            : _lock(lock),
+              _source(source),
+              _is_nested(std::find(held_locks.begin(), held_locks.end(), &lock) != held_locks.end()),
+              _start(fc::time_point::now()) {
+        if (!_is_nested && _lock.enabled()) {
+            try {
+                if (is_read(_source)) {
+                    _lock.acquire_read(_source, max_wait);
+                } else {
+                    _lock.acquire_write(_source, max_wait);
+                }
+            } catch (const lock_timeout_exception&) {
+                _lock.add_timeout(_source);
+                throw;
+            }
+            _is_gated = true;
+        }
+        held_locks.push_back(&_lock);
+    }
+
+    priority_lock::guard::~guard() {
+        held_locks.erase(std::find(held_locks.rbegin(), held_locks.rend(), &_lock).base() - 1);
+        if (_is_nested) {
+            return;
+        }
+
+        if (_is_locked) {
+            auto hold = fc::time_point::now() - _locked;
+            _lock.add_hold(_source, hold);
+            if (is_read(_source)) {
+                read_lock_timer::add(hold);
+            }
+        } else {
+            // the chainbase lock wasn't taken in time
+            _lock.add_timeout(_source);
+        }
+
+        if (_is_gated) {
+            if (is_read(_source)) {
+                _lock.release_read();
+            } else {
+                _lock.release_write();
+            }
+        }
+    }
+
+    void priority_lock::guard::locked() {
+        if (_is_nested || _is_locked) {
+            return;
+        }
+        _is_locked = true;
+        _locked = fc::time_point::now();
+        _lock.add_wait(_source, _locked - _start);
+    }
+
+    void priority_lock::acquire_read(lock_source source, const fc::microseconds& max_wait) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto no_writers = [&]() {
+            return !_writer && !_waiting_block_writers && !_waiting_writers;
+        };
+
+        if (no_writers()) {
+            ++_readers;
+            return;
+        }
+
+        auto phase = _read_phase;
+        ++_waiting_readers;
+        add_waiting(source, 1);
+        auto is_passed = wait_for(_readers_cv, lock, max_wait, [&]() {
+            return phase != _read_phase || no_writers();
+        });
+        add_waiting(source, -1);
+
+        if (phase != _read_phase) {
+            // the releasing writer has already counted this reader
+            return;
+        }
+
+        --_waiting_readers;
+        if (!is_passed) {
+            FC_THROW_EXCEPTION(lock_timeout_exception, "Unable to acquire READ lock");
+        }
+        ++_readers;
+    }
+
+    void priority_lock::release_read() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_readers;
+        if (!_readers) {
+            _writers_cv.notify_all();
+        }
+    }
+
+    void priority_lock::acquire_write(lock_source source, const fc::microseconds& max_wait) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        bool is_block = source == lock_source::block_write;
+        auto& waiting = is_block ? _waiting_block_writers : _waiting_writers;
+
+        ++waiting;
+        add_waiting(source, 1);
+        auto is_passed = wait_for(_writers_cv, lock, max_wait, [&]() {
+            return !_writer && !_readers && (is_block || !_waiting_block_writers);
+        });
+        add_waiting(source, -1);
+        --waiting;
+
+        if (!is_passed) {
+            // readers can wait only for this writer
+            _readers_cv.notify_all();
+            FC_THROW_EXCEPTION(lock_timeout_exception, "Unable to acquire WRITE lock");
+        }
+        _writer = true;
+    }
+
+    void priority_lock::release_write() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _writer = false;
+
+        if (!_waiting_block_writers && _waiting_readers) {
+            _readers += _waiting_readers;
+            _waiting_readers = 0;
+            ++_read_phase;
+            _readers_cv.notify_all();
+        } else {
+            _writers_cv.notify_all();
+        }
+    }
+
+    void priority_lock::add_wait(lock_source source, const fc::microseconds& duration) {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _stats[static_cast<uint32_t>(source)].wait.add(duration);
+    }
+
+    void priority_lock::add_hold(lock_source source, const fc::microseconds& duration) {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _stats[static_cast<uint32_t>(source)].hold.add(duration);
+    }
+
+    void priority_lock::add_timeout(lock_source source) {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        ++_stats[static_cast<uint32_t>(source)].timeouts;
+    }
+
+    void priority_lock::add_waiting(lock_source source, int32_t delta) {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _stats[static_cast<uint32_t>(source)].waiting += delta;
+    }
+
+    std::vector<lock_stats_item> priority_lock::get_stats() const {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        return _stats;
+    }
+
+    void priority_lock::clear_stats() {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        for (uint32_t i = 0; i < _stats.size(); ++i) {
+            // the waiting acquisitions are current state, not history
+            auto waiting = _stats[i].waiting;
+            _stats[i] = lock_stats_item();
+            _stats[i].waiting = waiting;
+            _stats[i].source = fc::reflector<lock_source>::to_string(static_cast<lock_source>(i));
+        }
+    }
+
+} } // golos::chain
@@ -0,0 +1,72 @@
+#include <golos/chain/recent_transaction_cache.hpp>
+
+namespace golos { namespace chain {
+
+    void recent_transaction_cache::set_max_size(uint32_t value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _max_size = value;
+
+        auto& idx = _items.get<by_expiration>();
+        while (_items.size() > _max_size) {
+            idx.erase(idx.begin());
+        }
+    }
+
+    void recent_transaction_cache::add(const transaction_id_type& trx_id, const signed_transaction& trx) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_max_size) {
+            return;
+        }
+
+        // the same transaction is applied on push and in the block
+        auto& idx = _items.get<by_trx_id>();
+        if (idx.find(trx_id) != idx.end()) {
+            return;
+        }
+
+        if (_items.size() >= _max_size) {
+            // the first to expire is the first to be dropped
+            auto& exp_idx = _items.get<by_expiration>();
+            exp_idx.erase(exp_idx.begin());
+        }
+
+        _items.insert(item{trx_id, trx.expiration, trx});
+    }
+
+    bool recent_transaction_cache::find(const transaction_id_type& trx_id, signed_transaction& trx) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& idx = _items.get<by_trx_id>();
+        auto itr = idx.find(trx_id);
+        if (itr == idx.end()) {
+            ++_misses;
+            return false;
+        }
+        trx = itr->trx;
+        ++_hits;
+        return true;
+    }
+
+    void recent_transaction_cache::remove_expired(fc::time_point_sec now) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& idx = _items.get<by_expiration>();
+        while (!idx.empty() && idx.begin()->expiration < now) {
+            idx.erase(idx.begin());
+        }
+    }
+
+    void recent_transaction_cache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _items.clear();
+    }
+
+    recent_transaction_cache_stats recent_transaction_cache::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        recent_transaction_cache_stats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        stats.size = _items.size();
+        stats.max_size = _max_size;
+        return stats;
+    }
+
+} } // golos::chain
@@ -0,0 +1,134 @@
+#include <golos/chain/shared_memory_flusher.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace golos { namespace chain {
+
+    shared_memory_flusher::~shared_memory_flusher() {
+        stop();
+    }
+
+    bool shared_memory_flusher::mark(uint32_t block_num, char* base, std::size_t size) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stats.flushing_block) {
+            return false;
+        }
+
+        _base = base;
+        _size = size;
+        _offset = 0;
+        _start = fc::time_point::now();
+        _stats.flushing_block = block_num;
+
+        if (!_thread.joinable()) {
+            _is_stopped = false;
+            _thread = std::thread([this]{ work_loop(); });
+        }
+        _cv.notify_all();
+        return true;
+    }
+
+    void shared_memory_flusher::cancel() {
+        std::lock_guard<std::mutex> sync_lock(_sync_mutex);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stats.flushing_block) {
+            wlog("Flush of shared memory at block ${n} is canceled", ("n", _stats.flushing_block));
+        }
+        _stats.flushing_block = 0;
+        _base = nullptr;
+        _size = 0;
+    }
+
+    void shared_memory_flusher::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _is_stopped = true;
+            _stats.flushing_block = 0;
+        }
+        _cv.notify_all();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void shared_memory_flusher::add_sync_flush(uint32_t block_num, std::size_t size, const fc::microseconds& duration) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_stats.flushes;
+        _stats.synced_bytes += size;
+        _stats.duration.add(duration);
+        _stats.last_flushed_block = block_num;
+    }
+
+    shared_memory_flush_stats shared_memory_flusher::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+    void shared_memory_flusher::work_loop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [&]{ return _is_stopped || _stats.flushing_block; });
+                if (_is_stopped) {
+                    return;
+                }
+            }
+
+            std::size_t synced = 0;
+            auto sync_start = fc::time_point::now();
+            {
+                std::lock_guard<std::mutex> sync_lock(_sync_mutex);
+
+                char* addr;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (!_stats.flushing_block) {
+                        continue; // canceled
+                    }
+                    addr = _base + _offset;
+                    synced = std::min(chunk_size, _size - _offset);
+                }
+
+                bool is_failed = synced && msync(addr, synced, MS_SYNC) != 0;
+                int error = errno;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (is_failed) {
+                    // the file on disk isn't flushed, so the flush isn't counted
+                    elog("Can't flush shared memory at block ${n}: ${e}",
+                        ("n", _stats.flushing_block)("e", std::strerror(error)));
+                    ++_stats.errors;
+                    _stats.flushing_block = 0;
+                    continue;
+                }
+                _offset += synced;
+                _stats.synced_bytes += synced;
+                if (_offset >= _size) {
+                    ++_stats.flushes;
+                    _stats.duration.add(fc::time_point::now() - _start);
+                    _stats.last_flushed_block = _stats.flushing_block;
+                    _stats.flushing_block = 0;
+                }
+            }
+
+            auto max_bytes_per_sec = _max_bytes_per_sec.load();
+            if (max_bytes_per_sec && synced) {
+                auto elapsed = (fc::time_point::now() - sync_start).count();
+                auto pause = int64_t(synced * 1000000 / max_bytes_per_sec) - elapsed;
+                if (pause > 0) {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.wait_for(lock, std::chrono::microseconds(pause), [&]{ return _is_stopped; });
+                }
+            }
+        }
+    }
+
+} } // golos::chain
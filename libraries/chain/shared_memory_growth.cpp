@@ -0,0 +1,239 @@
+#include <golos/chain/shared_memory_growth.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+namespace golos { namespace chain {
+
+    shared_memory_growth::~shared_memory_growth() {
+        stop();
+    }
+
+    void shared_memory_growth::set_file(std::string file) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _file = std::move(file);
+        _is_reserve_pending = false;
+        _is_reserved = false;
+        _last_block_num = 0;
+        _resize_block_num = 0;
+    }
+
+    void shared_memory_growth::add_block(uint32_t block_num, uint64_t used_memory) {
+        if (_last_block_num != 0 && block_num > _last_block_num) {
+            double delta = (double(used_memory) - double(_last_used_memory)) / (block_num - _last_block_num);
+            _rate += (delta - _rate) * rate_weight;
+        }
+        // on pop of blocks only the base is moved
+        _last_block_num = block_num;
+        _last_used_memory = used_memory;
+    }
+
+    double shared_memory_growth::bytes_per_block() const {
+        return std::max(_rate, 0.0);
+    }
+
+    uint32_t shared_memory_growth::blocks_left(uint64_t free_memory, uint64_t min_free) const {
+        if (free_memory <= min_free) {
+            return 0;
+        }
+        auto rate = bytes_per_block();
+        if (rate < 1) {
+            return std::numeric_limits<uint32_t>::max();
+        }
+        return uint32_t(std::min<double>((free_memory - min_free) / rate, std::numeric_limits<uint32_t>::max()));
+    }
+
+    bool shared_memory_growth::reserve(uint64_t file_size, uint64_t inc_size) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_file.empty() || !inc_size) {
+            return true;
+        }
+        if (_reserve_offset == file_size && _reserve_size == inc_size) {
+            return _is_reserved;
+        }
+
+        ilog("Reserving ${mem}M of disk space for the shared memory, the predicted rate is ${rate} bytes/block",
+            ("mem", inc_size / (1024 * 1024))("rate", uint64_t(bytes_per_block())));
+
+        _reserve_offset = file_size;
+        _reserve_size = inc_size;
+        _is_reserve_pending = true;
+        _is_reserved = false;
+        start_thread();
+        _cv.notify_all();
+        return false;
+    }
+
+    void shared_memory_growth::cancel() {
+        std::lock_guard<std::mutex> populate_lock(_populate_mutex);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _populate_base = nullptr;
+        _populate_offset = 0;
+        _populate_end = 0;
+    }
+
+    void shared_memory_growth::resized(uint32_t block_num, uint64_t used_memory, char* tail, std::size_t tail_size) {
+        if (_resize_block_num != 0 && block_num > _resize_block_num) {
+            auto blocks = block_num - _resize_block_num;
+            auto used = int64_t(used_memory) - int64_t(_resize_used_memory);
+            ilog(
+                "Since the resize on block ${prev}, ${used} bytes were allocated in ${blocks} blocks "
+                "(${actual} bytes/block), the predicted rate was ${predicted} bytes/block",
+                ("prev", _resize_block_num)("used", used)("blocks", blocks)
+                ("actual", used / int64_t(blocks))("predicted", uint64_t(std::max(_resize_rate, 0.0))));
+        }
+        _resize_block_num = block_num;
+        _resize_used_memory = used_memory;
+        _resize_rate = _rate;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _is_reserve_pending = false;
+        if (!tail_size) {
+            return;
+        }
+        // madvise() needs the address aligned to the page
+        const auto page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+        const auto start = uintptr_t(tail) / page_size * page_size;
+        _populate_base = reinterpret_cast<char*>(start);
+        _populate_offset = 0;
+        _populate_end = uintptr_t(tail) + tail_size - start;
+        _populate_size = _populate_end;
+        _populate_start = fc::time_point::now();
+        start_thread();
+        _cv.notify_all();
+    }
+
+    bool shared_memory_growth::is_populating() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _populate_base != nullptr;
+    }
+
+    uint64_t shared_memory_growth::populated_bytes() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _populated_bytes;
+    }
+
+    uint64_t shared_memory_growth::populate_errors() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _populate_errors;
+    }
+
+    void shared_memory_growth::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _is_stopped = true;
+            _is_reserve_pending = false;
+            _populate_base = nullptr;
+        }
+        _cv.notify_all();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void shared_memory_growth::start_thread() {
+        if (!_thread.joinable()) {
+            _is_stopped = false;
+            _thread = std::thread([this]{ work_loop(); });
+        }
+    }
+
+    void shared_memory_growth::reserve_space(uint64_t offset, uint64_t size) {
+#ifdef FALLOC_FL_KEEP_SIZE
+        int fd = ::open(_file.c_str(), O_RDWR);
+        if (fd < 0) {
+            wlog("Can't open ${f} to reserve disk space: ${e}", ("f", _file)("e", std::strerror(errno)));
+            return;
+        }
+        auto start = fc::time_point::now();
+        if (::fallocate(fd, FALLOC_FL_KEEP_SIZE, off_t(offset), off_t(size)) != 0) {
+            wlog("Can't reserve disk space for the shared memory: ${e}", ("e", std::strerror(errno)));
+        } else {
+            ilog("Reserved ${mem}M of disk space for the shared memory in ${t} sec",
+                ("mem", size / (1024 * 1024))("t", double((fc::time_point::now() - start).count()) / 1000000.0));
+        }
+        ::close(fd);
+#else
+        (void)offset;
+        (void)size;
+#endif
+    }
+
+    void shared_memory_growth::work_loop() {
+        while (true) {
+            uint64_t reserve_offset = 0;
+            uint64_t reserve_size = 0;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [&]{ return _is_stopped || _is_reserve_pending || _populate_base; });
+                if (_is_stopped) {
+                    return;
+                }
+                if (_is_reserve_pending) {
+                    reserve_offset = _reserve_offset;
+                    reserve_size = _reserve_size;
+                }
+            }
+
+            if (reserve_size) {
+                // only blocks of the file are allocated, the mapping isn't touched
+                reserve_space(reserve_offset, reserve_size);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_is_reserve_pending && _reserve_offset == reserve_offset && _reserve_size == reserve_size) {
+                    _is_reserve_pending = false;
+                    _is_reserved = true;
+                }
+                continue;
+            }
+
+            std::lock_guard<std::mutex> populate_lock(_populate_mutex);
+
+            char* addr;
+            std::size_t size;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_populate_base) {
+                    continue; // canceled
+                }
+                addr = _populate_base + _populate_offset;
+                size = std::min(chunk_size, _populate_end - _populate_offset);
+            }
+
+            int res = -1;
+#ifdef MADV_POPULATE_WRITE
+            // maps pages as writable without changing their contents
+            res = madvise(addr, size, MADV_POPULATE_WRITE);
+#endif
+            if (res != 0) {
+                res = madvise(addr, size, MADV_WILLNEED);
+            }
+            int error = errno;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (res != 0) {
+                wlog("Can't prefault the new shared memory: ${e}", ("e", std::strerror(error)));
+                ++_populate_errors;
+            } else {
+                _populated_bytes += size;
+            }
+            _populate_offset += size;
+            if (_populate_offset >= _populate_end) {
+                ilog("Prefaulted ${mem}M of the new shared memory in ${t} sec",
+                    ("mem", _populate_size / (1024 * 1024))
+                    ("t", double((fc::time_point::now() - _populate_start).count()) / 1000000.0));
+                _populate_base = nullptr;
+            }
+        }
+    }
+
+} } // golos::chain
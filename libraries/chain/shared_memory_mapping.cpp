@@ -0,0 +1,128 @@
+#include <golos/chain/shared_memory_mapping.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <sys/mman.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    namespace {
+        constexpr long hugetlbfs_magic = 0x958458f6;
+
+        const std::pair<const char*, uint32_t> advice_names[] = {
+            {"normal", shared_memory_advice_normal},
+            {"random", shared_memory_advice_random},
+            {"willneed", shared_memory_advice_willneed},
+            {"hugepage", shared_memory_advice_hugepage},
+        };
+
+        bool advise(char* base, std::size_t size, int advice, const char* name) {
+            if (madvise(base, size, advice) != 0) {
+                wlog("Can't advise ${a} for shared memory: ${e}", ("a", name)("e", std::strerror(errno)));
+                return false;
+            }
+            return true;
+        }
+    } // namespace
+
+    uint32_t parse_shared_memory_advice(const std::vector<std::string>& names) {
+        uint32_t result = shared_memory_advice_normal;
+        for (const auto& name: names) {
+            auto itr = std::find_if(std::begin(advice_names), std::end(advice_names), [&](const auto& item) {
+                return name == item.first;
+            });
+            FC_ASSERT(itr != std::end(advice_names), "Unknown advice for shared memory", ("advice", name));
+            result |= itr->second;
+        }
+        return result;
+    }
+
+    std::string shared_memory_advice_to_string(uint32_t advice) {
+        std::string result;
+        for (const auto& item: advice_names) {
+            if (item.second & advice) {
+                result += result.empty() ? "" : ",";
+                result += item.first;
+            }
+        }
+        return result.empty() ? "normal" : result;
+    }
+
+    std::pair<char*, std::size_t> page_aligned_range(char* addr, std::size_t size) {
+        const auto page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+        auto start = uintptr_t(addr) / page_size * page_size;
+        auto end = (uintptr_t(addr) + size + page_size - 1) / page_size * page_size;
+        return {reinterpret_cast<char*>(start), std::size_t(end - start)};
+    }
+
+    bool advise_shared_memory(char* base, std::size_t size, uint32_t advice) {
+        bool result = true;
+        if (advice & shared_memory_advice_random) {
+            result &= advise(base, size, MADV_RANDOM, "random");
+        }
+        if (advice & shared_memory_advice_willneed) {
+            result &= advise(base, size, MADV_WILLNEED, "willneed");
+        }
+        if (advice & shared_memory_advice_hugepage) {
+#ifdef MADV_HUGEPAGE
+            result &= advise(base, size, MADV_HUGEPAGE, "hugepage");
+#else
+            wlog("Transparent huge pages aren't supported on this platform");
+            result = false;
+#endif
+        }
+        return result;
+    }
+
+    void prefault_shared_memory(const char* base, std::size_t size, uint32_t threads) {
+        const std::size_t page_size = std::size_t(sysconf(_SC_PAGESIZE));
+        const std::size_t pages = (size + page_size - 1) / page_size;
+        threads = std::max<uint32_t>(std::min<std::size_t>(threads, pages), 1);
+
+        auto start = fc::time_point::now();
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (uint32_t i = 0; i < threads; ++i) {
+            workers.emplace_back([=]() {
+                // contiguous ranges, so the kernel can read ahead
+                auto first = pages * i / threads;
+                auto last = pages * (i + 1) / threads;
+                auto addr = const_cast<char*>(base) + first * page_size;
+                auto range = std::min(last * page_size, size) - first * page_size;
+#ifdef MADV_POPULATE_READ
+                if (madvise(addr, range, MADV_POPULATE_READ) == 0) {
+                    return;
+                }
+#endif
+                volatile char sum = 0;
+                for (std::size_t offset = 0; offset < range; offset += page_size) {
+                    sum += addr[offset];
+                }
+            });
+        }
+        for (auto& worker: workers) {
+            worker.join();
+        }
+
+        ilog("Prefaulted ${mem}M of shared memory in ${t} sec by ${n} threads",
+            ("mem", size / (1024 * 1024))
+            ("t", double((fc::time_point::now() - start).count()) / 1000000.0)("n", threads));
+    }
+
+    uint64_t hugetlbfs_page_size(const fc::path& dir) {
+        struct statfs info;
+        if (statfs(dir.string().c_str(), &info) != 0 || long(info.f_type) != hugetlbfs_magic) {
+            return 0;
+        }
+        return uint64_t(info.f_bsize);
+    }
+
+} } // golos::chain
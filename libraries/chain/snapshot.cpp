@@ -0,0 +1,279 @@
+#include <golos/chain/database.hpp>
+#include <golos/chain/snapshot.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace chain {
+
+    namespace {
+
+        const char snapshot_magic[8] = {'G', 'O', 'L', 'O', 'S', 'S', 'N', 'P'};
+        const uint32_t snapshot_version = 2;
+
+        template<typename T>
+        void write_packed(std::ostream& out, const T& v) {
+            auto data = fc::raw::pack(v);
+            uint32_t size = data.size();
+            out.write((const char*)&size, sizeof(size));
+            out.write(data.data(), data.size());
+        }
+
+        template<typename T>
+        T read_packed(std::istream& in) {
+            uint32_t size = 0;
+            in.read((char*)&size, sizeof(size));
+            std::vector<char> data(size);
+            in.read(data.data(), size);
+            FC_ASSERT(in, "Unexpected end of snapshot");
+            return fc::raw::unpack<T>(data);
+        }
+
+    } // namespace
+
+    snapshot_section_writer::snapshot_section_writer(const fc::path& file)
+            : _out(file.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc) {
+        FC_ASSERT(_out, "Can't open file ${file}", ("file", file));
+    }
+
+    void snapshot_section_writer::write_data(const char* data, uint32_t size) {
+        _out.write((const char*)&size, sizeof(size));
+        _out.write(data, size);
+        _encoder.write((const char*)&size, sizeof(size));
+        _encoder.write(data, size);
+        _size += sizeof(size) + size;
+        ++_objects;
+    }
+
+    void snapshot_section_writer::finish(snapshot_section_header& header) {
+        _out.flush();
+        FC_ASSERT(_out, "Can't write snapshot section ${name}", ("name", header.name));
+        _out.close();
+
+        header.objects = _objects;
+        header.size = _size;
+        header.checksum = _encoder.result();
+    }
+
+    snapshot_section_reader::snapshot_section_reader(std::istream& in, const snapshot_section_header& header)
+            : _in(in),
+              _header(header) {
+    }
+
+    bool snapshot_section_reader::next() {
+        if (_objects == _header.objects) {
+            return false;
+        }
+
+        uint32_t size = 0;
+        _in.read((char*)&size, sizeof(size));
+        FC_ASSERT(_in && _size + sizeof(size) + size <= _header.size,
+            "Broken object in snapshot section ${name}", ("name", _header.name)("object", _objects));
+
+        _buffer.resize(size);
+        _in.read(_buffer.data(), size);
+        FC_ASSERT(_in, "Unexpected end of snapshot section ${name}", ("name", _header.name));
+
+        _encoder.write((const char*)&size, sizeof(size));
+        _encoder.write(_buffer.data(), size);
+        _size += sizeof(size) + size;
+        ++_objects;
+        return true;
+    }
+
+    void snapshot_section_reader::finish() {
+        FC_ASSERT(_objects == _header.objects && _size == _header.size,
+            "Snapshot section ${name} is not completely read", ("name", _header.name));
+        FC_ASSERT(_encoder.result() == _header.checksum,
+            "Checksum of snapshot section ${name} doesn't match", ("name", _header.name));
+    }
+
+    void database::add_snapshot_section(std::unique_ptr<snapshot_section> section) {
+        _snapshot_sections.push_back(std::move(section));
+    }
+
+    void database::open_from_snapshot(
+        const fc::path& data_dir, const fc::path& shared_mem_dir, const fc::path& snapshot,
+        uint64_t shared_file_size, uint32_t chainbase_flags
+    ) {
+        FC_ASSERT(fc::exists(snapshot), "Snapshot ${file} doesn't exist", ("file", snapshot));
+
+        wipe(data_dir, shared_mem_dir, false);
+
+        _snapshot_to_import = snapshot;
+        try {
+            open(data_dir, shared_mem_dir, STEEMIT_INIT_SUPPLY, shared_file_size, chainbase_flags);
+        } catch (...) {
+            _snapshot_to_import = fc::path();
+            throw;
+        }
+        _snapshot_to_import = fc::path();
+    }
+
+    void database::export_snapshot(const fc::path& snapshot, bool include_plugins, uint32_t threads) {
+        try {
+            auto start = fc::time_point::now();
+            ilog("Writing snapshot to ${file}...", ("file", snapshot));
+
+            with_weak_read_lock([&]() {
+                auto head_block = _block_log.read_block_by_num(head_block_num());
+                FC_ASSERT(head_block.valid() && head_block->id() == head_block_id(),
+                    "Snapshot can be written only at block from block log",
+                    ("head_block_num", head_block_num()));
+
+                snapshot_header header;
+                header.version = snapshot_version;
+                header.chain_id = get_chain_id();
+                header.head_block_num = head_block_num();
+                header.head_block_id = head_block_id();
+                header.head_block_time = head_block_time();
+
+                std::vector<const snapshot_section*> sections;
+                for (const auto& section: _snapshot_sections) {
+                    if (section->is_core() || include_plugins) {
+                        sections.push_back(section.get());
+                    }
+                }
+
+                std::vector<snapshot_section_header> section_headers(sections.size());
+                std::vector<fc::path> section_files(sections.size());
+                for (std::size_t i = 0; i < sections.size(); ++i) {
+                    section_headers[i].name = sections[i]->name();
+                    section_headers[i].is_core = sections[i]->is_core();
+                    section_files[i] = snapshot.generic_string() + "." + std::to_string(i);
+                }
+
+                // sections are taken by threads one by one, so large indexes don't wait for each other
+                std::atomic<std::size_t> next_section{0};
+                std::exception_ptr error;
+                std::mutex error_mutex;
+
+                auto write_sections = [&]() {
+                    try {
+                        for (auto i = next_section++; i < sections.size(); i = next_section++) {
+                            snapshot_section_writer out(section_files[i]);
+                            sections[i]->write(out, section_headers[i]);
+                            out.finish(section_headers[i]);
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        next_section = sections.size();
+                    }
+                };
+
+                std::vector<std::thread> workers;
+                for (uint32_t i = 1; i < threads && i < sections.size(); ++i) {
+                    workers.emplace_back(write_sections);
+                }
+                write_sections();
+                for (auto& w: workers) {
+                    w.join();
+                }
+
+                auto remove_section_files = [&]() {
+                    for (const auto& file: section_files) {
+                        fc::remove_all(file);
+                    }
+                };
+
+                if (error) {
+                    remove_section_files();
+                    std::rethrow_exception(error);
+                }
+
+                std::ofstream out(snapshot.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+                out.write(snapshot_magic, sizeof(snapshot_magic));
+                write_packed(out, header);
+                write_packed(out, section_headers);
+
+                for (const auto& file: section_files) {
+                    std::ifstream in(file.generic_string(), std::ios::in | std::ios::binary);
+                    if (fc::file_size(file)) {
+                        out << in.rdbuf();
+                    }
+                }
+                out.flush();
+                remove_section_files();
+                FC_ASSERT(out, "Can't write snapshot ${file}", ("file", snapshot));
+
+                uint64_t objects = 0;
+                for (const auto& h: section_headers) {
+                    objects += h.objects;
+                }
+                ilog("Snapshot at block ${n} has ${o} objects in ${s} sections",
+                    ("n", header.head_block_num)("o", objects)("s", section_headers.size()));
+            });
+
+            auto end = fc::time_point::now();
+            ilog("Done writing snapshot, elapsed time ${t} sec", ("t", double((end - start).count()) / 1000000.0));
+        }
+        FC_CAPTURE_AND_RETHROW((snapshot)(include_plugins)(threads))
+    }
+
+    void database::import_snapshot(const fc::path& snapshot) {
+        try {
+            auto start = fc::time_point::now();
+            ilog("Loading state from snapshot ${file}...", ("file", snapshot));
+
+            std::ifstream in(snapshot.generic_string(), std::ios::in | std::ios::binary);
+            FC_ASSERT(in, "Can't open snapshot ${file}", ("file", snapshot));
+
+            char magic[sizeof(snapshot_magic)] = {0};
+            in.read(magic, sizeof(magic));
+            FC_ASSERT(in && std::equal(magic, magic + sizeof(magic), snapshot_magic),
+                "File ${file} is not a snapshot", ("file", snapshot));
+
+            auto header = read_packed<snapshot_header>(in);
+            FC_ASSERT(header.version == snapshot_version,
+                "Unsupported version of snapshot", ("version", header.version)("supported", snapshot_version));
+            FC_ASSERT(header.chain_id == get_chain_id(),
+                "Snapshot is made for other chain", ("chain_id", header.chain_id));
+
+            auto section_headers = read_packed<std::vector<snapshot_section_header>>(in);
+
+            std::map<std::string, snapshot_section*> sections;
+            for (const auto& section: _snapshot_sections) {
+                sections[section->name()] = section.get();
+            }
+
+            for (const auto& section_header: section_headers) {
+                auto itr = sections.find(section_header.name);
+                if (itr == sections.end()) {
+                    FC_ASSERT(!section_header.is_core,
+                        "Unknown core section ${name} in snapshot", ("name", section_header.name));
+                    wlog("Skipping section ${name} of disabled plugin", ("name", section_header.name));
+                    in.seekg(section_header.size, std::ios::cur);
+                    continue;
+                }
+
+                snapshot_section_reader reader(in, section_header);
+                itr->second->read(reader, section_header);
+                reader.finish();
+                sections.erase(itr);
+            }
+
+            for (const auto& section: sections) {
+                FC_ASSERT(!section.second->is_core(),
+                    "Snapshot doesn't have core section ${name}", ("name", section.first));
+                wlog("Snapshot doesn't have section ${name}, the state of plugin starts from the empty one",
+                    ("name", section.first));
+            }
+
+            FC_ASSERT(head_block_num() == header.head_block_num && head_block_id() == header.head_block_id,
+                "Loaded state doesn't match snapshot header", ("head_block_num", header.head_block_num));
+            set_revision(head_block_num());
+
+            auto end = fc::time_point::now();
+            ilog("Done loading state at block ${n} from snapshot, elapsed time ${t} sec",
+                ("n", header.head_block_num)("t", double((end - start).count()) / 1000000.0));
+        }
+        FC_CAPTURE_AND_RETHROW((snapshot))
+    }
+
+} } // golos::chain
@@ -79,6 +79,15 @@ namespace golos {
             virtual bool handle_block(const golos::network::block_message &blk_msg, bool sync_mode,
                     std::vector<fc::uint160_t> &contained_transaction_message_ids) = 0;
 
+            /**
+             *  @brief Called when a block is received during sync, before it is passed to handle_block().
+             *
+             *  Blocks are received ahead of their processing, so the delegate can start checks
+             *  which don't depend on the chain state. Must not block the calling thread.
+             */
+            virtual void prevalidate_block(const golos::network::block_message &blk_msg) {
+            }
+
             /**
              *  @brief Called when a new transaction comes in from the network
              *
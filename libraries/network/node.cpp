@@ -391,6 +391,8 @@ namespace golos {
 
                 bool handle_block(const golos::network::block_message &block_message, bool sync_mode, std::vector<fc::uint160_t> &contained_transaction_message_ids) override;
 
+                void prevalidate_block(const golos::network::block_message &block_message) override;
+
                 void handle_transaction(const golos::network::trx_message &transaction_message) override;
 
                 std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t> &blockchain_synopsis,
@@ -3417,6 +3419,7 @@ namespace golos {
                 // add it to the front of _received_sync_items, then process _received_sync_items to try to
                 // pass as many messages as possible to the client.
                 _new_received_sync_items.push_front(block_message_to_process);
+                _delegate->prevalidate_block(block_message_to_process);
                 trigger_process_backlog_of_sync_blocks();
             }
 
@@ -5412,6 +5415,12 @@ namespace golos {
                 INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids);
             }
 
+            void statistics_gathering_node_delegate_wrapper::prevalidate_block(const golos::network::block_message &block_message) {
+                // this function doesn't need to block,
+                ASSERT_TASK_NOT_PREEMPTED();
+                _node_delegate->prevalidate_block(block_message);
+            }
+
             void statistics_gathering_node_delegate_wrapper::handle_transaction(const golos::network::trx_message &transaction_message) {
                 INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
             }
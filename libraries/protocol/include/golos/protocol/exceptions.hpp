@@ -368,6 +368,9 @@ namespace golos {
             wrong_position_marker_was_read,
             append_index_file_at_wrong_position,
             reading_data_beyond_end_of_file,
+            block_not_found_in_block_log,
+            wrong_chunk_was_read,
+            unsupported_block_log_version,
         };
     };
 
@@ -620,4 +623,7 @@ FC_REFLECT_ENUM(golos::database_corrupted::error_types,
         (wrong_position_marker_was_read)
         (append_index_file_at_wrong_position)
         (reading_data_beyond_end_of_file)
+        (block_not_found_in_block_log)
+        (wrong_chunk_was_read)
+        (unsupported_block_log_version)
 );
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <golos/protocol/asset.hpp>
+
+#include <fc/container/flat.hpp>
+#include <fc/io/json.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/safe.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace golos { namespace protocol {
+
+    /**
+     * Reflected types, which are written to JSON member by member without building of fc::variant.
+     * The type should be converted to variant by the reflection only, types with own to_variant()
+     *   can't be marked, because their output differs. Use GOLOS_JSON_DIRECT_SERIALIZATION to mark a type.
+     */
+    template<typename T>
+    struct direct_json_serialization: std::false_type {};
+
+    template<typename T>
+    struct has_direct_json: direct_json_serialization<T> {};
+
+    template<typename T>
+    struct has_direct_json<std::vector<T>>: has_direct_json<T> {};
+
+    template<typename T>
+    struct has_direct_json<fc::flat_set<T>>: has_direct_json<T> {};
+
+    template<typename T>
+    struct has_direct_json<std::set<T>>: has_direct_json<T> {};
+
+    template<typename K, typename V>
+    struct has_direct_json<std::map<K, V>>: has_direct_json<V> {};
+
+    template<typename T>
+    struct has_direct_json<fc::optional<T>>: has_direct_json<T> {};
+
+    template<typename T, typename Enable = void>
+    struct json_value_writer;
+
+    /**
+     * Writes values to JSON straight into the string, the output is the same as of fc::json::to_string(fc::variant(v)).
+     *
+     * Reflected structs marked by GOLOS_JSON_DIRECT_SERIALIZATION, containers, integers, bools and plain strings
+     *   are written directly. Other values (enums, ids, keys, times, static variants...) are converted through
+     *   fc::variant one by one, so the output doesn't depend on their custom to_variant().
+     */
+    class json_writer final {
+    public:
+        explicit json_writer(std::string& out)
+                : _out(out) {
+        }
+
+        template<typename T>
+        void write(const T& value) {
+            json_value_writer<T>::write(*this, value);
+        }
+
+        template<typename T>
+        static std::string to_string(const T& value) {
+            std::string result;
+            json_writer writer(result);
+            writer.write(value);
+            return result;
+        }
+
+        void raw(char c) {
+            _out += c;
+        }
+
+        void raw(const char* s) {
+            _out += s;
+        }
+
+        void raw(const std::string& s) {
+            _out += s;
+        }
+
+        /// fc writes 64-bit integers larger than 32 bits as strings
+        void write_int(int64_t value) {
+            if (value > 0xffffffffll) {
+                _out += '"';
+                _out += std::to_string(value);
+                _out += '"';
+            } else {
+                _out += std::to_string(value);
+            }
+        }
+
+        void write_uint(uint64_t value) {
+            if (value > 0xffffffffull) {
+                _out += '"';
+                _out += std::to_string(value);
+                _out += '"';
+            } else {
+                _out += std::to_string(value);
+            }
+        }
+
+        void write_string(const std::string& value) {
+            for (unsigned char c: value) {
+                if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\') {
+                    // escaping of fc is used for strings, which need it
+                    write_variant(fc::variant(value));
+                    return;
+                }
+            }
+            _out += '"';
+            _out += value;
+            _out += '"';
+        }
+
+        void write_variant(const fc::variant& value) {
+            _out += fc::json::to_string(value);
+        }
+
+        template<typename Container>
+        void write_array(const Container& values) {
+            _out += '[';
+            bool first = true;
+            for (const auto& value: values) {
+                if (!first) {
+                    _out += ',';
+                }
+                first = false;
+                write(value);
+            }
+            _out += ']';
+        }
+
+    private:
+        std::string& _out;
+    };
+
+    /// Any type without the direct writer
+    template<typename T, typename Enable>
+    struct json_value_writer {
+        static void write(json_writer& w, const T& value) {
+            w.write_variant(fc::variant(value));
+        }
+    };
+
+    template<>
+    struct json_value_writer<bool> {
+        static void write(json_writer& w, bool value) {
+            w.raw(value ? "true" : "false");
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<T, typename std::enable_if<
+        std::is_integral<T>::value && std::is_signed<T>::value && !std::is_same<T, char>::value>::type> {
+        static void write(json_writer& w, T value) {
+            w.write_int(value);
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<T, typename std::enable_if<
+        std::is_integral<T>::value && std::is_unsigned<T>::value &&
+        !std::is_same<T, bool>::value && !std::is_same<T, char>::value>::type> {
+        static void write(json_writer& w, T value) {
+            w.write_uint(value);
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<fc::safe<T>> {
+        static void write(json_writer& w, const fc::safe<T>& value) {
+            w.write(value.value);
+        }
+    };
+
+    template<>
+    struct json_value_writer<std::string> {
+        static void write(json_writer& w, const std::string& value) {
+            w.write_string(value);
+        }
+    };
+
+    template<>
+    struct json_value_writer<asset> {
+        static void write(json_writer& w, const asset& value) {
+            w.write_string(value.to_string());
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<fc::optional<T>> {
+        static void write(json_writer& w, const fc::optional<T>& value) {
+            if (value.valid()) {
+                w.write(*value);
+            } else {
+                w.raw("null");
+            }
+        }
+    };
+
+    /// std::vector<char> is written as the hex string by fc
+    template<typename T>
+    struct json_value_writer<std::vector<T>, typename std::enable_if<
+        !std::is_same<T, char>::value && !std::is_same<T, unsigned char>::value>::type> {
+        static void write(json_writer& w, const std::vector<T>& value) {
+            w.write_array(value);
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<fc::flat_set<T>> {
+        static void write(json_writer& w, const fc::flat_set<T>& value) {
+            w.write_array(value);
+        }
+    };
+
+    template<typename T>
+    struct json_value_writer<std::set<T>> {
+        static void write(json_writer& w, const std::set<T>& value) {
+            w.write_array(value);
+        }
+    };
+
+    template<typename K, typename V>
+    struct json_value_writer<std::pair<K, V>> {
+        static void write(json_writer& w, const std::pair<K, V>& value) {
+            w.raw('[');
+            w.write(value.first);
+            w.raw(',');
+            w.write(value.second);
+            w.raw(']');
+        }
+    };
+
+    /// fc writes maps as arrays of pairs
+    template<typename K, typename V>
+    struct json_value_writer<std::map<K, V>> {
+        static void write(json_writer& w, const std::map<K, V>& value) {
+            w.write_array(value);
+        }
+    };
+
+    /// Like the to_variant visitor of fc, null optional members are skipped
+    template<typename T>
+    class json_object_visitor final {
+    public:
+        json_object_visitor(json_writer& w, const T& value)
+                : _writer(w), _value(value) {
+        }
+
+        template<typename Member, class Class, Member (Class::*member)>
+        void operator()(const char* name) const {
+            add(name, _value.*member);
+        }
+
+    private:
+        template<typename M>
+        void add(const char* name, const fc::optional<M>& value) const {
+            if (value.valid()) {
+                add(name, *value);
+            }
+        }
+
+        template<typename M>
+        void add(const char* name, const M& value) const {
+            if (!_first) {
+                _writer.raw(',');
+            }
+            _first = false;
+            _writer.raw('"');
+            _writer.raw(name);
+            _writer.raw("\":");
+            _writer.write(value);
+        }
+
+        json_writer& _writer;
+        const T& _value;
+        mutable bool _first = true;
+    };
+
+    template<typename T>
+    struct json_value_writer<T, typename std::enable_if<direct_json_serialization<T>::value>::type> {
+        static void write(json_writer& w, const T& value) {
+            w.raw('{');
+            fc::reflector<T>::visit(json_object_visitor<T>(w, value));
+            w.raw('}');
+        }
+    };
+
+} } // golos::protocol
+
+/// Marks a reflected type for the direct JSON serialization, should be used in the global namespace
+#define GOLOS_JSON_DIRECT_SERIALIZATION(TYPE) \
+    namespace golos { namespace protocol { \
+        template<> struct direct_json_serialization<TYPE>: std::true_type {}; \
+    } }
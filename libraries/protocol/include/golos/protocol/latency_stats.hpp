@@ -0,0 +1,51 @@
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <vector>
+
+namespace golos { namespace protocol {
+
+    /**
+     * Counts durations by powers of two: the bucket N has durations in [2^(N-1), 2^N) microseconds,
+     *   the bucket 0 has durations less than 1 microsecond, the last one has all longer durations.
+     */
+    struct latency_histogram {
+        static constexpr uint32_t buckets_count = 24;
+
+        latency_histogram();
+
+        void add(const fc::microseconds& duration);
+
+        uint64_t count = 0;
+        uint64_t total_us = 0;
+        uint64_t max_us = 0;
+        std::vector<uint64_t> buckets;
+    };
+
+    /**
+     * Sums hold times of read locks taken by the current thread while the timer exists, it is used to profile
+     *   API calls. Timers can be nested, the outer timer includes times of inner ones.
+     */
+    class read_lock_timer final {
+    public:
+        read_lock_timer();
+
+        ~read_lock_timer();
+
+        const fc::microseconds& elapsed() const {
+            return _elapsed;
+        }
+
+        /// Adds the duration to the current timer of the thread, if it exists
+        static void add(const fc::microseconds& duration);
+
+    private:
+        read_lock_timer* _prev;
+        fc::microseconds _elapsed;
+    };
+
+} } // golos::protocol
+
+FC_REFLECT((golos::protocol::latency_histogram), (count)(total_us)(max_us)(buckets))
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <golos/protocol/types.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace golos { namespace protocol {
+
+    struct signature_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint32_t size = 0;
+        uint32_t max_size = 0;
+    };
+
+    /**
+     * Keeps public keys recovered from transaction signatures.
+     *
+     * The same transaction is checked when it is pushed to the pending list, when it is reapplied
+     * on block generation and when a block with it is applied. Recovery of keys is the most expensive
+     * part of these checks, so the keys are stored by the signature digest of the transaction
+     * until the transaction expires.
+     *
+     * The cache is filled only by the database for transactions which passed the authority check,
+     * so calls of public APIs with arbitrary transactions can't evict useful keys.
+     */
+    class signature_cache final {
+    public:
+        static signature_cache& instance();
+
+        /// 0 - disables the cache
+        void set_max_size(uint32_t value);
+
+        /**
+         * @return true and fills keys if there are keys for these signatures of the transaction
+         */
+        bool get(
+            const digest_type& sig_digest, const vector<signature_type>& signatures,
+            flat_set<public_key_type>& keys);
+
+        void add(
+            const digest_type& sig_digest, const vector<signature_type>& signatures,
+            fc::time_point_sec expiration, const flat_set<public_key_type>& keys);
+
+        /// Removes keys of transactions which expired before the time
+        void remove_expired(fc::time_point_sec now);
+
+        void clear();
+
+        signature_cache_stats get_stats() const;
+
+    private:
+        signature_cache() = default;
+
+        struct item {
+            digest_type sig_digest;
+            fc::time_point_sec expiration;
+            vector<signature_type> signatures;
+            flat_set<public_key_type> keys;
+        };
+
+        struct by_digest;
+        struct by_expiration;
+
+        using item_index = boost::multi_index_container<
+            item,
+            boost::multi_index::indexed_by<
+                boost::multi_index::ordered_unique<
+                    boost::multi_index::tag<by_digest>,
+                    boost::multi_index::member<item, digest_type, &item::sig_digest>>,
+                boost::multi_index::ordered_non_unique<
+                    boost::multi_index::tag<by_expiration>,
+                    boost::multi_index::member<item, fc::time_point_sec, &item::expiration>>>>;
+
+        mutable std::mutex _mutex;
+        item_index _items;
+        uint32_t _max_size = 0;
+
+        std::atomic<uint64_t> _hits{0};
+        std::atomic<uint64_t> _misses{0};
+    };
+
+} } // golos::protocol
+
+FC_REFLECT((golos::protocol::signature_cache_stats), (hits)(misses)(size)(max_size))
@@ -89,6 +89,9 @@ namespace golos { namespace protocol {
 
             flat_set<public_key_type> get_signature_keys(const chain_id_type &chain_id) const;
 
+            /// The same as get_signature_keys() with the precomputed sig_digest() for the chain
+            flat_set<public_key_type> get_signature_keys_for_digest(const digest_type &sig_digest) const;
+
             vector<signature_type> signatures;
 
             digest_type merkle_digest() const;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <golos/protocol/transaction.hpp>
+
+namespace golos { namespace protocol {
+
+    /**
+     * Id, digests and packed size of a transaction computed by one serialization.
+     *
+     * Each of transaction::id(), sig_digest() and fc::raw::pack_size() serializes the whole transaction,
+     *   the memo is created once on the push and apply path and passed along instead. Values aren't updated
+     *   on changes of the transaction, so the memo shouldn't outlive the unchanged transaction.
+     */
+    class transaction_memo final {
+    public:
+        explicit transaction_memo(const signed_transaction& trx);
+
+        const digest_type& digest() const {
+            return _digest;
+        }
+
+        const transaction_id_type& id() const {
+            return _id;
+        }
+
+        /// Packed size of the signed transaction
+        uint32_t packed_size() const {
+            return _packed_size;
+        }
+
+        /// Computed on the first call, the same chain id should be passed on next calls
+        const digest_type& sig_digest(const chain_id_type& chain_id) const;
+
+    private:
+        std::vector<char> _packed_trx; ///< the transaction without signatures
+        digest_type _digest;
+        transaction_id_type _id;
+        uint32_t _packed_size = 0;
+
+        mutable bool _has_sig_digest = false;
+        mutable digest_type _sig_digest;
+    };
+
+} } // golos::protocol
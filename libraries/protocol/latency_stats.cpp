@@ -0,0 +1,47 @@
+#include <golos/protocol/latency_stats.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace protocol {
+
+    namespace {
+        thread_local read_lock_timer* current_read_lock_timer = nullptr;
+    }
+
+    latency_histogram::latency_histogram()
+            : buckets(buckets_count, 0) {
+    }
+
+    void latency_histogram::add(const fc::microseconds& duration) {
+        uint64_t us = std::max<int64_t>(duration.count(), 0);
+
+        uint32_t bucket = 0;
+        for (auto v = us; v && bucket + 1 < buckets_count; v >>= 1) {
+            ++bucket;
+        }
+
+        ++count;
+        total_us += us;
+        max_us = std::max(max_us, us);
+        ++buckets[bucket];
+    }
+
+    read_lock_timer::read_lock_timer()
+            : _prev(current_read_lock_timer) {
+        current_read_lock_timer = this;
+    }
+
+    read_lock_timer::~read_lock_timer() {
+        current_read_lock_timer = _prev;
+        if (_prev) {
+            _prev->_elapsed += _elapsed;
+        }
+    }
+
+    void read_lock_timer::add(const fc::microseconds& duration) {
+        if (current_read_lock_timer) {
+            current_read_lock_timer->_elapsed += duration;
+        }
+    }
+
+} } // golos::protocol
@@ -0,0 +1,96 @@
+#include <golos/protocol/signature_cache.hpp>
+
+namespace golos { namespace protocol {
+
+    signature_cache& signature_cache::instance() {
+        static signature_cache cache;
+        return cache;
+    }
+
+    void signature_cache::set_max_size(uint32_t value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _max_size = value;
+
+        auto& idx = _items.get<by_expiration>();
+        while (_items.size() > _max_size) {
+            idx.erase(idx.begin());
+        }
+    }
+
+    bool signature_cache::get(
+        const digest_type& sig_digest, const vector<signature_type>& signatures,
+        flat_set<public_key_type>& keys
+    ) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_max_size) {
+                return false;
+            }
+
+            auto& idx = _items.get<by_digest>();
+            auto itr = idx.find(sig_digest);
+            if (itr != idx.end() && itr->signatures == signatures) {
+                keys = itr->keys;
+                ++_hits;
+                return true;
+            }
+        }
+        ++_misses;
+        return false;
+    }
+
+    void signature_cache::add(
+        const digest_type& sig_digest, const vector<signature_type>& signatures,
+        fc::time_point_sec expiration, const flat_set<public_key_type>& keys
+    ) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_max_size) {
+            return;
+        }
+
+        auto& idx = _items.get<by_digest>();
+        auto itr = idx.find(sig_digest);
+        if (itr != idx.end()) {
+            // the same transaction with other signatures, keep the last one
+            idx.modify(itr, [&](item& i) {
+                i.expiration = expiration;
+                i.signatures = signatures;
+                i.keys = keys;
+            });
+            return;
+        }
+
+        if (_items.size() >= _max_size) {
+            // the first to expire is the first to be dropped
+            auto& exp_idx = _items.get<by_expiration>();
+            exp_idx.erase(exp_idx.begin());
+        }
+
+        _items.insert(item{sig_digest, expiration, signatures, keys});
+    }
+
+    void signature_cache::remove_expired(fc::time_point_sec now) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& idx = _items.get<by_expiration>();
+        while (!idx.empty() && idx.begin()->expiration < now) {
+            idx.erase(idx.begin());
+        }
+    }
+
+    void signature_cache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _items.clear();
+    }
+
+    signature_cache_stats signature_cache::get_stats() const {
+        signature_cache_stats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        stats.size = _items.size();
+        stats.max_size = _max_size;
+        return stats;
+    }
+
+} } // golos::protocol
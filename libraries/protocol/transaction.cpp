@@ -236,8 +236,11 @@ namespace golos {
 
 
         flat_set<public_key_type> signed_transaction::get_signature_keys(const chain_id_type &chain_id) const {
+            return get_signature_keys_for_digest(sig_digest(chain_id));
+        }
+
+        flat_set<public_key_type> signed_transaction::get_signature_keys_for_digest(const digest_type &d) const {
             try {
-                auto d = sig_digest(chain_id);
                 flat_set<public_key_type> result;
                 for (const auto &sig : signatures) {
                     GOLOS_ASSERT(
@@ -0,0 +1,26 @@
+#include <golos/protocol/transaction_memo.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace golos { namespace protocol {
+
+    transaction_memo::transaction_memo(const signed_transaction& trx)
+            : _packed_trx(fc::raw::pack(static_cast<const transaction&>(trx))) {
+        _digest = digest_type::hash(_packed_trx.data(), _packed_trx.size());
+        memcpy(_id._hash, _digest._hash, std::min(sizeof(_id), sizeof(_digest)));
+        _packed_size = _packed_trx.size() + fc::raw::pack_size(trx.signatures);
+    }
+
+    const digest_type& transaction_memo::sig_digest(const chain_id_type& chain_id) const {
+        if (!_has_sig_digest) {
+            digest_type::encoder enc;
+            fc::raw::pack(enc, chain_id);
+            enc.write(_packed_trx.data(), _packed_trx.size());
+            _sig_digest = enc.result();
+            _has_sig_digest = true;
+        }
+        return _sig_digest;
+    }
+
+} } // golos::protocol
@@ -113,7 +113,13 @@ DEFINE_API ( plugin, get_block_info ) {
     );
     auto &db = my->database();
     return db.with_weak_read_lock([&]() {
-        return  my->get_block_info(start_block_num, count);
+        auto result = my->get_block_info(start_block_num, count);
+        if (result.size() == count &&
+            start_block_num + count - 1 <= db.get_dynamic_global_properties().last_irreversible_block_num
+        ) {
+            args.mark_immutable();
+        }
+        return result;
     });
 }
 
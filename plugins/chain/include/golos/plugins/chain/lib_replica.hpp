@@ -0,0 +1,71 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace plugins { namespace chain {
+
+    /**
+     * Copy of the chain state at the last irreversible block, which API calls can read without the lock
+     *   of the main database.
+     *
+     * The replica has own shared memory and block log. It takes irreversible blocks from the block log
+     *   of the main database and applies them in the background thread like the replay does, in chunks under
+     *   the write lock of the replica. Only indexes of the chain are kept, plugin indexes are not.
+     */
+    class lib_replica final {
+    public:
+        lib_replica(
+            golos::chain::database& db, boost::filesystem::path data_dir, boost::filesystem::path shared_mem_dir,
+            uint64_t shared_file_size, uint32_t refresh_blocks);
+
+        ~lib_replica();
+
+        /// The replica should be configured before start() like the main database
+        golos::chain::database& db() {
+            return _replica;
+        }
+
+        /// Opens the replica (rebuilds it if it is corrupted) and starts the applying thread
+        void start();
+
+        void stop();
+
+        /// Called by the main database on each block, blocks up to the irreversible one can be applied
+        void notify(uint32_t last_irreversible_block_num);
+
+        /// The block, which state the replica has
+        uint32_t head_block_num() const {
+            return _head_block_num;
+        }
+
+    private:
+        void work_loop();
+
+        /// @return true if there are more blocks to apply
+        bool apply_blocks();
+
+        golos::chain::database& _db;
+        golos::chain::database _replica;
+        boost::filesystem::path _data_dir;
+        boost::filesystem::path _shared_mem_dir;
+        uint64_t _shared_file_size;
+        uint32_t _refresh_blocks;
+
+        std::atomic<uint32_t> _head_block_num{0};
+        std::atomic<uint32_t> _target_block_num{0};
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _is_notified = false;
+        std::atomic<bool> _is_stopped{false};
+        std::thread _thread;
+    };
+
+} } } // golos::plugins::chain
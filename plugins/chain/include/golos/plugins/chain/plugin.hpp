@@ -6,6 +6,8 @@
 #include <golos/protocol/block.hpp>
 #include <golos/chain/database.hpp>
 #include <golos/plugins/json_rpc/plugin.hpp>
+#include <golos/plugins/chain/transaction_queue.hpp>
+#include <golos/plugins/chain/lib_replica.hpp>
 
 #include <boost/signals2.hpp>
 
@@ -41,8 +43,31 @@ namespace golos { namespace plugins { namespace chain {
 
                 bool accept_block(const protocol::signed_block &block, bool currently_syncing = false, uint32_t skip = 0);
 
+                /**
+                 * Starts the state-independent checks of a block in the background,
+                 * results will be used by accept_block() for this block.
+                 *
+                 * @param recover_signatures true if the block will be accepted with the signature checks
+                 */
+                void prevalidate_block(
+                    const protocol::signed_block &block, const protocol::block_id_type &block_id,
+                    bool recover_signatures);
+
                 void accept_transaction(const protocol::signed_transaction &trx);
 
+                /**
+                 * Validates the transaction in the calling thread and pushes it through the transaction queue,
+                 * the callback gets the result of pushing, possibly in other thread.
+                 * Throws if the transaction is invalid.
+                 */
+                void accept_transaction(
+                    const protocol::signed_transaction &trx, std::function<void(std::exception_ptr)> callback);
+
+                transaction_queue_stats get_transaction_queue_stats() const;
+
+                /// Copy of the state at the last irreversible block, nullptr if it is disabled
+                lib_replica* get_lib_replica() const;
+
                 bool block_is_on_preferred_chain(const protocol::block_id_type &block_id);
 
                 void check_time_in_block(const protocol::signed_block &block);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace golos { namespace plugins { namespace chain {
+
+    struct transaction_queue_stats {
+        uint32_t queue_size = 0;
+        uint32_t max_queue_size = 0;
+        uint64_t transactions = 0;
+        uint64_t batches = 0;
+        uint32_t max_batch_size = 0;
+        uint64_t full_queue_waits = 0; ///< how many times a caller waited for a free place in the queue
+    };
+
+    /**
+     * Collects transactions from API and p2p threads and pushes them to the database in batches,
+     *   so many transactions take the write lock once instead of waiting for it one by one.
+     *
+     * One caller at a time becomes the drainer: push() returns true for it, then it schedules calls
+     *   of process_batch() in the write thread until it returns false. Without the write thread the queue
+     *   is drained by its own thread, so callers don't process transactions of others. The result of each
+     *   transaction is passed to its callback in the drainer thread. If the queue is full, push() waits
+     *   for a free place.
+     */
+    class transaction_queue final {
+    public:
+        using callback_type = std::function<void(std::exception_ptr)>;
+
+        transaction_queue(golos::chain::database& db, uint32_t max_size, uint32_t max_batch_size);
+
+        ~transaction_queue();
+
+        /// Starts the own thread draining the queue, after it push() always returns false
+        void start_thread();
+
+        /// @return true if the caller should drain the queue
+        bool push(const protocol::signed_transaction& trx, uint32_t skip, callback_type callback);
+
+        /// Pushes the next batch to the database, @return true if the queue isn't empty yet
+        bool process_batch();
+
+        /// Stops the thread and fails all waiting transactions
+        void stop();
+
+        transaction_queue_stats get_stats() const;
+
+    private:
+        struct item {
+            golos::chain::transaction_push_request request;
+            callback_type callback;
+        };
+
+        void work_loop();
+
+        golos::chain::database& _db;
+        const uint32_t _max_size;
+        const uint32_t _max_batch_size;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _space_cv;
+        std::condition_variable _queue_cv;
+        std::thread _thread;
+        std::deque<item> _queue;
+        bool _is_draining = false;
+        bool _is_stopped = false;
+
+        transaction_queue_stats _stats;
+    };
+
+} } } // golos::plugins::chain
+
+FC_REFLECT((golos::plugins::chain::transaction_queue_stats),
+    (queue_size)(max_queue_size)(transactions)(batches)(max_batch_size)(full_queue_waits))
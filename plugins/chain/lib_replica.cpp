@@ -0,0 +1,114 @@
+#include <golos/plugins/chain/lib_replica.hpp>
+#include <golos/chain/database_exceptions.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace plugins { namespace chain {
+
+    /// Blocks applied under one acquisition of the write lock of the replica
+    static constexpr uint32_t apply_chunk_blocks = 100;
+
+    lib_replica::lib_replica(
+        golos::chain::database& db, boost::filesystem::path data_dir, boost::filesystem::path shared_mem_dir,
+        uint64_t shared_file_size, uint32_t refresh_blocks
+    ) : _db(db),
+        _data_dir(std::move(data_dir)),
+        _shared_mem_dir(std::move(shared_mem_dir)),
+        _shared_file_size(shared_file_size),
+        _refresh_blocks(std::max<uint32_t>(refresh_blocks, 1)) {
+    }
+
+    lib_replica::~lib_replica() {
+        stop();
+    }
+
+    void lib_replica::start() {
+        auto open = [&]() {
+            _replica.open(_data_dir, _shared_mem_dir, STEEMIT_INIT_SUPPLY, _shared_file_size,
+                chainbase::database::read_write);
+        };
+
+        try {
+            open();
+        } catch (const fc::exception& e) {
+            wlog("LIB replica can't be opened, rebuilding it from the first block: ${e}", ("e", e.to_string()));
+            _replica.wipe(_data_dir, _shared_mem_dir, true);
+            open();
+        }
+        _head_block_num = _replica.head_block_num();
+
+        ilog("LIB replica is at block ${n}", ("n", _head_block_num.load()));
+
+        _is_stopped = false;
+        _thread = std::thread([this]{ work_loop(); });
+    }
+
+    void lib_replica::stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_is_stopped.exchange(true)) {
+                return;
+            }
+        }
+        _cv.notify_all();
+
+        if (_thread.joinable()) {
+            _thread.join();
+            _replica.close();
+        }
+    }
+
+    void lib_replica::notify(uint32_t last_irreversible_block_num) {
+        if (last_irreversible_block_num < _head_block_num + _refresh_blocks) {
+            return;
+        }
+        _target_block_num = last_irreversible_block_num;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _is_notified = true;
+        }
+        _cv.notify_one();
+    }
+
+    void lib_replica::work_loop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [&]{ return _is_stopped || _is_notified; });
+                if (_is_stopped) {
+                    return;
+                }
+                _is_notified = false;
+            }
+
+            try {
+                while (!_is_stopped && apply_blocks()) {
+                }
+            } catch (const fc::exception& e) {
+                elog("LIB replica failed to apply block ${n}: ${e}",
+                    ("n", _head_block_num + 1)("e", e.to_detail_string()));
+            }
+        }
+    }
+
+    bool lib_replica::apply_blocks() {
+        uint32_t head = _head_block_num;
+        uint32_t target = _target_block_num;
+        if (head >= target) {
+            return false;
+        }
+
+        auto last = std::min(target, head + apply_chunk_blocks);
+        _replica.with_strong_write_lock([&]() {
+            for (auto n = head + 1; n <= last; ++n) {
+                // irreversible blocks are in the block log, it has own lock
+                auto block = _db.get_block_log().read_block_by_num(n);
+                FC_ASSERT(block, "No block in the block log", ("block_num", n));
+                _replica.apply_irreversible_block(*block);
+                _head_block_num = n;
+            }
+        });
+        return last < target;
+    }
+
+} } } // golos::plugins::chain
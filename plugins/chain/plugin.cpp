@@ -1,12 +1,17 @@
 #include <golos/plugins/chain/plugin.hpp>
+#include <golos/plugins/chain/transaction_queue.hpp>
 #include <golos/chain/database_exceptions.hpp>
+#include <golos/chain/block_prevalidator.hpp>
 #include <golos/chain/comment_object.hpp>
 #include <golos/protocol/protocol.hpp>
+#include <golos/protocol/signature_cache.hpp>
 #include <golos/protocol/types.hpp>
 
 #include <fc/io/json.hpp>
 #include <fc/string.hpp>
 
+#include <boost/algorithm/string.hpp>
+
 #include <iostream>
 #include <future>
 
@@ -24,11 +29,14 @@ namespace golos { namespace plugins { namespace chain {
         bool replay = false;
         bool replay_if_corrupted = true;
         bool force_replay = false;
+        std::vector<std::string> reindex_plugins;
         bool resync = false;
         bool readonly = false;
         bool check_locks = false;
         bool validate_invariants = false;
         uint32_t flush_interval = 0;
+        bool flush_async = false;
+        uint32_t flush_max_rate = 0;
         flat_map<uint32_t, block_id_type> loaded_checkpoints;
 
         uint32_t allow_future_time = 5;
@@ -39,6 +47,8 @@ namespace golos { namespace plugins { namespace chain {
         uint64_t write_wait_micro;
         uint32_t max_write_wait_retries;
 
+        bool use_priority_lock = false;
+
         size_t inc_shared_memory_size;
         size_t min_free_shared_memory_size;
 
@@ -48,12 +58,42 @@ namespace golos { namespace plugins { namespace chain {
 
         uint32_t block_num_check_free_size = 0;
 
+        uint32_t shared_memory_advice = golos::chain::shared_memory_advice_normal;
+        uint32_t shared_memory_prefault_threads = 0;
+
+        uint32_t recent_transaction_cache_size = 10000;
+
+        uint32_t replay_reader_threads = 2;
+        uint32_t replay_prefetch_blocks = 1000;
+
+        uint32_t block_log_chunk_blocks = 0;
+        uint32_t block_log_cache_chunks = 16;
+
+        uint32_t apply_timing_log_interval = 0;
+
         bool skip_virtual_ops = false;
 
         golos::chain::database db;
 
+        golos::chain::block_prevalidator prevalidator;
+        uint32_t prevalidate_threads = 2;
+        uint32_t prevalidate_blocks = 200;
+
         bool single_write_thread = false;
 
+        std::unique_ptr<transaction_queue> trx_queue;
+        uint32_t trx_queue_size = 0;
+        uint32_t trx_batch_size = 100;
+
+        std::unique_ptr<lib_replica> replica;
+        bool use_lib_replica = false;
+        uint32_t lib_replica_refresh_blocks = 1;
+
+        bfs::path snapshot_import;
+        bfs::path snapshot_export;
+        bool snapshot_export_plugins = false;
+        uint32_t snapshot_threads = 4;
+
         golos::chain::database::store_metadata_modes store_account_metadata;
         std::vector<std::string> accounts_to_store_metadata;
         bool store_memo_in_savings_withdraws = true;
@@ -74,11 +114,16 @@ namespace golos { namespace plugins { namespace chain {
 
         void check_time_in_block(const protocol::signed_block& block);
         bool accept_block(const protocol::signed_block& block, bool currently_syncing, uint32_t skip);
-        void accept_transaction(const protocol::signed_transaction& trx);
+        void accept_transaction(const protocol::signed_transaction& trx, transaction_queue::callback_type callback);
+        void push_transaction(const protocol::signed_transaction& trx, uint32_t skip);
+        void drain_transaction_queue();
         void wipe_db(const bfs::path& data_dir, bool wipe_block_log);
         void replay_db(const bfs::path& data_dir, bool force_replay);
 
         void on_block (const protocol::signed_block& b);
+
+        void configure_database(golos::chain::database& database);
+        void start_lib_replica(const bfs::path& data_dir);
     };
 
 
@@ -97,6 +142,63 @@ namespace golos { namespace plugins { namespace chain {
         }
     }
 
+    void plugin::impl::configure_database(golos::chain::database& chain_db) {
+        chain_db.set_flush_interval(flush_interval);
+        chain_db.set_async_flush(flush_async, uint64_t(flush_max_rate) * 1024 * 1024);
+        chain_db.add_checkpoints(loaded_checkpoints);
+        chain_db.set_require_locking(check_locks);
+
+        chain_db.set_read_wait_micro(read_wait_micro);
+        chain_db.set_max_read_wait_retries(max_read_wait_retries);
+        chain_db.set_write_wait_micro(write_wait_micro);
+        chain_db.set_max_write_wait_retries(max_write_wait_retries);
+        chain_db.set_priority_lock(use_priority_lock);
+
+        chain_db.set_inc_shared_memory_size(inc_shared_memory_size);
+        chain_db.set_min_free_shared_memory_size(min_free_shared_memory_size);
+
+
+        chain_db.set_store_account_metadata(store_account_metadata);
+
+        chain_db.set_accounts_to_store_metadata(accounts_to_store_metadata);
+
+        chain_db.set_store_memo_in_savings_withdraws(store_memo_in_savings_withdraws);
+
+        if (skip_virtual_ops) {
+            chain_db.set_skip_virtual_ops();
+        }
+
+        if (block_num_check_free_size) {
+            chain_db.set_block_num_check_free_size(block_num_check_free_size);
+        }
+
+        chain_db.set_shared_memory_advice(shared_memory_advice);
+        chain_db.set_shared_memory_prefault_threads(shared_memory_prefault_threads);
+
+        chain_db.set_recent_transaction_cache_size(recent_transaction_cache_size);
+
+        chain_db.set_replay_reader_threads(replay_reader_threads);
+        chain_db.set_replay_prefetch_blocks(replay_prefetch_blocks);
+        chain_db.set_block_log_chunk_blocks(block_log_chunk_blocks);
+        chain_db.set_block_log_cache_chunks(block_log_cache_chunks);
+        chain_db.set_apply_timing_log_interval(apply_timing_log_interval);
+
+        chain_db.enable_plugins_on_push_transaction(enable_plugins_on_push_transaction);
+    }
+
+    void plugin::impl::start_lib_replica(const bfs::path& data_dir) {
+        replica = std::make_unique<lib_replica>(
+            db, data_dir / "lib_replica", shared_memory_dir / "lib_replica", shared_memory_size,
+            lib_replica_refresh_blocks);
+        configure_database(replica->db());
+        replica->start();
+
+        db.applied_block.connect([this](const protocol::signed_block&) {
+            replica->notify(db.last_non_undoable_block_num());
+        });
+        replica->notify(db.last_non_undoable_block_num());
+    }
+
     void plugin::impl::check_time_in_block(const protocol::signed_block& block) {
         time_point_sec now = fc::time_point::now();
 
@@ -116,6 +218,15 @@ namespace golos { namespace plugins { namespace chain {
 
         check_time_in_block(block);
 
+        auto prevalidated = prevalidator.take(block.id());
+        if (prevalidated && !prevalidated->matches(block)) {
+            // the same header with other transactions, results are for the other copy of the block
+            prevalidated.reset();
+        }
+        if (prevalidated && prevalidated->merkle_root == block.transaction_merkle_root) {
+            skip |= golos::chain::database::skip_merkle_check;
+        }
+
         skip = db.validate_block(block, skip);
 
         if (single_write_thread) {
@@ -124,14 +235,14 @@ namespace golos { namespace plugins { namespace chain {
 
             io_service().post([&]{
                 try {
-                    promise.set_value(db.push_block(block, skip));
+                    promise.set_value(db.push_block(block, skip, prevalidated));
                 } catch (...) {
                     promise.set_exception(std::current_exception());
                 }
             });
             return result.get(); // if an exception was, it will be thrown
         } else {
-            return db.push_block(block, skip);
+            return db.push_block(block, skip, prevalidated);
         }
     }
 
@@ -160,9 +271,44 @@ namespace golos { namespace plugins { namespace chain {
         db.reindex(data_dir, shared_memory_dir, from_block_num, shared_memory_size);
     };
 
-    void plugin::impl::accept_transaction(const protocol::signed_transaction& trx) {
+    void plugin::impl::accept_transaction(
+        const protocol::signed_transaction& trx, transaction_queue::callback_type callback
+    ) {
         uint32_t skip = db.validate_transaction(trx, db.skip_apply_transaction);
 
+        // authority and TaPoS were checked against the head state, but the pending state can differ,
+        //   the repeated check is cheap because keys are taken from the signature cache,
+        //   and it allows to use pending transactions as is on block generation
+        skip &= ~(
+            golos::chain::database::skip_authority_check |
+            golos::chain::database::skip_transaction_signatures |
+            golos::chain::database::skip_tapos_check);
+
+        if (trx_queue) {
+            // without the write thread the queue is drained by its own thread
+            if (trx_queue->push(trx, skip, std::move(callback))) {
+                io_service().post([this]{ drain_transaction_queue(); });
+            }
+            return;
+        }
+
+        std::exception_ptr error;
+        try {
+            push_transaction(trx, skip);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        callback(error);
+    }
+
+    void plugin::impl::drain_transaction_queue() {
+        // one batch per call, so blocks from the write thread aren't delayed by a long queue
+        if (trx_queue->process_batch()) {
+            io_service().post([this]{ drain_transaction_queue(); });
+        }
+    }
+
+    void plugin::impl::push_transaction(const protocol::signed_transaction& trx, uint32_t skip) {
         if (single_write_thread) {
             std::promise<bool> promise;
             auto wait = promise.get_future();
@@ -212,12 +358,72 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "block-num-check-free-size", bpo::value<uint32_t>()->default_value(1000),
                 "Check free space in shared memory each N blocks. Default: 1000 (each 3000 seconds)."
+            ) (
+                "shared-file-madvise", bpo::value<std::vector<std::string>>()->composing()->multitoken(),
+                "Hints for the kernel about the mapping of shared memory: random, willneed, hugepage. "
+                "Default: normal"
+            ) (
+                "shared-file-prefault-threads", bpo::value<uint32_t>()->default_value(0),
+                "Number of threads reading all pages of shared memory on startup. 0 - disable. Default: 0"
+            ) (
+                "replay-reader-threads", bpo::value<uint32_t>()->default_value(2),
+                "Number of threads reading and deserializing blocks from block log ahead of applying on replay. "
+                "0 - read blocks in the apply thread. Default: 2"
+            ) (
+                "replay-prefetch-blocks", bpo::value<uint32_t>()->default_value(1000),
+                "Maximum number of deserialized blocks waiting to be applied on replay. Default: 1000"
+            ) (
+                "block-log-chunk-blocks", bpo::value<uint32_t>()->default_value(0),
+                "Number of blocks compressed together in a new block_log. 0 - the raw format. "
+                "The format of an existing block_log is detected automatically. Default: 0"
+            ) (
+                "block-log-cache-chunks", bpo::value<uint32_t>()->default_value(16),
+                "Number of decoded chunks of the compressed block_log kept in memory. Default: 16"
+            ) (
+                "prevalidate-threads", bpo::value<uint32_t>()->default_value(2),
+                "Number of threads validating operations, recovering signatures and checking merkle root "
+                "of received blocks ahead of applying. 0 - disable. Default: 2"
+            ) (
+                "prevalidate-blocks", bpo::value<uint32_t>()->default_value(200),
+                "Maximum number of received blocks prevalidated ahead of applying. Default: 200"
+            ) (
+                "signature-cache-size", bpo::value<uint32_t>()->default_value(100000),
+                "Maximum number of transactions to keep keys recovered from their signatures. 0 - disable. Default: 100000"
+            ) (
+                "recent-transaction-cache-size", bpo::value<uint32_t>()->default_value(10000),
+                "Maximum number of applied transactions kept in memory until expiration to serve them to peers. "
+                "0 - disable. Default: 10000"
+            ) (
+                "apply-timing-log-interval", bpo::value<uint32_t>()->default_value(0),
+                "Write the most expensive operations and steps of block applying to the log each N blocks. "
+                "0 - disable. Default: 0"
+            ) (
+                "snapshot-import", bpo::value<bfs::path>(),
+                "Wipe the chain state and load it from the snapshot instead of replaying. The block log should "
+                "contain the block of the snapshot, the node continues from it (absolute path or relative to application data dir)"
+            ) (
+                "snapshot-export", bpo::value<bfs::path>(),
+                "Write the snapshot of the chain state at the last irreversible block on startup "
+                "(absolute path or relative to application data dir)"
+            ) (
+                "snapshot-export-plugins", bpo::value<bool>()->default_value(false),
+                "Write also the state of plugins to the snapshot. Default: false"
+            ) (
+                "snapshot-threads", bpo::value<uint32_t>()->default_value(4),
+                "Number of threads writing sections of the snapshot. Default: 4"
             ) (
                 "checkpoint", bpo::value<std::vector<std::string>>()->composing(),
                 "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints."
             ) (
                 "flush-state-interval", bpo::value<uint32_t>(),
                 "flush shared memory changes to disk every N blocks"
+            ) (
+                "flush-state-async", bpo::value<bool>()->default_value(false),
+                "Flush shared memory in the background thread, block applying doesn't wait for it. Default: false"
+            ) (
+                "flush-state-max-rate", bpo::value<uint32_t>()->default_value(0),
+                "Maximum rate of the background flush of shared memory, in megabytes per second. "
+                "0 - without the limit. Default: 0"
             ) (
                 "read-wait-micro", bpo::value<uint64_t>(),
                 "maximum microseconds for trying to get read lock"
@@ -230,9 +436,27 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "max-write-wait-retries", bpo::value<uint32_t>(),
                 "maximum number of retries to get write lock"
+            ) (
+                "priority-lock", bpo::value<bool>()->default_value(false),
+                "Take the database lock through the gate, which lets the block writer in first and queues readers "
+                "instead of retrying. Default: false"
+            ) (
+                "lib-replica", bpo::value<bool>()->default_value(false),
+                "Keep a copy of the state at the last irreversible block for API calls, which don't need "
+                "the newest state. Default: false"
+            ) (
+                "lib-replica-refresh-blocks", bpo::value<uint32_t>()->default_value(1),
+                "Apply irreversible blocks to the LIB replica when it lags behind by this number of blocks. Default: 1"
             ) (
                 "single-write-thread", bpo::value<bool>()->default_value(false),
                 "push blocks and transactions from one thread"
+            ) (
+                "transaction-queue-size", bpo::value<uint32_t>()->default_value(0),
+                "Maximum number of received transactions waiting to be pushed in batches, "
+                "callers wait if the queue is full. 0 - push each transaction separately. Default: 0"
+            ) (
+                "transaction-batch-size", bpo::value<uint32_t>()->default_value(100),
+                "Maximum number of transactions pushed under one acquisition of the write lock. Default: 100"
             ) (
                 "clear-votes-before-block", bpo::value<uint32_t>()->default_value(0),
                 "remove votes before defined block, should speedup initial synchronization"
@@ -268,6 +492,10 @@ namespace golos { namespace plugins { namespace chain {
             ) (
                 "force-replay-blockchain", bpo::bool_switch()->default_value(false),
                 "force clear chain database and replay all blocks"
+            ) (
+                "reindex-plugins", bpo::value<std::vector<std::string>>()->composing()->multitoken(),
+                "clear the state of the given plugins (e.g. follow) and rebuild it from operations of the block log "
+                "without replaying of the chain state. Plugins, which depend on virtual operations, can't be reindexed"
             ) (
                 "resync-blockchain", bpo::bool_switch()->default_value(false),
                 "clear chain database and block log"
@@ -310,8 +538,19 @@ namespace golos { namespace plugins { namespace chain {
             my->max_write_wait_retries = options.at("max-write-wait-retries").as<uint32_t>();
         }
 
+        my->use_priority_lock = options.at("priority-lock").as<bool>();
+
+        my->use_lib_replica = options.at("lib-replica").as<bool>();
+        my->lib_replica_refresh_blocks = options.at("lib-replica-refresh-blocks").as<uint32_t>();
+
         my->single_write_thread = options.at("single-write-thread").as<bool>();
 
+        my->trx_queue_size = options.at("transaction-queue-size").as<uint32_t>();
+        my->trx_batch_size = options.at("transaction-batch-size").as<uint32_t>();
+        if (my->trx_queue_size) {
+            my->trx_queue = std::make_unique<transaction_queue>(my->db, my->trx_queue_size, my->trx_batch_size);
+        }
+
         my->enable_plugins_on_push_transaction = options.at("enable-plugins-on-push-transaction").as<bool>();
 
         my->shared_memory_size = fc::parse_size(options.at("shared-file-size").as<std::string>());
@@ -325,9 +564,54 @@ namespace golos { namespace plugins { namespace chain {
             my->block_num_check_free_size = options.at("block-num-check-free-size").as<uint32_t>();
         }
 
+        if (options.count("shared-file-madvise")) {
+            my->shared_memory_advice = golos::chain::parse_shared_memory_advice(
+                options.at("shared-file-madvise").as<std::vector<std::string>>());
+        }
+        my->shared_memory_prefault_threads = options.at("shared-file-prefault-threads").as<uint32_t>();
+
+        my->replay_reader_threads = options.at("replay-reader-threads").as<uint32_t>();
+        my->replay_prefetch_blocks = options.at("replay-prefetch-blocks").as<uint32_t>();
+
+        my->block_log_chunk_blocks = options.at("block-log-chunk-blocks").as<uint32_t>();
+        my->block_log_cache_chunks = options.at("block-log-cache-chunks").as<uint32_t>();
+
+        my->prevalidate_threads = options.at("prevalidate-threads").as<uint32_t>();
+        my->prevalidate_blocks = options.at("prevalidate-blocks").as<uint32_t>();
+
+        protocol::signature_cache::instance().set_max_size(options.at("signature-cache-size").as<uint32_t>());
+
+        my->recent_transaction_cache_size = options.at("recent-transaction-cache-size").as<uint32_t>();
+
+        my->apply_timing_log_interval = options.at("apply-timing-log-interval").as<uint32_t>();
+
+        auto to_data_dir_path = [](const bfs::path& path) {
+            return path.is_relative() ? appbase::app().data_dir() / path : path;
+        };
+        if (options.count("snapshot-import")) {
+            my->snapshot_import = to_data_dir_path(options.at("snapshot-import").as<bfs::path>());
+        }
+        if (options.count("snapshot-export")) {
+            my->snapshot_export = to_data_dir_path(options.at("snapshot-export").as<bfs::path>());
+        }
+        my->snapshot_export_plugins = options.at("snapshot-export-plugins").as<bool>();
+        my->snapshot_threads = options.at("snapshot-threads").as<uint32_t>();
+
         my->replay = options.at("replay-blockchain").as<bool>();
         my->replay_if_corrupted = options.at("replay-if-corrupted").as<bool>();
         my->force_replay = options.at("force-replay-blockchain").as<bool>();
+        if (options.count("reindex-plugins")) {
+            for (const auto& value: options.at("reindex-plugins").as<std::vector<std::string>>()) {
+                std::vector<std::string> names;
+                boost::split(names, value, boost::is_any_of(","));
+                for (auto& name: names) {
+                    boost::trim(name);
+                    if (!name.empty()) {
+                        my->reindex_plugins.push_back(name);
+                    }
+                }
+            }
+        }
         my->resync = options.at("resync-blockchain").as<bool>();
         my->check_locks = options.at("check-locks").as<bool>();
         my->validate_invariants = options.at("validate-database-invariants").as<bool>();
@@ -336,6 +620,8 @@ namespace golos { namespace plugins { namespace chain {
         } else {
             my->flush_interval = 10000;
         }
+        my->flush_async = options.at("flush-state-async").as<bool>();
+        my->flush_max_rate = options.at("flush-state-max-rate").as<uint32_t>();
 
         if (options.count("checkpoint")) {
             auto cps = options.at("checkpoint").as<std::vector<std::string>>();
@@ -378,38 +664,15 @@ namespace golos { namespace plugins { namespace chain {
             my->db.wipe(data_dir, my->shared_memory_dir, true);
         }
 
-        my->db.set_flush_interval(my->flush_interval);
-        my->db.add_checkpoints(my->loaded_checkpoints);
-        my->db.set_require_locking(my->check_locks);
-
-        my->db.set_read_wait_micro(my->read_wait_micro);
-        my->db.set_max_read_wait_retries(my->max_read_wait_retries);
-        my->db.set_write_wait_micro(my->write_wait_micro);
-        my->db.set_max_write_wait_retries(my->max_write_wait_retries);
-
-        my->db.set_inc_shared_memory_size(my->inc_shared_memory_size);
-        my->db.set_min_free_shared_memory_size(my->min_free_shared_memory_size);
-
-
-        my->db.set_store_account_metadata(my->store_account_metadata);
-
-        my->db.set_accounts_to_store_metadata(my->accounts_to_store_metadata);
-
-        my->db.set_store_memo_in_savings_withdraws(my->store_memo_in_savings_withdraws);
-
-        if (my->skip_virtual_ops) {
-            my->db.set_skip_virtual_ops();
-        }
-
-        if (my->block_num_check_free_size) {
-            my->db.set_block_num_check_free_size(my->block_num_check_free_size);
-        }
-
-        my->db.enable_plugins_on_push_transaction(my->enable_plugins_on_push_transaction);
+        my->configure_database(my->db);
 
         try {
             ilog("Opening shared memory from ${path}", ("path", my->shared_memory_dir.generic_string()));
-            my->db.open(data_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size, chainbase::database::read_write/*, my->validate_invariants*/);
+            if (!my->snapshot_import.empty()) {
+                my->db.open_from_snapshot(data_dir, my->shared_memory_dir, my->snapshot_import, my->shared_memory_size);
+            } else {
+                my->db.open(data_dir, my->shared_memory_dir, STEEMIT_INIT_SUPPLY, my->shared_memory_size, chainbase::database::read_write/*, my->validate_invariants*/);
+            }
             auto head_block_log = my->db.get_block_log().head();
             my->replay |= head_block_log && my->db.revision() != head_block_log->block_num();
 
@@ -447,11 +710,46 @@ namespace golos { namespace plugins { namespace chain {
             }
         }
 
+        if (!my->reindex_plugins.empty()) {
+            if (my->replay) {
+                ilog("Plugins were rebuilt by the replay, skipping reindexing of plugins");
+            } else {
+                my->db.reindex_plugins(my->reindex_plugins);
+            }
+        }
+
+        if (!my->snapshot_export.empty()) {
+            my->db.export_snapshot(my->snapshot_export, my->snapshot_export_plugins, my->snapshot_threads);
+        }
+
+        if (my->use_lib_replica) {
+            my->start_lib_replica(data_dir);
+        }
+
+        my->prevalidator.start(my->prevalidate_threads, my->prevalidate_blocks);
+
+        if (my->trx_queue && !my->single_write_thread) {
+            my->trx_queue->start_thread();
+        }
+
         ilog("Started on blockchain with ${n} blocks", ("n", my->db.head_block_num()));
         on_sync();
     }
 
     void plugin::plugin_shutdown() {
+        my->prevalidator.stop();
+
+        if (my->replica) {
+            my->replica->stop();
+        }
+
+        if (my->trx_queue) {
+            my->trx_queue->stop();
+            auto stats = my->trx_queue->get_stats();
+            ilog("Transaction queue: ${t} transactions in ${b} batches, max batch ${m}, ${w} waits for full queue",
+                ("t", stats.transactions)("b", stats.batches)("m", stats.max_batch_size)("w", stats.full_queue_waits));
+        }
+
         ilog("closing chain database");
         my->db.close();
         ilog("database closed successfully");
@@ -461,8 +759,41 @@ namespace golos { namespace plugins { namespace chain {
         return my->accept_block(block, currently_syncing, skip);
     }
 
+    void plugin::prevalidate_block(
+        const protocol::signed_block& block, const protocol::block_id_type& block_id, bool recover_signatures
+    ) {
+        my->prevalidator.prevalidate(block, block_id, recover_signatures);
+    }
+
     void plugin::accept_transaction(const protocol::signed_transaction& trx) {
-        my->accept_transaction(trx);
+        std::promise<void> promise;
+        auto wait = promise.get_future();
+
+        my->accept_transaction(trx, [&](std::exception_ptr error) {
+            if (error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_value();
+            }
+        });
+        wait.get(); // if an exception was, it will be thrown
+    }
+
+    void plugin::accept_transaction(
+        const protocol::signed_transaction& trx, std::function<void(std::exception_ptr)> callback
+    ) {
+        my->accept_transaction(trx, std::move(callback));
+    }
+
+    lib_replica* plugin::get_lib_replica() const {
+        return my->replica.get();
+    }
+
+    transaction_queue_stats plugin::get_transaction_queue_stats() const {
+        if (my->trx_queue) {
+            return my->trx_queue->get_stats();
+        }
+        return transaction_queue_stats();
     }
 
     bool plugin::block_is_on_preferred_chain(const protocol::block_id_type& block_id) {
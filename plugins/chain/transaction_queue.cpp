@@ -0,0 +1,149 @@
+#include <golos/plugins/chain/transaction_queue.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+
+namespace golos { namespace plugins { namespace chain {
+
+    transaction_queue::transaction_queue(golos::chain::database& db, uint32_t max_size, uint32_t max_batch_size)
+            : _db(db),
+              _max_size(std::max<uint32_t>(max_size, 1)),
+              _max_batch_size(std::max<uint32_t>(max_batch_size, 1)) {
+    }
+
+    transaction_queue::~transaction_queue() {
+        stop();
+    }
+
+    void transaction_queue::start_thread() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_thread.joinable() && !_is_stopped) {
+            // the thread is the only drainer
+            _is_draining = true;
+            _thread = std::thread([this]{ work_loop(); });
+        }
+    }
+
+    void transaction_queue::work_loop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _queue_cv.wait(lock, [&]{ return _is_stopped || !_queue.empty(); });
+                if (_is_stopped) {
+                    return;
+                }
+            }
+            process_batch();
+        }
+    }
+
+    bool transaction_queue::push(const protocol::signed_transaction& trx, uint32_t skip, callback_type callback) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_is_stopped && _queue.size() >= _max_size) {
+            ++_stats.full_queue_waits;
+            _space_cv.wait(lock, [&]{ return _is_stopped || _queue.size() < _max_size; });
+        }
+        FC_ASSERT(!_is_stopped, "Node is stopping, transaction isn't accepted");
+
+        _queue.push_back({{trx, skip, nullptr}, std::move(callback)});
+        _stats.max_queue_size = std::max<uint32_t>(_stats.max_queue_size, _queue.size());
+
+        if (_thread.joinable()) {
+            _queue_cv.notify_one();
+            return false;
+        }
+        if (_is_draining) {
+            return false;
+        }
+        _is_draining = true;
+        return true;
+    }
+
+    bool transaction_queue::process_batch() {
+        std::vector<golos::chain::transaction_push_request> requests;
+        std::vector<callback_type> callbacks;
+        std::size_t done = 0;
+        try {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto size = std::min<std::size_t>(_queue.size(), _max_batch_size);
+                requests.reserve(size);
+                callbacks.reserve(size);
+                for (std::size_t i = 0; i < size; ++i) {
+                    requests.push_back(std::move(_queue.front().request));
+                    callbacks.push_back(std::move(_queue.front().callback));
+                    _queue.pop_front();
+                }
+            }
+            _space_cv.notify_all();
+
+            if (!requests.empty()) {
+                _db.push_transactions(requests);
+
+                for (; done < requests.size(); ++done) {
+                    try {
+                        callbacks[done](requests[done].error);
+                    } catch (...) {
+                        elog("Callback of a queued transaction failed");
+                    }
+                }
+            }
+        } catch (...) {
+            // the drainer isn't stopped by an error, callers of the batch get it instead of results
+            elog("Can't push batch of queued transactions");
+            auto error = std::current_exception();
+            for (; done < callbacks.size(); ++done) {
+                try {
+                    callbacks[done](error);
+                } catch (...) {
+                    elog("Callback of a queued transaction failed");
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!requests.empty()) {
+            _stats.transactions += requests.size();
+            ++_stats.batches;
+            _stats.max_batch_size = std::max<uint32_t>(_stats.max_batch_size, requests.size());
+        }
+        if (_queue.empty()) {
+            _is_draining = _thread.joinable();
+            return false;
+        }
+        return true;
+    }
+
+    void transaction_queue::stop() {
+        std::deque<item> queue;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _is_stopped = true;
+            queue.swap(_queue);
+        }
+        _space_cv.notify_all();
+        _queue_cv.notify_all();
+        if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id()) {
+            _thread.join();
+        }
+
+        std::exception_ptr error;
+        try {
+            FC_THROW("Node is stopping, transaction isn't accepted");
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (auto& i: queue) {
+            i.callback(error);
+        }
+    }
+
+    transaction_queue_stats transaction_queue::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto stats = _stats;
+        stats.queue_size = _queue.size();
+        return stats;
+    }
+
+} } } // golos::plugins::chain
@@ -106,9 +106,15 @@ public:
     std::vector<proposal_api_object> get_proposed_transactions(const std::string&, uint32_t, uint32_t) const;
 
     golos::chain::database& database() const {
-        return _db;
+        return lib_replica_db ? *lib_replica_db : _db;
     }
 
+    /**
+     * Calls the method on the copy of the state at the last irreversible block,
+     *   the result is returned with the number of the block of this state
+     */
+    fc::variant call_on_lib_replica(const std::function<fc::variant()>& call) const;
+
     // Callbacks
     block_applied_callback_info::cont active_block_applied_callback;
     block_applied_callback_info::cont free_block_applied_callback;
@@ -122,6 +128,9 @@ public:
 private:
     golos::chain::database& _db;
 
+    /// The replica of the state, which is read by the current thread instead of the main database
+    static thread_local golos::chain::database* lib_replica_db;
+
     uint32_t _block_virtual_ops_block_num = 0;
     block_operations _block_virtual_ops;
 };
@@ -147,6 +156,36 @@ plugin::api_impl::~api_impl() {
     elog("freeing database plugin ${x}", ("x", int64_t(this)));
 }
 
+thread_local golos::chain::database* plugin::api_impl::lib_replica_db = nullptr;
+
+fc::variant plugin::api_impl::call_on_lib_replica(const std::function<fc::variant()>& call) const {
+    auto replica = appbase::app().get_plugin<chain::plugin>().get_lib_replica();
+    FC_ASSERT(replica, "LIB replica is disabled, it can be enabled by the lib-replica option");
+
+    struct replica_scope final {
+        explicit replica_scope(golos::chain::database& db) {
+            lib_replica_db = &db;
+        }
+        ~replica_scope() {
+            lib_replica_db = nullptr;
+        }
+    } scope(replica->db());
+
+    // the replica can apply blocks between calls of the method, so the call is repeated
+    //   if the state was changed during it; after the last attempt the state isn't older than block_num
+    fc::variant result;
+    uint32_t block_num = 0;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        block_num = replica->head_block_num();
+        result = call();
+        if (block_num == replica->head_block_num()) {
+            break;
+        }
+    }
+
+    return fc::mutable_variant_object()("block_num", block_num)("result", std::move(result));
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Blocks and transactions                                          //
@@ -158,7 +197,11 @@ DEFINE_API(plugin, get_block_header) {
         (uint32_t, block_num)
     );
     return my->database().with_weak_read_lock([&]() {
-        return my->get_block_header(block_num);
+        auto result = my->get_block_header(block_num);
+        if (result && block_num <= my->database().get_dynamic_global_properties().last_irreversible_block_num) {
+            args.mark_immutable();
+        }
+        return result;
     });
 }
 
@@ -175,7 +218,11 @@ DEFINE_API(plugin, get_block) {
         (uint32_t, block_num)
     );
     return my->database().with_weak_read_lock([&]() {
-        return my->get_block(block_num);
+        auto result = my->get_block(block_num);
+        if (result && block_num <= my->database().get_dynamic_global_properties().last_irreversible_block_num) {
+            args.mark_immutable();
+        }
+        return result;
     });
 }
 
@@ -353,18 +400,19 @@ DEFINE_API(plugin, get_accounts) {
 }
 
 std::vector<account_api_object> plugin::api_impl::get_accounts(std::vector<std::string> names) const {
-    const auto &idx = _db.get_index<account_index>().indices().get<by_name>();
-    const auto &vidx = _db.get_index<witness_vote_index>().indices().get<by_account_witness>();
+    const auto &db = database();
+    const auto &idx = db.get_index<account_index>().indices().get<by_name>();
+    const auto &vidx = db.get_index<witness_vote_index>().indices().get<by_account_witness>();
     std::vector<account_api_object> results;
 
     for (auto name: names) {
         auto itr = idx.find(name);
         if (itr != idx.end()) {
-            results.push_back(account_api_object(*itr, _db));
-            follow::fill_account_reputation(_db, itr->name, results.back().reputation);
+            results.push_back(account_api_object(*itr, db));
+            follow::fill_account_reputation(db, itr->name, results.back().reputation);
             auto vitr = vidx.lower_bound(boost::make_tuple(itr->id, witness_id_type()));
             while (vitr != vidx.end() && vitr->account == itr->id) {
-                results.back().witness_votes.insert(_db.get(vitr->witness).owner);
+                results.back().witness_votes.insert(db.get(vitr->witness).owner);
                 ++vitr;
             }
         }
@@ -826,9 +874,46 @@ DEFINE_API(plugin, get_database_info) {
         info.index_list.push_back({(*it)->name(), (*it)->size()});
     }
 
+    info.flush = db.get_flush_stats();
+    info.recent_transactions = db.get_recent_transaction_cache_stats();
+
     return info;
 }
 
+DEFINE_API(plugin, get_signature_cache_stats) {
+    PLUGIN_API_VALIDATE_ARGS();
+    return golos::protocol::signature_cache::instance().get_stats();
+}
+
+DEFINE_API(plugin, get_transaction_queue_stats) {
+    PLUGIN_API_VALIDATE_ARGS();
+    return appbase::app().get_plugin<chain::plugin>().get_transaction_queue_stats();
+}
+
+DEFINE_API(plugin, get_apply_timing_stats) {
+    PLUGIN_API_VALIDATE_ARGS(
+        (bool, clear, false)
+    );
+    // the stats have their own lock, so the call doesn't wait for applying of blocks
+    auto& db = my->database();
+    if (!clear) {
+        return db.get_apply_timing_stats().get_info();
+    }
+    return db.clear_apply_timing_stats();
+}
+
+DEFINE_API(plugin, get_lock_stats) {
+    PLUGIN_API_VALIDATE_ARGS(
+        (bool, clear, false)
+    );
+    auto& db = my->database();
+    auto stats = db.get_lock_stats();
+    if (clear) {
+        db.clear_lock_stats();
+    }
+    return stats;
+}
+
 std::vector<proposal_api_object> plugin::api_impl::get_proposed_transactions(
     const std::string& a, uint32_t from, uint32_t limit
 ) const {
@@ -882,10 +967,39 @@ DEFINE_API(plugin, get_proposed_transactions) {
     });
 }
 
+void plugin::set_program_options(
+    boost::program_options::options_description& cli,
+    boost::program_options::options_description& cfg
+) {
+    cfg.add_options() (
+        "lib-replica-methods", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(),
+        "Methods of database_api, which are also available in database_api_lib. They read the state at "
+        "the last irreversible block from the replica of the chain plugin without the lock of the main database."
+    );
+}
+
 void plugin::plugin_initialize(const boost::program_options::variables_map& options) {
     ilog("database_api plugin: plugin_initialize() begin");
     my = std::make_unique<api_impl>();
     JSON_RPC_REGISTER_API(plugin_name)
+
+    if (options.count("lib-replica-methods")) {
+        auto& names = options.at("lib-replica-methods").as<std::vector<std::string>>();
+        std::set<std::string> lib_methods(names.begin(), names.end());
+        auto& rpc = appbase::app().get_plugin<json_rpc::plugin>();
+
+        for_each_api([&](plugin&, const std::string& method_name, auto method, auto*, auto*) {
+            if (!lib_methods.count(method_name)) {
+                return;
+            }
+            rpc.add_api_method(lib_api_name, method_name, [this, method](msg_pack& args) -> fc::variant {
+                return my->call_on_lib_replica([&]() {
+                    return fc::variant((this->*method)(args));
+                });
+            });
+        });
+    }
+
     auto& db = my->database();
     db.applied_block.connect([&](const signed_block&) {
         my->clear_outdated_callbacks(true);
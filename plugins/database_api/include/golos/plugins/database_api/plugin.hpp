@@ -18,6 +18,8 @@
 
 #include <golos/api/chain_api_properties.hpp>
 
+#include <golos/protocol/signature_cache.hpp>
+
 #include "forward.hpp"
 
 namespace golos { namespace plugins { namespace database_api {
@@ -43,6 +45,10 @@ struct database_info {
     std::size_t used_size;
 
     std::vector<database_index_info> index_list;
+
+    golos::chain::shared_memory_flush_stats flush;
+
+    golos::chain::recent_transaction_cache_stats recent_transactions;
 };
 
 struct scheduled_hardfork {
@@ -127,6 +133,10 @@ DEFINE_API_ARGS(get_potential_signatures,         msg_pack, std::set<public_key_
 DEFINE_API_ARGS(verify_authority,                 msg_pack, bool)
 DEFINE_API_ARGS(verify_account_authority,         msg_pack, bool)
 DEFINE_API_ARGS(get_database_info,                msg_pack, database_info)
+DEFINE_API_ARGS(get_signature_cache_stats,        msg_pack, signature_cache_stats)
+DEFINE_API_ARGS(get_apply_timing_stats,           msg_pack, apply_timing_info)
+DEFINE_API_ARGS(get_transaction_queue_stats,      msg_pack, chain::transaction_queue_stats)
+DEFINE_API_ARGS(get_lock_stats,                   msg_pack, std::vector<lock_stats_item>)
 DEFINE_API_ARGS(get_proposed_transactions,        msg_pack, std::vector<proposal_api_object>)
 
 
@@ -141,6 +151,9 @@ class plugin final : public appbase::plugin<plugin> {
 public:
     constexpr static const char* plugin_name = "database_api";
 
+    /// API with methods, which are listed in lib-replica-methods, they return {"block_num": ..., "result": ...}
+    constexpr static const char* lib_api_name = "database_api_lib";
+
     static const std::string& name() {
         static std::string name = plugin_name;
         return name;
@@ -151,7 +164,7 @@ public:
         (chain::plugin)
     )
 
-    void set_program_options(boost::program_options::options_description& cli, boost::program_options::options_description& cfg) override{}
+    void set_program_options(boost::program_options::options_description& cli, boost::program_options::options_description& cfg) override;
     void plugin_initialize(const boost::program_options::variables_map& options) override;
     void plugin_startup() override;
     void plugin_shutdown() override{}
@@ -317,6 +330,29 @@ public:
 
         (get_database_info)
 
+        /**
+         * @brief Retrieve hits and misses of the cache of keys recovered from transaction signatures
+         */
+        (get_signature_cache_stats)
+
+        /**
+         * @brief Retrieve counts and latency histograms of applied operations by types
+         *   and of steps of block applying since the start of the node
+         * @param clear optional, reset the stats after reading
+         */
+        (get_apply_timing_stats)
+
+        /**
+         * @brief Retrieve the depth of the queue of received transactions and sizes of batches pushed from it
+         */
+        (get_transaction_queue_stats)
+
+        /**
+         * @brief Retrieve wait and hold times of the database lock for API reads, p2p reads, block and transaction writes
+         * @param clear optional, reset the stats after reading
+         */
+        (get_lock_stats)
+
         (get_proposed_transactions)
     )
 
@@ -345,4 +381,4 @@ FC_REFLECT((golos::plugins::database_api::get_tags_used_by_author), (tags))
 FC_REFLECT((golos::plugins::database_api::signed_block_api_object), (block_id)(signing_key)(transaction_ids))
 
 FC_REFLECT((golos::plugins::database_api::database_index_info), (name)(record_count))
-FC_REFLECT((golos::plugins::database_api::database_info), (total_size)(free_size)(reserved_size)(used_size)(index_list))
+FC_REFLECT((golos::plugins::database_api::database_info), (total_size)(free_size)(reserved_size)(used_size)(index_list)(flush)(recent_transactions))
@@ -347,28 +347,27 @@ uint32_t plugin::plugin_impl::debug_push_blocks(
         }
 
         for( uint32_t i=0; i<count; i++ ) {
-            //fc::optional< chain::signed_block > block = log.read_block( log.get_block_pos( first_block + i ) );
-            uint64_t block_pos = log.get_block_pos( first_block + i );
-            if( block_pos == golos::chain::block_log::npos ) {
-                wlog( "Block database ${fn} only contained ${i} of ${n} requested blocks", ("i", i)("n", count)("fn", src_filename) );
-                return i ;
-            }
-
-            decltype( log.read_block(0) ) result;
+            fc::optional< golos::chain::signed_block > block;
 
             try {
-                result = log.read_block( block_pos );
+                // reads both the raw and the compressed formats
+                block = log.read_block_by_num( first_block + i );
             }
             catch( const fc::exception& e ) {
                 elog( "Could not read block ${i} of ${n}", ("i", i)("n", count) );
                 continue;
             }
 
+            if( !block ) {
+                wlog( "Block database ${fn} only contained ${i} of ${n} requested blocks", ("i", i)("n", count)("fn", src_filename) );
+                return i ;
+            }
+
             try{
-                database().push_block( result.first, skip_flags );
+                database().push_block( *block, skip_flags );
             }
             catch( const fc::exception& e ) {
-                elog( "Got exception pushing block ${bn} : ${bid} (${i} of ${n})", ("bn", result.first.block_num())("bid", result.first.id())("i", i)("n", count) );
+                elog( "Got exception pushing block ${bn} : ${bid} (${i} of ${n})", ("bn", block->block_num())("bid", block->id())("i", i)("n", count) );
                 elog( "Exception backtrace: ${bt}", ("bt", e.to_detail_string()) );
             }
         }
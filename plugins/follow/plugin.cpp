@@ -417,18 +417,23 @@ namespace golos {
                     auto& db = pimpl->database();
                     pimpl->plugin_initialize(*this);
 
-                    db.pre_apply_operation.connect([&](operation_notification& o) {
+                    auto pre_operation = [&](operation_notification& o) {
                         pimpl->pre_operation(o, *this);
-                    });
-                    db.post_apply_operation.connect([&](const operation_notification& o) {
+                    };
+                    auto post_operation = [&](const operation_notification& o) {
                         pimpl->post_operation(o, *this);
-                    });
-                    golos::chain::add_plugin_index<follow_index>(db);
-                    golos::chain::add_plugin_index<feed_index>(db);
-                    golos::chain::add_plugin_index<blog_index>(db);
-                    golos::chain::add_plugin_index<reputation_index>(db);
-                    golos::chain::add_plugin_index<follow_count_index>(db);
-                    golos::chain::add_plugin_index<blog_author_stats_index>(db);
+                    };
+                    db.pre_apply_operation.connect(pre_operation);
+                    db.post_apply_operation.connect(post_operation);
+
+                    // the state is built only from operations of transactions, so it can be reindexed
+                    db.add_reindexable_plugin(name(), {pre_operation, post_operation, nullptr});
+                    golos::chain::add_plugin_index<follow_index>(db, name());
+                    golos::chain::add_plugin_index<feed_index>(db, name());
+                    golos::chain::add_plugin_index<blog_index>(db, name());
+                    golos::chain::add_plugin_index<reputation_index>(db, name());
+                    golos::chain::add_plugin_index<follow_count_index>(db, name());
+                    golos::chain::add_plugin_index<blog_author_stats_index>(db, name());
 
                     if (options.count("follow-max-feed-size")) {
                         uint32_t feed_size = options["follow-max-feed-size"].as<uint32_t>();
@@ -2,6 +2,9 @@
 
 #include <appbase/application.hpp>
 #include <golos/plugins/json_rpc/utility.hpp>
+#include <golos/plugins/json_rpc/response_cache.hpp>
+#include <golos/plugins/json_rpc/rpc_stats.hpp>
+#include <golos/protocol/json_writer.hpp>
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
 #include <fc/reflect/variant.hpp>
@@ -56,6 +59,7 @@
 #define SERVER_MISSING_AUTHORITY     (-32004)   // tx_missing_authority
 #define SERVER_INVALID_OPERATION     (-32005)   // tx_invalid_operation (client must check inner exception)
 #define SERVER_INVALID_TRANSACTION   (-32006)   // transaction_exception
+#define SERVER_OVERLOADED            (-32007)   // request is rejected without execution, it can be repeated later
 
 namespace golos {
     namespace plugins {
@@ -89,6 +93,16 @@ namespace golos {
             public:
                 using response_handler_type = std::function<void (const std::string &)>;
 
+                /// Runs the task, possibly in other thread
+                using executor_type = std::function<void (std::function<void ()>)>;
+
+                /**
+                 * Starts the call of the method ("api.method") by run(), at once or later in other thread,
+                 *   or calls reject(), then the call is answered by the SERVER_OVERLOADED error.
+                 */
+                using call_scheduler_type = std::function<void (
+                    const std::string &method, std::function<void ()> run, std::function<void ()> reject)>;
+
                 plugin();
 
                 ~plugin();
@@ -96,8 +110,7 @@ namespace golos {
                 APPBASE_PLUGIN_REQUIRES();
 
                 void set_program_options(boost::program_options::options_description &,
-                                         boost::program_options::options_description &) override {
-                }
+                                         boost::program_options::options_description &) override;
 
                 static const std::string &name() {
                     static std::string name = STEEM_JSON_RPC_PLUGIN_NAME;
@@ -115,6 +128,27 @@ namespace golos {
 
                 void call(const string &body, response_handler_type);
 
+                /**
+                 * Calls of a batch are started by the executor, up to batch-parallelism calls at once.
+                 * The response is sent when all calls are finished, results are in the order of requests.
+                 */
+                void call(const string &body, response_handler_type, executor_type);
+
+                /// Maximum number of calls of one batch, which are executed at once, 1 - one after another
+                void set_batch_parallelism(uint32_t);
+
+                /// All calls are started by the scheduler, it should be set before start of the webserver
+                void set_call_scheduler(call_scheduler_type);
+
+                /// Answers the request by the SERVER_OVERLOADED error without parsing and execution
+                void reject(response_handler_type) const;
+
+                /// Statistics of the cache of responses for irreversible blocks
+                response_cache_stats get_response_cache_stats() const;
+
+                /// Latencies of calls by methods and the latest slow calls
+                rpc_stats_info get_rpc_stats() const;
+
             private:
                 class impl;
 
@@ -122,6 +156,22 @@ namespace golos {
             };
 
             namespace detail {
+                template<typename Ret>
+                typename std::enable_if<!golos::protocol::has_direct_json<Ret>::value, fc::variant>::type
+                make_api_result(msg_pack &, const Ret &ret) {
+                    return fc::variant(ret);
+                }
+
+                // Results of reflected API types are written to JSON without building of fc::variant
+                template<typename Ret>
+                typename std::enable_if<golos::protocol::has_direct_json<Ret>::value, fc::variant>::type
+                make_api_result(msg_pack &args, const Ret &ret) {
+                    if (args.valid()) {
+                        args.raw_result(golos::protocol::json_writer::to_string(ret));
+                    }
+                    return fc::variant();
+                }
+
                 class register_api_method_visitor {
                 public:
                     register_api_method_visitor(const std::string &api_name) : _api_name(api_name),
@@ -133,7 +183,7 @@ namespace golos {
                                     Ret *ret) {
                         _json_rpc_plugin.add_api_method(_api_name, method_name,
                                                         [&plugin, method](msg_pack &args) -> fc::variant {
-                                                            return fc::variant((plugin.*method)(args));
+                                                            return make_api_result(args, (plugin.*method)(args));
                                                         });
                         /*api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }*/ //);
                     }
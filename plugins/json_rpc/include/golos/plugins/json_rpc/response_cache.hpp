@@ -0,0 +1,68 @@
+#pragma once
+
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    struct response_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        double hit_ratio = 0;     ///< hits / (hits + misses)
+        uint64_t entries = 0;
+        uint64_t memory_usage = 0; ///< approximate size of cached responses with keys and the index
+        uint64_t max_memory = 0;
+        uint64_t evictions = 0;
+    };
+
+    /**
+     * Cache of serialized results of calls, which return the same data forever, like blocks below the last
+     * irreversible block. A method marks such result by msg_pack::mark_immutable(), only methods with marked
+     * results are looked up. The least recently used results are evicted, when the memory limit is reached.
+     */
+    class response_cache final {
+    public:
+        /// @param value 0 - the cache is disabled
+        void set_max_memory(uint64_t value);
+
+        bool enabled() const;
+
+        /// True if any result of the method was cached
+        bool is_cacheable(const std::string& method) const;
+
+        /// Finds the result by the key of the call, counts hits and misses
+        fc::optional<std::string> find(const std::string& key);
+
+        void add(const std::string& method, const std::string& key, const std::string& json);
+
+        response_cache_stats get_stats() const;
+
+    private:
+        using lru_list = std::list<std::pair<std::string, std::string>>;
+
+        static uint64_t entry_size(const std::string& key, const std::string& json);
+
+        void evict(uint64_t max_memory);
+
+        mutable std::mutex _mutex;
+        uint64_t _max_memory = 0;
+        uint64_t _memory_usage = 0;
+        uint64_t _hits = 0;
+        uint64_t _misses = 0;
+        uint64_t _evictions = 0;
+
+        lru_list _lru; ///< the most recently used is at the front
+        std::unordered_map<std::string, lru_list::iterator> _index;
+        std::unordered_set<std::string> _methods;
+    };
+
+} } } // golos::plugins::json_rpc
+
+FC_REFLECT((golos::plugins::json_rpc::response_cache_stats),
+    (hits)(misses)(hit_ratio)(entries)(memory_usage)(max_memory)(evictions))
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <golos/protocol/latency_stats.hpp>
+
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    using golos::protocol::latency_histogram;
+
+    /// Durations of steps of one call
+    struct call_timing {
+        fc::microseconds queue;         ///< waiting for a thread of the webserver
+        fc::microseconds lock;          ///< holding read locks of the database
+        fc::microseconds serialization; ///< writing the result to JSON
+        fc::microseconds total;         ///< from receiving of the call to passing of the response
+        bool is_error = false;
+    };
+
+    struct rpc_method_stats {
+        std::string method;
+        uint64_t errors = 0;
+        latency_histogram queue;
+        latency_histogram lock;
+        latency_histogram serialization;
+        latency_histogram total;
+    };
+
+    struct rpc_slow_call {
+        std::string method;
+        std::string params;
+        fc::time_point_sec time;
+        uint64_t queue_us = 0;
+        uint64_t lock_us = 0;
+        uint64_t serialization_us = 0;
+        uint64_t total_us = 0;
+    };
+
+    struct rpc_stats_info {
+        std::vector<rpc_method_stats> methods;
+        std::vector<rpc_slow_call> slow_calls; ///< the latest is the last
+    };
+
+    /**
+     * Counts and durations of calls by methods, and the list of the latest slow calls with their params.
+     * Calls are measured only if the stats or the slow call log are enabled.
+     */
+    class rpc_stats final {
+    public:
+        void set_enabled(bool value);
+
+        /// @param value 0 - slow calls aren't logged
+        void set_slow_call_threshold(const fc::microseconds& value);
+
+        /// True if calls should be measured
+        bool enabled() const {
+            return _is_measured;
+        }
+
+        void add(const std::string& method, const fc::optional<std::vector<fc::variant>>& args, const call_timing& timing);
+
+        rpc_stats_info get_info() const;
+
+    private:
+        static constexpr std::size_t max_slow_calls = 100;
+        static constexpr std::size_t max_params_size = 1024;
+
+        bool _is_enabled = false;
+        bool _is_measured = false;
+        fc::microseconds _slow_call_threshold;
+
+        mutable std::mutex _mutex;
+        std::map<std::string, rpc_method_stats> _methods;
+        std::deque<rpc_slow_call> _slow_calls;
+    };
+
+} } } // golos::plugins::json_rpc
+
+FC_REFLECT((golos::plugins::json_rpc::rpc_method_stats),
+    (method)(errors)(queue)(lock)(serialization)(total))
+
+FC_REFLECT((golos::plugins::json_rpc::rpc_slow_call),
+    (method)(params)(time)(queue_us)(lock_us)(serialization_us)(total_us))
+
+FC_REFLECT((golos::plugins::json_rpc::rpc_stats_info), (methods)(slow_calls))
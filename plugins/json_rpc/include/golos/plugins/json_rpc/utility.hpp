@@ -76,6 +76,17 @@ namespace golos { namespace plugins { namespace json_rpc {
 
                 fc::optional<fc::variant> result() const;
 
+                // Set the result already written to JSON, it is passed to remote connection by result()
+                void raw_result(std::string json);
+
+                fc::optional<std::string> raw_result() const;
+
+                // The result of the call never changes, for example, a block below the last irreversible block,
+                //   so it can be cached
+                void mark_immutable();
+
+                bool is_immutable() const;
+
                 // Pass error to remote connection
                 void error(int32_t code, std::string message, fc::optional<fc::variant> data = fc::optional<fc::variant>());
 
@@ -2,11 +2,15 @@
 #include <golos/plugins/json_rpc/utility.hpp>
 
 #include <golos/protocol/exceptions.hpp>
+#include <golos/protocol/latency_stats.hpp>
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+
 #include <fc/log/logger_config.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/string.hpp>
 #include <thirdparty/fc/vendor/websocketpp/websocketpp/error.hpp>
 #include <thirdparty/fc/include/fc/time.hpp>
 
@@ -31,6 +35,9 @@ namespace golos {
                 fc::optional<fc::variant> result;
                 fc::optional<json_rpc_error> error;
                 fc::variant id;
+
+                /// the result already written to JSON, it replaces the result on output, isn't reflected
+                fc::optional<std::string> raw_result;
             };
 
             struct msg_pack::impl final {
@@ -38,6 +45,7 @@ namespace golos {
 
                 json_rpc_response response;
                 handler_type handler;
+                bool is_immutable = false;
             };
 
             msg_pack::msg_pack() {
@@ -105,6 +113,28 @@ namespace golos {
                 }
             }
 
+            void msg_pack::raw_result(std::string json) {
+                // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
+                FC_ASSERT(valid(), "The msg_pack delegated its handlers");
+                pimpl->response.raw_result = std::move(json);
+            }
+
+            fc::optional<std::string> msg_pack::raw_result() const {
+                if (valid()) {
+                    return pimpl->response.raw_result;
+                }
+                return fc::optional<std::string>();
+            }
+
+            void msg_pack::mark_immutable() {
+                FC_ASSERT(valid(), "The msg_pack delegated its handlers");
+                pimpl->is_immutable = true;
+            }
+
+            bool msg_pack::is_immutable() const {
+                return valid() && pimpl->is_immutable;
+            }
+
             fc::optional<fc::variant> msg_pack::result() const {
                 // Pimpl can absent in case if msg_pack delegated its handlers to other msg_pack (see move constructor)
                 if (valid()) {
@@ -217,6 +247,7 @@ namespace golos {
                 }
 
                 void rpc_jsonrpc(const fc::variant &data, msg_pack &msg) {
+                    auto start = _rpc_stats.enabled() ? fc::time_point::now() : fc::time_point();
                     fc::variant_object request;
 
                     try {
@@ -244,11 +275,116 @@ namespace golos {
                         return;
                     }
 
+                    std::string method_name = msg.plugin + '.' + msg.method;
+                    std::string cache_key;
+                    if (_response_cache.is_cacheable(method_name)) {
+                        cache_key = method_name + fc::json::to_string(fc::variant(msg.args));
+                        auto cached = _response_cache.find(cache_key);
+                        if (cached.valid()) {
+                            msg.raw_result(std::move(*cached));
+                            msg.result(fc::variant());
+                            if (_rpc_stats.enabled()) {
+                                call_timing timing;
+                                timing.total = fc::time_point::now() - start;
+                                _rpc_stats.add(method_name, msg.args, timing);
+                            }
+                            return;
+                        }
+                    }
+
+                    if (!_call_scheduler) {
+                        return execute(*call, msg, method_name, std::move(cache_key), start, fc::time_point());
+                    }
+
+                    // the handlers are moved, so the call can be finished later in other thread
+                    auto delegated = std::make_shared<msg_pack>(std::move(msg));
+                    delegated->plugin = msg.plugin;
+                    delegated->method = msg.method;
+                    delegated->args = msg.args;
+
+                    auto queued = _rpc_stats.enabled() ? fc::time_point::now() : fc::time_point();
+                    _call_scheduler(method_name, [this, call, delegated, method_name, cache_key, start, queued]() {
+                        try {
+                            execute(*call, *delegated, method_name, cache_key, start, queued);
+                        } catch (const fc::exception& e) {
+                            if (delegated->valid()) {
+                                delegated->error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.to_string(), e);
+                            }
+                        } catch (const std::exception& e) {
+                            if (delegated->valid()) {
+                                delegated->error(JSON_RPC_INTERNAL_ERROR, std::string("Internal error: ") + e.what());
+                            }
+                        } catch (...) {
+                            if (delegated->valid()) {
+                                delegated->error(JSON_RPC_INTERNAL_ERROR, "Unknown error - calling of method failed");
+                            }
+                        }
+                    }, [delegated]() {
+                        if (delegated->valid()) {
+                            delegated->error(SERVER_OVERLOADED, "Server is overloaded, repeat the request later");
+                        }
+                    });
+                }
+
+                /// @param queued the time of scheduling of the call, empty if the call isn't scheduled
+                void execute(
+                    api_method &call, msg_pack &msg, const std::string &method_name, std::string cache_key,
+                    const fc::time_point &start, const fc::time_point &queued
+                ) {
+                    if (!_rpc_stats.enabled()) {
+                        call_method(call, msg, method_name, std::move(cache_key), nullptr);
+                        return;
+                    }
+
+                    call_timing timing;
+                    if (queued != fc::time_point()) {
+                        timing.queue = fc::time_point::now() - queued;
+                    }
+                    // params are kept in msg, even if the call moves its handlers
+                    try {
+                        golos::protocol::read_lock_timer lock_timer;
+                        timing.is_error = !call_method(call, msg, method_name, std::move(cache_key), &timing);
+                        timing.lock = lock_timer.elapsed();
+                    } catch (...) {
+                        timing.is_error = true;
+                        timing.total = fc::time_point::now() - start;
+                        _rpc_stats.add(method_name, msg.args, timing);
+                        throw;
+                    }
+                    timing.total = fc::time_point::now() - start;
+                    _rpc_stats.add(method_name, msg.args, timing);
+                }
+
+                /// @return false if the call failed with an error
+                bool call_method(
+                    api_method &call, msg_pack &msg, const std::string &method_name, std::string cache_key,
+                    call_timing *timing
+                ) {
                     try {
-                        auto result = (*call)(msg);
+                        auto result = call(msg);
                         if (msg.valid()) {
+                            bool is_cached = msg.is_immutable() && _response_cache.enabled();
+                            if (is_cached || timing != nullptr) {
+                                auto json = msg.raw_result();
+                                if (!json.valid()) {
+                                    auto serialization_start = fc::time_point::now();
+                                    json = fc::json::to_string(result);
+                                    result = fc::variant();
+                                    if (timing != nullptr) {
+                                        timing->serialization = fc::time_point::now() - serialization_start;
+                                    }
+                                }
+                                if (is_cached) {
+                                    if (cache_key.empty()) {
+                                        cache_key = method_name + fc::json::to_string(fc::variant(msg.args));
+                                    }
+                                    _response_cache.add(method_name, cache_key, *json);
+                                }
+                                msg.raw_result(std::move(*json));
+                            }
                             msg.result(std::move(result));
                         }
+                        return true;
                     } catch (const golos::unsupported_operation& e) {
                         msg.error(SERVER_UNSUPPORTED_OPERATION, e);
 
@@ -270,6 +406,36 @@ namespace golos {
                     } catch (const golos::golos_exception& e) {
                         msg.error(SERVER_INTERNAL_ERROR, e);
                     }
+                    return false;
+                }
+
+                static std::string to_json(const json_rpc_response &response) {
+                    if (!response.raw_result.valid() || response.error.valid()) {
+                        return fc::json::to_string(response);
+                    }
+
+                    // the envelope is written by fc, the null result is replaced with the written one
+                    static const std::string null_result = "\"result\":null";
+                    json_rpc_response envelope;
+                    envelope.result = fc::variant();
+                    envelope.id = response.id;
+                    auto json = fc::json::to_string(envelope);
+                    auto pos = json.find(null_result);
+                    FC_ASSERT(pos != std::string::npos, "Invalid JSON-RPC response envelope");
+                    json.replace(pos + null_result.size() - 4, 4, *response.raw_result);
+                    return json;
+                }
+
+                static std::string to_json(const vector<json_rpc_response> &responses) {
+                    std::string json = "[";
+                    for (const auto &response: responses) {
+                        if (json.size() > 1) {
+                            json += ',';
+                        }
+                        json += to_json(response);
+                    }
+                    json += ']';
+                    return json;
                 }
 
                 struct dump_rpc_time {
@@ -322,32 +488,64 @@ namespace golos {
                     }
                 }
 
-                void rpc(vector<fc::variant> messages, response_handler_type response_handler) {
-                    auto responses = std::make_shared<vector<json_rpc_response>>();
+                /**
+                 * State of a batch, which is shared by its calls.
+                 *
+                 * Each slot takes the next request and executes it, while calls return results synchronously.
+                 * If a call delegates its result to other thread (see msg_pack(msg_pack&&)), the slot continues
+                 * from the thread, which passes the result, so at most `parallelism` calls are in progress.
+                 */
+                struct batch_state final {
+                    batch_state(vector<fc::variant> m, response_handler_type h, executor_type e)
+                        : messages(std::move(m)), responses(messages.size()), remaining(messages.size()),
+                          response_handler(std::move(h)), executor(std::move(e)) {
+                    }
 
-                    responses->reserve(messages.size());
+                    const vector<fc::variant> messages;
+                    vector<json_rpc_response> responses;
+                    std::atomic<std::size_t> next{0};
+                    std::atomic<std::size_t> remaining;
+                    response_handler_type response_handler;
+                    executor_type executor;
+                };
 
-                    std::function<void()> next_handler = [response_handler, responses]{
-                        response_handler(fc::json::to_string(*responses.get()));
-                    };
+                void run_batch_slot(std::shared_ptr<batch_state> batch) {
+                    std::size_t i;
+                    while ((i = batch->next++) < batch->messages.size()) {
+                        // set by the first of two: the returned call or the result handler
+                        auto is_returned = std::make_shared<std::atomic<bool>>(false);
 
-                    for (auto it = messages.rbegin(); messages.rend() != it; ++it) {
-                        auto v = *it;
+                        msg_pack msg([this, batch, i, is_returned](json_rpc_response &response) {
+                            batch->responses[i] = response;
+                            if (--batch->remaining == 0) {
+                                batch->response_handler(to_json(batch->responses));
+                            }
+                            if (is_returned->exchange(true)) {
+                                // the call has returned before the result, so the slot continues here
+                                batch->executor([this, batch]{ run_batch_slot(batch); });
+                            }
+                        });
 
-                        next_handler = [next_handler, responses, v, this]{
-                            msg_pack msg([next_handler, responses](json_rpc_response &response){
-                                responses->push_back(response);
-                                next_handler();
-                            });
+                        this->rpc(batch->messages[i], msg);
 
-                            this->rpc(v, msg);
-                        };
+                        if (!is_returned->exchange(true)) {
+                            return; // the result will be passed later, the handler continues the slot
+                        }
                     }
+                }
 
-                    next_handler();
+                void rpc(vector<fc::variant> messages, response_handler_type response_handler, executor_type executor) {
+                    std::size_t slots = std::min<std::size_t>(messages.size(), _batch_parallelism);
+                    auto batch = std::make_shared<batch_state>(
+                        std::move(messages), std::move(response_handler), std::move(executor));
+
+                    for (std::size_t i = 1; i < slots; ++i) {
+                        batch->executor([this, batch]{ run_batch_slot(batch); });
+                    }
+                    run_batch_slot(batch);
                 }
 
-                void call(const string &message, response_handler_type response_handler) {
+                void call(const string &message, response_handler_type response_handler, executor_type executor) {
                     auto send_error = [response_handler](int32_t code, const std::string& msg, fc::optional<fc::variant> d = fc::optional<fc::variant>()) {
                         json_rpc_response response;
                         response.error = json_rpc_error(code, msg, d);
@@ -369,10 +567,10 @@ namespace golos {
                             if(messages.size() == 0) {
                                 return send_error(JSON_RPC_INVALID_REQUEST, "Array of requests must be non-empty");
                             }
-                            rpc(messages, response_handler);
+                            rpc(std::move(messages), response_handler, std::move(executor));
                         } else {
                             msg_pack msg([response_handler](json_rpc_response &response){
-                                    response_handler(fc::json::to_string(response));
+                                    response_handler(to_json(response));
                                     });
 
                             rpc(v, msg);
@@ -405,6 +603,10 @@ namespace golos {
 
                 map<string, api_description> _registered_apis;
                 vector<string> _methods;
+                uint32_t _batch_parallelism = 8;
+                response_cache _response_cache;
+                plugin::call_scheduler_type _call_scheduler;
+                rpc_stats _rpc_stats;
                 map<string, map<string, api_method_signature> > _method_sigs;
             private:
                 // This is a reindex which allows to get parent plugin by method
@@ -422,10 +624,48 @@ namespace golos {
             plugin::~plugin() {
             }
 
+            void plugin::set_program_options(boost::program_options::options_description &,
+                                             boost::program_options::options_description &cfg) {
+                cfg.add_options()
+                    ("json-rpc-batch-parallelism", boost::program_options::value<uint32_t>()->default_value(8),
+                        "Maximum number of calls of one batch request, which are executed at once "
+                        "by the webserver thread pool. 1 - calls are executed one after another. Default: 8")
+                    ("json-rpc-response-cache-size", boost::program_options::value<std::string>()->default_value("64M"),
+                        "Maximum memory for cached responses of calls for irreversible blocks. 0 - disable the cache. "
+                        "Default: 64M")
+                    ("json-rpc-stats", boost::program_options::value<bool>()->default_value(false),
+                        "Count latency histograms of calls by methods: time in the queue, under the read lock, "
+                        "of serialization and total. Default: false")
+                    ("json-rpc-slow-call-ms", boost::program_options::value<uint32_t>()->default_value(0),
+                        "Log calls, which take longer, with their params. 0 - disable. Default: 0");
+            }
+
             void plugin::plugin_initialize(const boost::program_options::variables_map &options) {
                 ilog("json_rpc plugin: plugin_initialize() begin");
                 pimpl = std::make_unique<impl>();
                 pimpl->initialize();
+                if (options.count("json-rpc-batch-parallelism")) {
+                    set_batch_parallelism(options.at("json-rpc-batch-parallelism").as<uint32_t>());
+                }
+                if (options.count("json-rpc-response-cache-size")) {
+                    auto size = fc::parse_size(options.at("json-rpc-response-cache-size").as<std::string>());
+                    pimpl->_response_cache.set_max_memory(size);
+                } else {
+                    pimpl->_response_cache.set_max_memory(64 * 1024 * 1024);
+                }
+                if (options.count("json-rpc-stats")) {
+                    pimpl->_rpc_stats.set_enabled(options.at("json-rpc-stats").as<bool>());
+                }
+                if (options.count("json-rpc-slow-call-ms")) {
+                    pimpl->_rpc_stats.set_slow_call_threshold(
+                        fc::milliseconds(options.at("json-rpc-slow-call-ms").as<uint32_t>()));
+                }
+                add_api_method("json_rpc", "get_response_cache_stats", [this](msg_pack &) -> fc::variant {
+                    return fc::variant(get_response_cache_stats());
+                });
+                add_api_method("json_rpc", "get_rpc_stats", [this](msg_pack &) -> fc::variant {
+                    return fc::variant(get_rpc_stats());
+                });
                 ilog("json_rpc plugin: plugin_initialize() end");
             }
 
@@ -447,7 +687,36 @@ namespace golos {
             }
 
             void plugin::call(const string &message, response_handler_type response_handler) {
-                pimpl->call(message, response_handler);
+                pimpl->call(message, response_handler, [](std::function<void ()> task) {
+                    task();
+                });
+            }
+
+            void plugin::call(const string &message, response_handler_type response_handler, executor_type executor) {
+                pimpl->call(message, response_handler, std::move(executor));
+            }
+
+            void plugin::set_batch_parallelism(uint32_t value) {
+                FC_ASSERT(value > 0, "json-rpc-batch-parallelism must be greater than 0");
+                pimpl->_batch_parallelism = value;
+            }
+
+            void plugin::set_call_scheduler(call_scheduler_type scheduler) {
+                pimpl->_call_scheduler = std::move(scheduler);
+            }
+
+            void plugin::reject(response_handler_type response_handler) const {
+                json_rpc_response response;
+                response.error = json_rpc_error(SERVER_OVERLOADED, "Server is overloaded, repeat the request later");
+                response_handler(fc::json::to_string(response));
+            }
+
+            response_cache_stats plugin::get_response_cache_stats() const {
+                return pimpl->_response_cache.get_stats();
+            }
+
+            rpc_stats_info plugin::get_rpc_stats() const {
+                return pimpl->_rpc_stats.get_info();
             }
         }
     }
@@ -0,0 +1,81 @@
+#include <golos/plugins/json_rpc/response_cache.hpp>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    void response_cache::set_max_memory(uint64_t value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _max_memory = value;
+        evict(_max_memory);
+        if (!_max_memory) {
+            _methods.clear();
+        }
+    }
+
+    bool response_cache::enabled() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _max_memory != 0;
+    }
+
+    bool response_cache::is_cacheable(const std::string& method) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _methods.count(method) != 0;
+    }
+
+    fc::optional<std::string> response_cache::find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto itr = _index.find(key);
+        if (itr == _index.end()) {
+            ++_misses;
+            return {};
+        }
+        ++_hits;
+        _lru.splice(_lru.begin(), _lru, itr->second);
+        return itr->second->second;
+    }
+
+    void response_cache::add(const std::string& method, const std::string& key, const std::string& json) {
+        auto size = entry_size(key, json);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (size > _max_memory || _index.count(key)) {
+            return;
+        }
+        _methods.insert(method);
+
+        evict(_max_memory - size);
+        _lru.emplace_front(key, json);
+        _index.emplace(key, _lru.begin());
+        _memory_usage += size;
+    }
+
+    response_cache_stats response_cache::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        response_cache_stats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        if (_hits + _misses) {
+            stats.hit_ratio = double(_hits) / double(_hits + _misses);
+        }
+        stats.entries = _index.size();
+        stats.memory_usage = _memory_usage;
+        stats.max_memory = _max_memory;
+        stats.evictions = _evictions;
+        return stats;
+    }
+
+    uint64_t response_cache::entry_size(const std::string& key, const std::string& json) {
+        // the key is stored twice: in the list and in the index, nodes of both take about 64 bytes
+        return key.size() * 2 + json.size() + 64;
+    }
+
+    void response_cache::evict(uint64_t max_memory) {
+        while (_memory_usage > max_memory && !_lru.empty()) {
+            auto& last = _lru.back();
+            _memory_usage -= entry_size(last.first, last.second);
+            _index.erase(last.first);
+            _lru.pop_back();
+            ++_evictions;
+        }
+    }
+
+} } } // golos::plugins::json_rpc
@@ -0,0 +1,74 @@
+#include <golos/plugins/json_rpc/rpc_stats.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+
+namespace golos { namespace plugins { namespace json_rpc {
+
+    void rpc_stats::set_enabled(bool value) {
+        _is_enabled = value;
+        _is_measured = _is_enabled || _slow_call_threshold.count();
+    }
+
+    void rpc_stats::set_slow_call_threshold(const fc::microseconds& value) {
+        _slow_call_threshold = value;
+        _is_measured = _is_enabled || _slow_call_threshold.count();
+    }
+
+    void rpc_stats::add(
+        const std::string& method, const fc::optional<std::vector<fc::variant>>& args, const call_timing& timing
+    ) {
+        bool is_slow = _slow_call_threshold.count() && timing.total >= _slow_call_threshold;
+
+        rpc_slow_call slow_call;
+        if (is_slow) {
+            slow_call.method = method;
+            slow_call.params = fc::json::to_string(fc::variant(args));
+            if (slow_call.params.size() > max_params_size) {
+                slow_call.params.resize(max_params_size);
+                slow_call.params += "...";
+            }
+            slow_call.time = fc::time_point::now();
+            slow_call.queue_us = timing.queue.count();
+            slow_call.lock_us = timing.lock.count();
+            slow_call.serialization_us = timing.serialization.count();
+            slow_call.total_us = timing.total.count();
+
+            wlog("Slow call ${method}: total ${total} us, queue ${queue} us, lock ${lock} us, "
+                "serialization ${serialization} us, params: ${params}",
+                ("method", method)("total", slow_call.total_us)("queue", slow_call.queue_us)
+                ("lock", slow_call.lock_us)("serialization", slow_call.serialization_us)
+                ("params", slow_call.params));
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_is_enabled) {
+            auto& stats = _methods[method];
+            if (timing.is_error) {
+                ++stats.errors;
+            }
+            stats.queue.add(timing.queue);
+            stats.lock.add(timing.lock);
+            stats.serialization.add(timing.serialization);
+            stats.total.add(timing.total);
+        }
+        if (is_slow) {
+            _slow_calls.push_back(std::move(slow_call));
+            if (_slow_calls.size() > max_slow_calls) {
+                _slow_calls.pop_front();
+            }
+        }
+    }
+
+    rpc_stats_info rpc_stats::get_info() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        rpc_stats_info info;
+        for (const auto& itr: _methods) {
+            info.methods.push_back(itr.second);
+            info.methods.back().method = itr.first;
+        }
+        info.slow_calls.assign(_slow_calls.begin(), _slow_calls.end());
+        return info;
+    }
+
+} } } // golos::plugins::json_rpc
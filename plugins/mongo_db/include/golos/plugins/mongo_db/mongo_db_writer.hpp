@@ -50,9 +50,14 @@ namespace mongo_db {
         void on_block(const signed_block& block);
         void on_operation(const golos::chain::operation_notification& note);
 
+        /// Processes the whole block with its virtual operations, the state is read at the moment of call
+        void on_batch(const golos::chain::operation_batch& batch);
+
     private:
         using operations = std::vector<operation>;
 
+        void add_block(const signed_block& block, uint32_t last_irreversible);
+
         void write_blocks();
         void write_raw_block(const signed_block& block, const operations&);
         void write_block_operations(state_writer& st_writer, const signed_block& block, const operations&);
@@ -1,6 +1,7 @@
 #include <golos/plugins/mongo_db/mongo_db_plugin.hpp>
 #include <golos/plugins/chain/plugin.hpp>
 #include <golos/protocol/block.hpp>
+#include <golos/chain/operation_batch_worker.hpp>
 
 #include <golos/plugins/mongo_db/mongo_db_writer.hpp>
 
@@ -34,11 +35,17 @@ namespace mongo_db {
             }
         }
 
+        void on_batch(const golos::chain::operation_batch& batch) {
+            writer.on_batch(batch);
+        }
+
         golos::chain::database &database() const {
             return db_;
         }
 
         mongo_db_writer writer;
+        std::unique_ptr<golos::chain::operation_batch_worker> worker;
+        uint32_t max_lag_blocks = 0;
         mongo_db_plugin &pimpl_;
 
         golos::chain::database &db_;
@@ -70,7 +77,14 @@ namespace mongo_db {
              "Mode of storing global_property_object history for each N block")
             ("mongodb-store-wso-history",
              boost::program_options::value<unsigned int>()->default_value(100),
-             "Mode of storing witness_schedule_object history for each N block");
+             "Mode of storing witness_schedule_object history for each N block")
+            ("mongodb-batched-notifications",
+             boost::program_options::value<bool>()->default_value(false),
+             "Receive operations of block in one batch after applying and write them in own thread")
+            ("mongodb-max-lag-blocks",
+             boost::program_options::value<uint32_t>()->default_value(100),
+             "Max number of blocks waiting for the thread of batched notifications, "
+             "after that they are written in the thread of applying blocks");
     }
 
     void mongo_db_plugin::plugin_initialize(const boost::program_options::variables_map &options) {
@@ -93,6 +107,10 @@ namespace mongo_db {
             if (options.count("mongodb-store-wso-history")) {
                 store_history_wso = options.at("mongodb-store-wso-history").as<unsigned int>();
             }
+            bool batched_notifications = false;
+            if (options.count("mongodb-batched-notifications")) {
+                batched_notifications = options.at("mongodb-batched-notifications").as<bool>();
+            }
 
             // First init mongo db
             if (options.count("mongodb-uri")) {
@@ -109,13 +127,26 @@ namespace mongo_db {
                 // Set applied block listener
                 auto &db = pimpl_->database();
 
-                db.applied_block.connect([&](const signed_block &b) {
-                    pimpl_->on_block(b);
-                });
-
-                db.post_apply_operation.connect([&](const operation_notification &o) {
-                    pimpl_->on_operation(o);
-                });
+                if (batched_notifications) {
+                    // dgp and wso history are read at the moment of processing of the batch
+                    pimpl_->max_lag_blocks = options.at("mongodb-max-lag-blocks").as<uint32_t>();
+                    pimpl_->worker = std::make_unique<golos::chain::operation_batch_worker>(
+                        db, "mongo_db", [&](const golos::chain::operation_batch &b) {
+                            pimpl_->on_batch(b);
+                        });
+
+                    db.applied_operation_batch.connect([&](const golos::chain::operation_batch_ptr &b) {
+                        pimpl_->worker->push(b);
+                    });
+                } else {
+                    db.applied_block.connect([&](const signed_block &b) {
+                        pimpl_->on_block(b);
+                    });
+
+                    db.post_apply_operation.connect([&](const operation_notification &o) {
+                        pimpl_->on_operation(o);
+                    });
+                }
 
             } else {
                 ilog("Mongo plugin configured, but no mongodb-uri specified. Plugin disabled.");
@@ -128,12 +159,22 @@ namespace mongo_db {
     void mongo_db_plugin::plugin_startup() {
         ilog("mongo_db plugin: plugin_startup() begin");
 
+        if (pimpl_ && pimpl_->worker) {
+            pimpl_->worker->start(pimpl_->max_lag_blocks);
+        }
+
         ilog("mongo_db plugin: plugin_startup() end");
     }
 
     void mongo_db_plugin::plugin_shutdown() {
         ilog("mongo_db plugin: plugin_shutdown() begin");
 
+        if (pimpl_ && pimpl_->worker) {
+            pimpl_->worker->stop();
+            ilog("mongo_db plugin: ${n} batches processed, ${d} times processed in applying thread",
+                ("n", pimpl_->worker->processed_batches())("d", pimpl_->worker->sync_drains()));
+        }
+
         ilog("mongo_db plugin: plugin_shutdown() end");
     }
 
@@ -70,6 +70,26 @@ namespace mongo_db {
     }    
 
     void mongo_db_writer::on_block(const signed_block& block) {
+        add_block(block, _db.last_non_undoable_block_num());
+    }
+
+    void mongo_db_writer::on_batch(const golos::chain::operation_batch& batch) {
+        auto block_num = batch.block->block_num();
+
+        // the block can be applied again after the fork switching
+        virtual_ops.erase(virtual_ops.lower_bound(block_num), virtual_ops.end());
+
+        auto& ops = virtual_ops[block_num];
+        for (const auto& note : batch.operations) {
+            if (is_virtual_operation(note.op)) {
+                ops.push_back(note.op);
+            }
+        }
+
+        add_block(*batch.block, batch.last_irreversible_block_num);
+    }
+
+    void mongo_db_writer::add_block(const signed_block& block, uint32_t last_irreversible) {
 
         try {
 
@@ -79,7 +99,7 @@ namespace mongo_db {
             wso_s[block.block_num()] = _db.get_witness_schedule_object();
 
             // Update last irreversible block number
-            last_irreversible_block_num = _db.last_non_undoable_block_num();
+            last_irreversible_block_num = last_irreversible;
             if (last_irreversible_block_num >= blocks.begin()->first) {
 
                 db_map all_docs;
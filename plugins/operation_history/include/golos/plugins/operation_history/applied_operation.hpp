@@ -1,6 +1,7 @@
 #pragma once
 
 #include <golos/protocol/operations.hpp>
+#include <golos/protocol/json_writer.hpp>
 #include <golos/chain/steem_object_types.hpp>
 #include <golos/plugins/operation_history/history_object.hpp>
 
@@ -25,3 +26,5 @@ namespace golos { namespace plugins { namespace operation_history {
 FC_REFLECT(
     (golos::plugins::operation_history::applied_operation),
     (trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(op))
+
+GOLOS_JSON_DIRECT_SERIALIZATION(golos::plugins::operation_history::applied_operation)
@@ -201,7 +201,14 @@ namespace golos { namespace plugins { namespace operation_history {
             (bool,     only_virtual)
         );
         return pimpl->database.with_weak_read_lock([&](){
-            return pimpl->get_ops_in_block(block_num, only_virtual);
+            auto result = pimpl->get_ops_in_block(block_num, only_virtual);
+            // old operations are removed when history-blocks is set, so the result can change
+            if (pimpl->history_blocks == UINT32_MAX &&
+                block_num <= pimpl->database.get_dynamic_global_properties().last_irreversible_block_num
+            ) {
+                args.mark_immutable();
+            }
+            return result;
         });
     }
 
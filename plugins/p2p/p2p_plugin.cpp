@@ -52,6 +52,8 @@ namespace golos {
 
                     virtual bool handle_block(const block_message &, bool, std::vector<fc::uint160_t> &) override;
 
+                    virtual void prevalidate_block(const block_message &) override;
+
                     virtual void handle_transaction(const trx_message &) override;
 
                     virtual void handle_message(const message &) override;
@@ -83,6 +85,15 @@ namespace golos {
                     //    return STEEMIT_BLOCK_INTERVAL;
                     //}
 
+                    using irreversible_block_handler =
+                        std::function<void(const char*, std::size_t, const signed_block_header&)>;
+
+                    /**
+                     * Reads the packed irreversible block from block_log, only its header is deserialized.
+                     * Returns false if the block isn't in block_log.
+                     */
+                    bool read_irreversible_block(const item_hash_t &, const irreversible_block_handler &);
+
 
                     fc::optional<fc::ip::endpoint> endpoint;
                     vector<fc::ip::endpoint> seeds;
@@ -108,7 +119,12 @@ namespace golos {
                                 return chain.db().is_known_transaction(id.item_hash);
                             }
                         } FC_CAPTURE_LOG_AND_RETHROW((id))
-                    });
+                    }, golos::chain::lock_source::p2p_read);
+                }
+
+                void p2p_plugin_impl::prevalidate_block(const block_message &blk_msg) {
+                    // signatures are checked only if blocks are accepted with skip_nothing, see handle_block()
+                    chain.prevalidate_block(blk_msg.block, blk_msg.block_id, block_producer | force_validate);
                 }
 
                 bool p2p_plugin_impl::handle_block(const block_message &blk_msg, bool sync_mode, std::vector<fc::uint160_t> &) {
@@ -116,7 +132,7 @@ namespace golos {
                         uint32_t head_block_num;
                         chain.db().with_weak_read_lock([&]() {
                             head_block_num = chain.db().head_block_num();
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                         if (sync_mode)
                             fc_ilog(fc::logger::get("sync"),
                                     "chain pushing sync block #${block_num} ${block_hash}, head is ${head}",
@@ -222,13 +238,47 @@ namespace golos {
                             }
 
                             return result;
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                     } FC_CAPTURE_AND_RETHROW((blockchain_synopsis)(remaining_item_count)(limit))
                 }
 
+                bool p2p_plugin_impl::read_irreversible_block(
+                    const item_hash_t &block_id, const irreversible_block_handler &handler
+                ) {
+                    bool result = false;
+                    auto block_num = block_header::num_from_id(block_id);
+                    chain.db().get_block_log().read_block_data_by_num(block_num, [&](const char *data, std::size_t size) {
+                        fc::datastream<const char *> ds(data, size);
+                        signed_block_header header;
+                        fc::raw::unpack(ds, header);
+                        // the peer can request a block from another fork
+                        if (header.id() == block_id) {
+                            handler(data, size, header);
+                            result = true;
+                        }
+                    });
+                    return result;
+                }
+
                 message p2p_plugin_impl::get_item(const item_id &id) {
                     try {
                         if (id.item_type == network::block_message_type) {
+                            // block_message is the packed block followed by its id,
+                            //   so irreversible blocks are served without repacking
+                            message result;
+                            auto found = read_irreversible_block(id.item_hash,
+                                [&](const char *data, std::size_t size, const signed_block_header &) {
+                                    auto packed_id = fc::raw::pack(block_id_type(id.item_hash));
+                                    result.msg_type = block_message::type;
+                                    result.data.reserve(size + packed_id.size());
+                                    result.data.insert(result.data.end(), data, data + size);
+                                    result.data.insert(result.data.end(), packed_id.begin(), packed_id.end());
+                                    result.size = (uint32_t)result.data.size();
+                                });
+                            if (found) {
+                                return result;
+                            }
+
                             return chain.db().with_weak_read_lock([&]() {
                                 auto opt_block = chain.db().fetch_block_by_id(id.item_hash);
                                 if (!opt_block)
@@ -238,11 +288,11 @@ namespace golos {
                                 FC_ASSERT(opt_block.valid());
                                 // ilog("Serving up block #${num}", ("num", opt_block->block_num()));
                                 return block_message(std::move(*opt_block));
-                            });
+                            }, golos::chain::lock_source::p2p_read);
                         }
                         return chain.db().with_weak_read_lock([&]() {
                             return trx_message(chain.db().get_recent_transaction(id.item_hash));
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                     } FC_CAPTURE_AND_RETHROW((id))
                 }
 
@@ -360,7 +410,7 @@ namespace golos {
 
                             //idump((synopsis));
                             return;
-                        });
+                        }, golos::chain::lock_source::p2p_read);
 
                         return synopsis;
                     } FC_LOG_AND_RETHROW()
@@ -382,13 +432,22 @@ namespace golos {
 
                 fc::time_point_sec p2p_plugin_impl::get_block_time(const item_hash_t &block_id) {
                     try {
+                        fc::time_point_sec result;
+                        auto found = read_irreversible_block(block_id,
+                            [&](const char *, std::size_t, const signed_block_header &header) {
+                                result = header.timestamp;
+                            });
+                        if (found) {
+                            return result;
+                        }
+
                         return chain.db().with_weak_read_lock([&]() {
                             auto opt_block = chain.db().fetch_block_by_id(block_id);
                             if (opt_block.valid()) {
                                 return opt_block->timestamp;
                             }
                             return fc::time_point_sec::min();
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                     } FC_CAPTURE_AND_RETHROW((block_id))
                 }
 
@@ -396,7 +455,7 @@ namespace golos {
                     try {
                         return chain.db().with_weak_read_lock([&]() {
                             return chain.db().head_block_id();
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                     } FC_CAPTURE_AND_RETHROW()
                 }
 
@@ -420,7 +479,7 @@ namespace golos {
                             uint32_t block_num = block_header::num_from_id(block_id);
                             block_id_type block_id_in_preferred_chain = chain.db().get_block_id_for_num(block_num);
                             return block_id == block_id_in_preferred_chain;
-                        });
+                        }, golos::chain::lock_source::p2p_read);
                     } FC_CAPTURE_AND_RETHROW()
                 }
 
@@ -527,7 +586,7 @@ namespace golos {
                     block_id_type block_id;
                     my->chain.db().with_weak_read_lock([&]() {
                         block_id = my->chain.db().head_block_id();
-                    });
+                    }, golos::chain::lock_source::p2p_read);
                     my->node->sync_from(item_id(golos::network::block_message_type, block_id),
                                         std::vector<uint32_t>());
                     ilog("P2P node listening at ${ep}", ("ep", my->node->get_actual_listening_endpoint()));
@@ -29,6 +29,21 @@ get_raw_block_r plugin::plugin_impl::get_raw_block(uint32_t block_num) {
     get_raw_block_r result;
     const auto &db = database();
 
+    // irreversible blocks are served as they are stored in block_log, without repacking
+    bool is_irreversible = db.get_block_log().read_block_data_by_num(block_num, [&](const char* data, std::size_t size) {
+        fc::datastream<const char*> ds(data, size);
+        golos::protocol::signed_block_header header;
+        fc::raw::unpack(ds, header);
+
+        result.raw_block = fc::base64_encode(reinterpret_cast<const unsigned char*>(data), size);
+        result.block_id = header.id();
+        result.previous = header.previous;
+        result.timestamp = header.timestamp;
+    });
+    if (is_irreversible) {
+        return result;
+    }
+
     auto block = db.fetch_block_by_number(block_num);
     if (!block.valid()) {
         return result;
@@ -52,7 +67,12 @@ DEFINE_API ( plugin, get_raw_block ) {
     );
     auto &db = my->database();
     return db.with_weak_read_lock([&]() {
-        return my->get_raw_block(block_num);
+        auto result = my->get_raw_block(block_num);
+        // 0 is the head block
+        if (block_num != 0 && block_num <= db.get_dynamic_global_properties().last_irreversible_block_num) {
+            args.mark_immutable();
+        }
+        return result;
     });
 }
 
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <fc/time.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golos { namespace plugins { namespace webserver {
+
+    struct request_class_stats {
+        std::string name;
+        uint32_t limit = 0;     ///< 0 - unlimited
+        uint32_t running = 0;
+        uint64_t queued = 0;
+        uint64_t rejected = 0;
+    };
+
+    struct request_queue_stats {
+        uint64_t queue_size = 0;        ///< requests and calls waiting for a thread
+        uint32_t max_queue_size = 0;    ///< 0 - unlimited
+        uint64_t max_wait_ms = 0;       ///< timeout of waiting in the queue, 0 - unlimited
+        uint64_t accepted = 0;          ///< started requests and calls
+        uint64_t rejected_queue_full = 0;
+        uint64_t rejected_timeout = 0;
+        std::vector<request_class_stats> classes;
+    };
+
+    /**
+     * Admission control of the webserver thread pool.
+     *
+     * Requests from connections wait for a thread in the bounded queue. Calls of methods are grouped
+     *   into classes by their names ("api.method" or all methods of the api - "api.*"), and each class has
+     *   its limit of calls running at once, so expensive calls can't occupy all threads. A call is started
+     *   in the current thread if its class isn't saturated, otherwise it waits in the queue.
+     *
+     * When the queue is full, or a request waited longer than the timeout, it is rejected without execution.
+     */
+    class request_queue final {
+    public:
+        using task_type = std::function<void ()>;
+
+        /// @param post posts the task to the thread pool
+        explicit request_queue(std::function<void (task_type)> post);
+
+        /// @param value 0 - unlimited
+        void set_max_size(uint32_t value);
+
+        /// @param value 0 - requests wait until a thread is free
+        void set_timeout(fc::microseconds value);
+
+        /// @param name "api.method" or "api.*"
+        void set_limit(const std::string& name, uint32_t limit);
+
+        /// Parses the limit in form "api.method=limit"
+        void set_limit(const std::string& option);
+
+        /// Request from a connection, it is started by the thread pool
+        void push(task_type run, task_type reject);
+
+        /// Call of the method ("api.method"), it is started at once if the limit of its class allows
+        void call(const std::string& method, task_type run, task_type reject);
+
+        request_queue_stats get_stats() const;
+
+    private:
+        struct item final {
+            fc::time_point time;
+            task_type run;
+            task_type reject;
+        };
+
+        struct request_class final {
+            std::string name;
+            uint32_t limit = 0;
+            uint32_t running = 0;
+            uint64_t rejected = 0;
+            std::deque<item> items;
+
+            bool is_saturated() const {
+                return limit && running >= limit;
+            }
+        };
+
+        request_class& get_class(const std::string& method);
+
+        /// Adds the item under the lock, false if the queue is full
+        bool enqueue(request_class& cls, task_type& run, task_type& reject);
+
+        /// Rejects outdated items and starts the oldest item, which class isn't saturated
+        void dispatch();
+
+        void execute(request_class& cls, const task_type& run);
+
+        void finish(request_class& cls);
+
+        std::function<void (task_type)> _post;
+
+        mutable std::mutex _mutex;
+        uint32_t _max_size = 0;
+        fc::microseconds _timeout;
+        uint64_t _size = 0;
+        uint64_t _accepted = 0;
+        uint64_t _rejected_queue_full = 0;
+        uint64_t _rejected_timeout = 0;
+
+        /// the first is the default class of requests and calls without limits
+        std::vector<std::unique_ptr<request_class>> _classes;
+        std::map<std::string, request_class*> _names;
+    };
+
+} } } // golos::plugins::webserver
+
+FC_REFLECT((golos::plugins::webserver::request_class_stats),
+    (name)(limit)(running)(queued)(rejected))
+
+FC_REFLECT((golos::plugins::webserver::request_queue_stats),
+    (queue_size)(max_queue_size)(max_wait_ms)(accepted)(rejected_queue_full)(rejected_timeout)(classes))
@@ -3,6 +3,7 @@
 #include <appbase/application.hpp>
 
 #include <golos/plugins/json_rpc/plugin.hpp>
+#include <golos/plugins/webserver/request_queue.hpp>
 
 #include <boost/thread.hpp>
 #include <boost/container/vector.hpp>
@@ -44,6 +45,9 @@ namespace golos {
 
                 void set_program_options(boost::program_options::options_description &, boost::program_options::options_description &cfg) override;
 
+                /// Queue depth, running calls and rejections of the thread pool
+                request_queue_stats get_queue_stats() const;
+
             protected:
                 void plugin_initialize(const boost::program_options::variables_map &options) override;
 
@@ -0,0 +1,217 @@
+#include <golos/plugins/webserver/request_queue.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+namespace golos { namespace plugins { namespace webserver {
+
+    request_queue::request_queue(std::function<void (task_type)> post)
+            : _post(std::move(post)) {
+        _classes.emplace_back(new request_class());
+        _classes.front()->name = "*";
+    }
+
+    void request_queue::set_max_size(uint32_t value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _max_size = value;
+    }
+
+    void request_queue::set_timeout(fc::microseconds value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _timeout = value;
+    }
+
+    void request_queue::set_limit(const std::string& name, uint32_t limit) {
+        FC_ASSERT(name.find('.') != std::string::npos, "Method should be in form api.method or api.*: ${n}", ("n", name));
+        FC_ASSERT(limit > 0, "Limit of ${n} should be greater than 0", ("n", name));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto itr = _names.find(name);
+        if (itr != _names.end()) {
+            itr->second->limit = limit;
+            return;
+        }
+        _classes.emplace_back(new request_class());
+        auto& cls = *_classes.back();
+        cls.name = name;
+        cls.limit = limit;
+        _names.emplace(name, &cls);
+    }
+
+    void request_queue::set_limit(const std::string& option) {
+        std::vector<std::string> parts;
+        boost::split(parts, option, boost::is_any_of("="));
+        FC_ASSERT(parts.size() == 2, "Limit should be in form api.method=limit: ${o}", ("o", option));
+        boost::trim(parts[0]);
+        boost::trim(parts[1]);
+        uint32_t limit = 0;
+        try {
+            limit = uint32_t(std::stoul(parts[1]));
+        } catch (const std::exception&) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception, "Invalid limit in ${o}", ("o", option));
+        }
+        set_limit(parts[0], limit);
+    }
+
+    void request_queue::push(task_type run, task_type reject) {
+        bool is_queued;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            is_queued = enqueue(*_classes.front(), run, reject);
+            if (!is_queued) {
+                ++_classes.front()->rejected;
+                ++_rejected_queue_full;
+            }
+        }
+
+        if (is_queued) {
+            _post([this]{ dispatch(); });
+        } else {
+            reject();
+        }
+    }
+
+    void request_queue::call(const std::string& method, task_type run, task_type reject) {
+        request_class* cls;
+        bool is_queued = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            cls = &get_class(method);
+            // calls of the limited class don't overtake waiting ones
+            if (cls->is_saturated() || (cls->limit && !cls->items.empty())) {
+                if (!enqueue(*cls, run, reject)) {
+                    ++cls->rejected;
+                    ++_rejected_queue_full;
+                    cls = nullptr;
+                } else {
+                    is_queued = true;
+                }
+            } else {
+                ++_accepted;
+                ++cls->running;
+            }
+        }
+
+        if (cls == nullptr) {
+            reject();
+        } else if (is_queued) {
+            _post([this]{ dispatch(); });
+        } else {
+            execute(*cls, run);
+        }
+    }
+
+    request_queue_stats request_queue::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        request_queue_stats stats;
+        stats.queue_size = _size;
+        stats.max_queue_size = _max_size;
+        stats.max_wait_ms = _timeout.count() / 1000;
+        stats.accepted = _accepted;
+        stats.rejected_queue_full = _rejected_queue_full;
+        stats.rejected_timeout = _rejected_timeout;
+        for (const auto& cls: _classes) {
+            request_class_stats cls_stats;
+            cls_stats.name = cls->name;
+            cls_stats.limit = cls->limit;
+            cls_stats.running = cls->running;
+            cls_stats.queued = cls->items.size();
+            cls_stats.rejected = cls->rejected;
+            stats.classes.push_back(std::move(cls_stats));
+        }
+        return stats;
+    }
+
+    request_queue::request_class& request_queue::get_class(const std::string& method) {
+        if (_names.empty()) {
+            return *_classes.front();
+        }
+
+        auto itr = _names.find(method);
+        if (itr != _names.end()) {
+            return *itr->second;
+        }
+
+        auto pos = method.find('.');
+        if (pos != std::string::npos) {
+            itr = _names.find(method.substr(0, pos) + ".*");
+            if (itr != _names.end()) {
+                return *itr->second;
+            }
+        }
+        return *_classes.front();
+    }
+
+    bool request_queue::enqueue(request_class& cls, task_type& run, task_type& reject) {
+        if (_max_size && _size >= _max_size) {
+            return false;
+        }
+        cls.items.push_back(item{fc::time_point::now(), std::move(run), std::move(reject)});
+        ++_size;
+        return true;
+    }
+
+    void request_queue::dispatch() {
+        std::vector<task_type> rejects;
+        request_class* next = nullptr;
+        task_type run;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto now = fc::time_point::now();
+            for (auto& cls: _classes) {
+                auto& items = cls->items;
+                while (_timeout.count() && !items.empty() && now - items.front().time > _timeout) {
+                    rejects.push_back(std::move(items.front().reject));
+                    items.pop_front();
+                    --_size;
+                    ++cls->rejected;
+                    ++_rejected_timeout;
+                }
+                if (!items.empty() && !cls->is_saturated() &&
+                    (next == nullptr || items.front().time < next->items.front().time)
+                ) {
+                    next = cls.get();
+                }
+            }
+            if (next != nullptr) {
+                run = std::move(next->items.front().run);
+                next->items.pop_front();
+                --_size;
+                ++_accepted;
+                ++next->running;
+            }
+        }
+
+        for (auto& reject: rejects) {
+            reject();
+        }
+        if (next != nullptr) {
+            execute(*next, run);
+        }
+    }
+
+    void request_queue::execute(request_class& cls, const task_type& run) {
+        try {
+            run();
+        } catch (...) {
+            finish(cls);
+            throw;
+        }
+        finish(cls);
+    }
+
+    void request_queue::finish(request_class& cls) {
+        bool has_items;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --cls.running;
+            has_items = _size != 0;
+        }
+        // waiting items of the class can be started on the freed slot
+        if (has_items) {
+            _post([this]{ dispatch(); });
+        }
+    }
+
+} } } // golos::plugins::webserver
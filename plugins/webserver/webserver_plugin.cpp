@@ -1,4 +1,5 @@
 #include <golos/plugins/webserver/webserver_plugin.hpp>
+#include <golos/plugins/webserver/request_queue.hpp>
 
 #include <golos/plugins/chain/plugin.hpp>
 
@@ -79,7 +80,9 @@ namespace golos {
             struct webserver_plugin::webserver_plugin_impl final {
             public:
                 boost::thread_group& thread_pool = appbase::app().scheduler();
-                webserver_plugin_impl(thread_pool_size_t thread_pool_size) : thread_pool_work(this->thread_pool_ios) {
+                webserver_plugin_impl(thread_pool_size_t thread_pool_size)
+                        : thread_pool_work(this->thread_pool_ios),
+                          queue([this](std::function<void ()> task) { thread_pool_ios.post(std::move(task)); }) {
                     for (uint32_t i = 0; i < thread_pool_size; ++i) {
                         thread_pool.create_thread(boost::bind(&asio::io_service::run, &thread_pool_ios));
                     }
@@ -93,6 +96,11 @@ namespace golos {
 
                 void handle_http_message(websocket_server_type *, connection_hdl);
 
+                /// Calls of batch requests are executed in parallel by the thread pool
+                void execute(std::function<void ()> task) {
+                    thread_pool_ios.post(std::move(task));
+                }
+
                 shared_ptr<std::thread> http_thread;
                 asio::io_service http_ios;
                 optional<tcp::endpoint> http_endpoint;
@@ -104,6 +112,7 @@ namespace golos {
                 websocket_server_type ws_server;
                 asio::io_service thread_pool_ios;
                 asio::io_service::work thread_pool_work;
+                request_queue queue;
 
                 plugins::json_rpc::plugin *api;
                 boost::signals2::connection chain_sync_con;
@@ -195,7 +204,7 @@ namespace golos {
                 websocket_server_type::message_ptr msg
             ) {
                 auto con = server->get_con_from_hdl(hdl);
-                thread_pool_ios.post([con, msg, this]() {
+                queue.push([con, msg, this]() {
                     try {
                         if (msg->get_opcode() == websocketpp::frame::opcode::text) {
                             api->call(msg->get_payload(), [con](const std::string &data){
@@ -203,6 +212,8 @@ namespace golos {
                                 if (ec) {
                                     throw websocketpp::exception(ec);
                                 }
+                            }, [this](std::function<void ()> task) {
+                                execute(std::move(task));
                             });
                         } else {
                             con->send("error: string payload expected");
@@ -210,6 +221,14 @@ namespace golos {
                     } catch (const fc::exception &e) {
                         con->send("error calling API " + e.to_string());
                     }
+                }, [con, this]() {
+                    try {
+                        api->reject([con](const std::string &data) {
+                            con->send(data);
+                        });
+                    } catch (...) {
+                        // the connection can be already closed
+                    }
                 });
             }
 
@@ -217,7 +236,7 @@ namespace golos {
                 auto con = server->get_con_from_hdl(hdl);
                 con->defer_http_response();
 
-                thread_pool_ios.post([con, this]() {
+                queue.push([con, this]() {
                     auto body = con->get_request_body();
 
                     try {
@@ -227,6 +246,8 @@ namespace golos {
                             con->set_body(data);
                             con->set_status(websocketpp::http::status_code::ok);
                             con->send_http_response();
+                        }, [this](std::function<void ()> task) {
+                            execute(std::move(task));
                         });
                     } catch (fc::exception &e) {
                         // this case happens if exception was thrown on parsing request
@@ -242,6 +263,16 @@ namespace golos {
                             // disable segfault
                         }
                     }
+                }, [con, this]() {
+                    try {
+                        api->reject([con](const std::string &data) {
+                            con->set_body(data);
+                            con->set_status(websocketpp::http::status_code::ok);
+                            con->send_http_response();
+                        });
+                    } catch (...) {
+                        // the connection can be already closed
+                    }
                 });
             }
 
@@ -260,7 +291,16 @@ namespace golos {
                     ("rpc-endpoint", boost::program_options::value<string>(),
                         "Local http and websocket endpoint for webserver requests. Deprectaed in favor of webserver-http-endpoint and webserver-ws-endpoint")
                     ("webserver-thread-pool-size", boost::program_options::value<thread_pool_size_t>()->default_value(256),
-                        "Number of threads used to handle queries. Default: 256.");
+                        "Number of threads used to handle queries. Default: 256.")
+                    ("webserver-max-queue-size", boost::program_options::value<uint32_t>()->default_value(10000),
+                        "Maximum number of requests and calls waiting for a thread, new ones are rejected "
+                        "with the overloaded error. 0 - unlimited. Default: 10000")
+                    ("webserver-queue-timeout-ms", boost::program_options::value<uint32_t>()->default_value(10000),
+                        "Requests and calls waiting for a thread longer are rejected with the overloaded error. "
+                        "0 - unlimited. Default: 10000")
+                    ("webserver-method-concurrency", boost::program_options::value<std::vector<string>>()->composing()->multitoken(),
+                        "Maximum number of calls of the method running at once in form api.method=limit. "
+                        "api.*=limit is the common limit of all methods of the api without own limits.");
             }
 
             void webserver_plugin::plugin_initialize(const boost::program_options::variables_map &options) {
@@ -269,6 +309,24 @@ namespace golos {
                 ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
                 my.reset(new webserver_plugin_impl(thread_pool_size));
 
+                my->queue.set_max_size(options.at("webserver-max-queue-size").as<uint32_t>());
+                my->queue.set_timeout(fc::milliseconds(options.at("webserver-queue-timeout-ms").as<uint32_t>()));
+                if (options.count("webserver-method-concurrency")) {
+                    for (const auto &limit: options.at("webserver-method-concurrency").as<std::vector<string>>()) {
+                        my->queue.set_limit(limit);
+                    }
+                }
+
+                auto &api = appbase::app().get_plugin<plugins::json_rpc::plugin>();
+                api.set_call_scheduler([this](
+                    const std::string &method, std::function<void ()> run, std::function<void ()> reject
+                ) {
+                    my->queue.call(method, std::move(run), std::move(reject));
+                });
+                api.add_api_method("webserver", "get_queue_stats", [this](json_rpc::msg_pack &) -> fc::variant {
+                    return fc::variant(get_queue_stats());
+                });
+
                 if (options.count("webserver-http-endpoint")) {
                     auto http_endpoint = options.at("webserver-http-endpoint").as<string>();
                     auto endpoints = appbase::app().resolve_string_to_ip_endpoints(http_endpoint);
@@ -326,6 +384,10 @@ namespace golos {
                 }
             }
 
+            request_queue_stats webserver_plugin::get_queue_stats() const {
+                return my->queue.get_stats();
+            }
+
             void webserver_plugin::plugin_shutdown() {
                 my->stop_webserver();
             }
@@ -322,7 +322,8 @@ namespace golos {
 
                 switch (result) {
                     case block_production_condition::produced:
-                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}", (capture));
+                        ilog("Generated block #${n} with timestamp ${t} at time ${c} by ${w}, "
+                             "${x} transactions assembled in ${a} ms (${r} pending state)", (capture));
                         break;
                     case block_production_condition::not_synced:
                         // This log-record is commented, because it outputs very often
@@ -434,7 +435,10 @@ namespace golos {
                                 private_key_itr->second,
                                 _production_skip_flags
                         );
-                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness);
+                        const auto& assembly = db.last_block_assembly();
+                        capture("n", block.block_num())("t", block.timestamp)("c", now)("w", scheduled_witness)
+                            ("x", assembly.transactions)("a", assembly.assembly_time.count() / 1000.0)
+                            ("r", assembly.reused_pending_state ? "reused" : "reapplied");
                         p2p().broadcast_block(block);
 
                         return block_production_condition::produced;
@@ -0,0 +1,152 @@
+#include <golos/chain/database.hpp>
+#include <golos/protocol/signature_cache.hpp>
+#include <golos/protocol/transaction_memo.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <iostream>
+
+using namespace golos::chain;
+using namespace golos::protocol;
+
+namespace {
+    double seconds(fc::microseconds elapsed) {
+        return std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+    }
+
+    signed_transaction make_transaction(const database& db, const operation& op, uint32_t n) {
+        signed_transaction trx;
+        trx.operations.push_back(op);
+        // transactions with the same operation differ by the expiration
+        trx.set_expiration(db.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION - (n % 3000));
+        trx.sign(STEEMIT_INIT_PRIVATE_KEY, db.get_chain_id());
+        return trx;
+    }
+}
+
+/**
+ * Measures the cost of the transaction path for typical transfer, comment and vote transactions:
+ * the serializations of the id, the size and the signature digest done without and with transaction_memo,
+ * and database::validate_transaction(), which validates and applies a transaction in the undo session.
+ * The first round recovers signature keys, the second one takes them from the signature cache.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 2) {
+            std::cerr
+                << "Usage: " << argv[0] << " <work_dir> [transactions] [body_size]\n"
+                << "    transactions - number of transactions of each type. Default: 10000\n"
+                << "    body_size - size of comment bodies. Default: 1000\n";
+            return 1;
+        }
+
+        fc::path work_dir(argv[1]);
+        uint32_t count = (argc > 2) ? std::stoul(argv[2]) : 10000;
+        uint32_t body_size = (argc > 3) ? std::stoul(argv[3]) : 1000;
+
+        signature_cache::instance().set_max_size(count * 3);
+
+        database db;
+        db.wipe(work_dir, work_dir, true);
+        db.open(work_dir, work_dir, STEEMIT_INIT_SUPPLY, 256 * 1024 * 1024, chainbase::database::read_write);
+
+        const auto skip_sigs = database::skip_transaction_signatures | database::skip_authority_check;
+
+        account_create_operation create;
+        create.new_account_name = "alice";
+        create.creator = STEEMIT_INIT_MINER_NAME;
+        create.owner = authority(1, STEEMIT_INIT_PRIVATE_KEY.get_public_key(), 1);
+        create.active = create.owner;
+        create.posting = create.owner;
+        create.memo_key = STEEMIT_INIT_PRIVATE_KEY.get_public_key();
+        db.push_transaction(make_transaction(db, create, 0), skip_sigs);
+
+        comment_operation post;
+        post.author = STEEMIT_INIT_MINER_NAME;
+        post.permlink = "benchmark";
+        post.parent_permlink = "test";
+        post.title = "benchmark";
+        post.body = std::string(body_size, 'x');
+        db.push_transaction(make_transaction(db, post, 0), skip_sigs);
+
+        std::vector<std::pair<std::string, std::vector<signed_transaction>>> types = {
+            {"transfer", {}}, {"comment", {}}, {"vote", {}}};
+        for (uint32_t i = 0; i < count; ++i) {
+            transfer_operation transfer;
+            transfer.from = STEEMIT_INIT_MINER_NAME;
+            transfer.to = "alice";
+            transfer.amount = asset(1 + i, STEEM_SYMBOL);
+            transfer.memo = "benchmark";
+            types[0].second.push_back(make_transaction(db, transfer, i));
+
+            comment_operation reply;
+            reply.parent_author = post.author;
+            reply.parent_permlink = post.permlink;
+            reply.author = "alice";
+            reply.permlink = "reply-" + std::to_string(i);
+            reply.body = std::string(body_size, 'x');
+            types[1].second.push_back(make_transaction(db, reply, i));
+
+            vote_operation vote;
+            vote.voter = "alice";
+            vote.author = post.author;
+            vote.permlink = post.permlink;
+            vote.weight = int16_t(1 + i % STEEMIT_100_PERCENT);
+            types[2].second.push_back(make_transaction(db, vote, i));
+        }
+
+        const auto& chain_id = db.get_chain_id();
+        for (const auto& type: types) {
+            const auto& trxs = type.second;
+
+            // what the push and apply path computed before: two ids, two sizes and the signature digest
+            uint64_t check = 0;
+            auto start = fc::time_point::now();
+            for (const auto& trx: trxs) {
+                check += trx.id()._hash[0] + trx.id()._hash[1];
+                check += fc::raw::pack_size(trx) + fc::raw::pack_size(trx);
+                check += trx.sig_digest(chain_id)._hash[0];
+            }
+            auto recomputed = fc::time_point::now() - start;
+
+            start = fc::time_point::now();
+            for (const auto& trx: trxs) {
+                transaction_memo memo(trx);
+                check -= memo.id()._hash[0] + memo.id()._hash[1];
+                check -= memo.packed_size() * 2;
+                check -= memo.sig_digest(chain_id)._hash[0];
+            }
+            auto memoized = fc::time_point::now() - start;
+            FC_ASSERT(check == 0, "Memoized values differ from computed ones");
+
+            std::cout
+                << type.first << ": id, size and digest " << uint64_t(trxs.size() / seconds(recomputed))
+                << " trx/sec recomputed, " << uint64_t(trxs.size() / seconds(memoized)) << " trx/sec memoized\n";
+
+            for (int round = 1; round <= 2; ++round) {
+                uint32_t failed = 0;
+                start = fc::time_point::now();
+                for (const auto& trx: trxs) {
+                    try {
+                        db.validate_transaction(trx, 0);
+                    } catch (const fc::exception& e) {
+                        if (!failed++) {
+                            wlog("${t} transaction failed: ${e}", ("t", type.first)("e", e.to_string()));
+                        }
+                    }
+                }
+                auto elapsed = fc::time_point::now() - start;
+                std::cout
+                    << type.first << ": validate and apply, round " << round << ", "
+                    << uint64_t(trxs.size() / seconds(elapsed)) << " trx/sec, "
+                    << double(elapsed.count()) / trxs.size() << " us/trx, " << failed << " failed\n";
+            }
+        }
+
+        db.wipe(work_dir, work_dir, true);
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
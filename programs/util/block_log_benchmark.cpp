@@ -0,0 +1,79 @@
+#include <golos/chain/block_log.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <random>
+
+using golos::chain::block_log;
+
+/**
+ * Measures read throughput of block_log in any format:
+ * a sequential read of all blocks like on replay, and reads of random blocks like by API.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 2) {
+            std::cerr
+                << "Usage: " << argv[0] << " <block_log> [cache_chunks] [random_reads]\n"
+                << "    cache_chunks - number of decoded chunks kept in memory for the compressed format. Default: 16\n"
+                << "    random_reads - number of reads of random blocks. Default: 100000\n";
+            return 1;
+        }
+
+        fc::path path(argv[1]);
+        uint32_t cache_chunks = (argc > 2) ? std::stoul(argv[2]) : 16;
+        uint32_t random_reads = (argc > 3) ? std::stoul(argv[3]) : 100000;
+
+        FC_ASSERT(boost::filesystem::exists(path.string()), "Block log doesn't exist");
+
+        block_log log;
+        log.set_cache_size(cache_chunks);
+        log.open(path);
+        FC_ASSERT(log.head().valid(), "Block log is empty");
+
+        const uint32_t last_block_num = log.head()->block_num();
+
+        auto print = [&](const char* name, uint32_t blocks, uint64_t bytes, fc::microseconds elapsed) {
+            auto sec = std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+            auto stats = log.get_cache_stats();
+            std::cout
+                << name << ": " << blocks << " blocks in " << sec << " sec, "
+                << uint64_t(blocks / sec) << " blocks/sec, "
+                << (bytes / sec / (1024 * 1024)) << " MB/sec of packed blocks, "
+                << "chunk cache " << stats.hits << " hits / " << stats.misses << " misses\n";
+        };
+
+        std::cout
+            << (log.is_compressed() ? "compressed" : "raw") << " block log, "
+            << last_block_num << " blocks, "
+            << boost::filesystem::file_size(path.string()) << " bytes\n";
+
+        uint64_t bytes = 0;
+        auto start = fc::time_point::now();
+        for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+            auto block = log.read_block_by_num(block_num);
+            FC_ASSERT(block.valid(), "Block ${n} not found", ("n", block_num));
+            bytes += fc::raw::pack_size(*block);
+        }
+        print("sequential", last_block_num, bytes, fc::time_point::now() - start);
+
+        log.close();
+        log.open(path);
+
+        std::mt19937 generator(last_block_num);
+        std::uniform_int_distribution<uint32_t> distribution(1, last_block_num);
+
+        bytes = 0;
+        start = fc::time_point::now();
+        for (uint32_t i = 0; i < random_reads; ++i) {
+            auto block = log.read_block_by_num(distribution(generator));
+            bytes += fc::raw::pack_size(*block);
+        }
+        print("random", random_reads, bytes, fc::time_point::now() - start);
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <golos/chain/block_log.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+
+/**
+ * Converts block_log between the raw and the compressed formats.
+ * The format of the source is detected, the destination is created in the format given by chunk_blocks.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 3) {
+            std::cerr
+                << "Usage: " << argv[0] << " <source block_log> <destination block_log> [chunk_blocks]\n"
+                << "    chunk_blocks - number of blocks in a chunk of the compressed destination,\n"
+                << "                   0 - the raw destination. Default: 128\n";
+            return 1;
+        }
+
+        fc::path src_path(argv[1]);
+        fc::path dst_path(argv[2]);
+        uint32_t chunk_blocks = (argc > 3) ? std::stoul(argv[3]) : 128;
+
+        FC_ASSERT(boost::filesystem::exists(src_path.string()), "Source block log doesn't exist");
+        FC_ASSERT(!boost::filesystem::exists(dst_path.string()), "Destination block log already exists");
+
+        golos::chain::block_log src;
+        golos::chain::block_log dst;
+
+        src.open(src_path);
+        FC_ASSERT(src.head().valid(), "Source block log is empty");
+        dst.open(dst_path, chunk_blocks);
+
+        const uint32_t last_block_num = src.head()->block_num();
+        auto start = fc::time_point::now();
+
+        for (uint32_t block_num = 1; block_num <= last_block_num; ++block_num) {
+            auto block = src.read_block_by_num(block_num);
+            FC_ASSERT(block.valid(), "Block ${n} not found in source block log", ("n", block_num));
+            dst.append(*block);
+
+            if (block_num % 100000 == 0) {
+                std::cerr << "   " << block_num << " of " << last_block_num << "\n";
+            }
+        }
+
+        auto elapsed = fc::time_point::now() - start;
+        FC_ASSERT(dst.head().valid() && dst.head()->id() == src.head()->id(), "Head blocks don't match");
+
+        src.close();
+        dst.close();
+
+        ilog("Converted ${n} blocks in ${t} sec: ${s} bytes -> ${d} bytes", ("n", last_block_num)
+            ("t", double(elapsed.count()) / 1000000.0)
+            ("s", boost::filesystem::file_size(src_path.string()))
+            ("d", boost::filesystem::file_size(dst_path.string())));
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
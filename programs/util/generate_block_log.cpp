@@ -0,0 +1,312 @@
+#include "synthetic_chain.hpp"
+
+#include <golos/chain/block_log.hpp>
+#include <golos/chain/witness_objects.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+using namespace golos::chain;
+using namespace golos::protocol;
+using namespace golos::benchmark;
+
+namespace {
+
+    struct generator_stats {
+        uint64_t transactions = 0;
+        uint64_t failed = 0;
+        std::map<std::string, uint64_t> operations;
+    };
+
+    class synthetic_chain_generator final {
+    public:
+        synthetic_chain_generator(database& db, uint32_t accounts, uint32_t seed)
+                : _db(db), _accounts(accounts), _random(seed) {
+        }
+
+        void generate_block() {
+            _db.generate_block(_db.get_slot_time(1), _db.get_scheduled_witness(1), synthetic_private_key(), 0);
+        }
+
+        /// Creates and funds accounts, several accounts in each block
+        void create_accounts() {
+            const auto fee = _db.get_witness_schedule_object().median_props.account_creation_fee;
+            for (uint32_t i = 0; i < _accounts; ++i) {
+                auto name = synthetic_account_name(i);
+
+                account_create_operation create;
+                create.fee = fee;
+                create.creator = STEEMIT_INIT_MINER_NAME;
+                create.new_account_name = name;
+                create.owner = authority(1, synthetic_private_key().get_public_key(), 1);
+                create.active = create.owner;
+                create.posting = create.owner;
+                create.memo_key = synthetic_private_key().get_public_key();
+                push("account_create", create);
+
+                transfer_operation transfer;
+                transfer.from = STEEMIT_INIT_MINER_NAME;
+                transfer.to = name;
+                transfer.amount = asset(1000000, STEEM_SYMBOL);
+                push("transfer", transfer);
+
+                transfer_to_vesting_operation vest;
+                vest.from = STEEMIT_INIT_MINER_NAME;
+                vest.to = name;
+                vest.amount = asset(1000000, STEEM_SYMBOL);
+                push("transfer_to_vesting", vest);
+
+                if (i % 50 == 49) {
+                    generate_block();
+                }
+            }
+            generate_block();
+        }
+
+        /// Pushes transactions with the mix of operations of a live chain and generates a block
+        void generate_mixed_block(uint32_t transactions) {
+            _voted_in_block.clear();
+            for (uint32_t i = 0; i < transactions; ++i) {
+                auto kind = std::uniform_int_distribution<uint32_t>(0, 99)(_random);
+                if (kind < 40) {
+                    vote();
+                } else if (kind < 60) {
+                    comment();
+                } else if (kind < 75) {
+                    transfer();
+                } else if (kind < 90) {
+                    follow();
+                } else {
+                    order();
+                }
+            }
+            generate_block();
+        }
+
+        const generator_stats& stats() const {
+            return _stats;
+        }
+
+    private:
+        uint32_t random_account() {
+            return std::uniform_int_distribution<uint32_t>(0, _accounts - 1)(_random);
+        }
+
+        void push(const std::string& name, const operation& op) {
+            signed_transaction trx;
+            trx.operations.push_back(op);
+            trx.set_reference_block(_db.head_block_id());
+            trx.set_expiration(_db.head_block_time() + fc::seconds(STEEMIT_MAX_TIME_UNTIL_EXPIRATION / 2));
+            trx.sign(synthetic_private_key(), _db.get_chain_id());
+
+            ++_stats.transactions;
+            try {
+                _db.push_transaction(trx, database::skip_transaction_signatures | database::skip_authority_check);
+                ++_stats.operations[name];
+            } catch (const fc::exception& e) {
+                if (!_stats.failed++) {
+                    wlog("Transaction failed: ${e}", ("e", e.to_string()));
+                }
+            }
+        }
+
+        void vote() {
+            if (_posts.empty()) {
+                return comment();
+            }
+
+            // recent posts, which aren't paid out yet
+            auto first = _posts.size() > 1000 ? _posts.size() - 1000 : 0;
+            const auto& post = _posts[std::uniform_int_distribution<std::size_t>(first, _posts.size() - 1)(_random)];
+            auto voter = random_account();
+            if (_voted_in_block.count(voter) || !_votes.insert(std::make_pair(voter, post.second)).second) {
+                return;
+            }
+            _voted_in_block.insert(voter);
+
+            vote_operation op;
+            op.voter = synthetic_account_name(voter);
+            op.author = synthetic_account_name(post.first);
+            op.permlink = post.second;
+            op.weight = int16_t(std::uniform_int_distribution<int>(1, 100)(_random) * STEEMIT_1_PERCENT);
+            push("vote", op);
+        }
+
+        void comment() {
+            auto author = random_account();
+            auto now = _db.head_block_time();
+            bool is_root = _posts.empty() || std::uniform_int_distribution<uint32_t>(0, 3)(_random) == 0;
+
+            auto& last = is_root ? _last_post[author] : _last_reply[author];
+            auto interval = is_root ? STEEMIT_MIN_ROOT_COMMENT_INTERVAL : STEEMIT_MIN_REPLY_INTERVAL;
+            if (last != fc::time_point_sec() && now < last + interval) {
+                return;
+            }
+            last = now;
+
+            comment_operation op;
+            op.author = synthetic_account_name(author);
+            op.permlink = "post" + std::to_string(_next_permlink++);
+            op.body = std::string(std::uniform_int_distribution<uint32_t>(100, 2000)(_random), 'x');
+            op.json_metadata = "{\"tags\":[\"bench\"]}";
+            if (is_root) {
+                op.parent_permlink = "bench";
+                op.title = op.permlink;
+            } else {
+                const auto& parent = _posts[std::uniform_int_distribution<std::size_t>(
+                    _posts.size() > 1000 ? _posts.size() - 1000 : 0, _posts.size() - 1)(_random)];
+                op.parent_author = synthetic_account_name(parent.first);
+                op.parent_permlink = parent.second;
+            }
+            push("comment", op);
+            if (is_root) {
+                _posts.emplace_back(author, op.permlink);
+            }
+        }
+
+        void transfer() {
+            auto from = random_account();
+            auto to = random_account();
+            if (from == to) {
+                return;
+            }
+
+            transfer_operation op;
+            op.from = synthetic_account_name(from);
+            op.to = synthetic_account_name(to);
+            op.amount = asset(std::uniform_int_distribution<int64_t>(1, 1000)(_random), STEEM_SYMBOL);
+            op.memo = "bench";
+            push("transfer", op);
+        }
+
+        void follow() {
+            auto follower = random_account();
+            auto following = random_account();
+            if (follower == following) {
+                return;
+            }
+
+            custom_json_operation op;
+            op.id = "follow";
+            op.required_posting_auths.insert(synthetic_account_name(follower));
+            op.json = "[\"follow\",{\"follower\":\"" + synthetic_account_name(follower) +
+                "\",\"following\":\"" + synthetic_account_name(following) + "\",\"what\":[\"blog\"]}]";
+            push("custom_json", op);
+        }
+
+        void order() {
+            auto owner = random_account();
+            auto& orderid = _last_order[owner];
+            if (orderid && std::uniform_int_distribution<uint32_t>(0, 2)(_random) == 0) {
+                limit_order_cancel_operation op;
+                op.owner = synthetic_account_name(owner);
+                op.orderid = orderid;
+                push("limit_order_cancel", op);
+                orderid = 0;
+                return;
+            }
+
+            limit_order_create_operation op;
+            op.owner = synthetic_account_name(owner);
+            op.orderid = ++_next_orderid;
+            op.amount_to_sell = asset(std::uniform_int_distribution<int64_t>(1000, 100000)(_random), STEEM_SYMBOL);
+            op.min_to_receive = asset(op.amount_to_sell.amount * 2, SBD_SYMBOL);
+            op.expiration = _db.head_block_time() + fc::days(1);
+            push("limit_order_create", op);
+            orderid = op.orderid;
+        }
+
+        database& _db;
+        uint32_t _accounts;
+        std::mt19937 _random;
+
+        std::vector<std::pair<uint32_t, std::string>> _posts;
+        std::set<std::pair<uint32_t, std::string>> _votes;
+        std::set<uint32_t> _voted_in_block;
+        std::map<uint32_t, fc::time_point_sec> _last_post;
+        std::map<uint32_t, fc::time_point_sec> _last_reply;
+        std::map<uint32_t, uint32_t> _last_order;
+        uint64_t _next_permlink = 0;
+        uint32_t _next_orderid = 0;
+
+        generator_stats _stats;
+    };
+
+} // namespace
+
+/**
+ * Generates a deterministic block_log with the mix of votes, comments, transfers, follows and orders.
+ * The same arguments and the same build give the same blocks, so replays of the log can be compared
+ * between commits by replay_benchmark.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 2) {
+            std::cerr
+                << "Usage: " << argv[0] << " <data_dir> [blocks] [accounts] [transactions_per_block] [seed]\n"
+                << "    blocks - number of blocks with transactions. Default: 10000\n"
+                << "    accounts - number of accounts. Default: 1000\n"
+                << "    transactions_per_block - Default: 50\n"
+                << "    seed - seed of the random generator. Default: 1\n";
+            return 1;
+        }
+
+        fc::path data_dir(argv[1]);
+        uint32_t blocks = (argc > 2) ? std::stoul(argv[2]) : 10000;
+        uint32_t accounts = (argc > 3) ? std::stoul(argv[3]) : 1000;
+        uint32_t transactions = (argc > 4) ? std::stoul(argv[4]) : 50;
+        uint32_t seed = (argc > 5) ? std::stoul(argv[5]) : 1;
+
+        FC_ASSERT(accounts > 1, "At least two accounts are needed");
+
+        database db;
+        db.set_inc_shared_memory_size(1024 * 1024 * 1024);
+        db.set_min_free_shared_memory_size(256 * 1024 * 1024);
+        db.set_block_num_check_free_size(100);
+        db.wipe(data_dir, data_dir / "shared_mem", true);
+        db.open(data_dir, data_dir / "shared_mem", STEEMIT_INIT_SUPPLY, 1024 * 1024 * 1024,
+            chainbase::database::read_write);
+        init_synthetic_chain(db);
+
+        synthetic_chain_generator generator(db, accounts, seed);
+
+        auto start = fc::time_point::now();
+        generator.create_accounts();
+        for (uint32_t i = 0; i < blocks; ++i) {
+            generator.generate_mixed_block(transactions);
+            if (i % 1000 == 999) {
+                std::cerr << "   " << (i + 1) << " of " << blocks << " blocks\n";
+            }
+        }
+        auto elapsed = fc::time_point::now() - start;
+
+        const auto& stats = generator.stats();
+        fc::mutable_variant_object operations;
+        for (const auto& item: stats.operations) {
+            operations(item.first, item.second);
+        }
+
+        auto head_block_num = db.head_block_num();
+        auto irreversible_block_num = db.get_block_log().head() ? db.get_block_log().head()->block_num() : 0;
+        db.close();
+
+        std::cout << fc::json::to_pretty_string(fc::mutable_variant_object()
+            ("blocks", head_block_num)
+            ("block_log_blocks", irreversible_block_num)
+            ("accounts", accounts)
+            ("seed", seed)
+            ("transactions", stats.transactions)
+            ("failed_transactions", stats.failed)
+            ("operations", operations)
+            ("elapsed_sec", double(elapsed.count()) / 1000000.0)) << std::endl;
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
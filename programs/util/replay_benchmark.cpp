@@ -0,0 +1,108 @@
+#include "synthetic_chain.hpp"
+
+#include <golos/chain/block_log.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <sys/resource.h>
+
+#include <iostream>
+
+using namespace golos::chain;
+using namespace golos::benchmark;
+
+namespace {
+    double seconds(fc::microseconds elapsed) {
+        return std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+    }
+
+    /// Peak resident set size of the process in bytes
+    uint64_t peak_rss() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+        return uint64_t(usage.ru_maxrss) * 1024;
+    }
+}
+
+/**
+ * Replays a block_log made by generate_block_log through database::reindex() and reports
+ * blocks/sec, operations/sec, time of steps of applying, the peak RSS and the growth of the shared memory
+ * as JSON, so results of different builds can be compared.
+ * The block_log is read from <data_dir>, the state is created in <work_dir>, the block_log isn't changed.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 3) {
+            std::cerr
+                << "Usage: " << argv[0] << " <data_dir> <work_dir> [shared_file_size_mb]\n"
+                << "    data_dir - the directory with the block_log made by generate_block_log\n"
+                << "    shared_file_size_mb - start size of shared memory. Default: 1024\n";
+            return 1;
+        }
+
+        fc::path data_dir(argv[1]);
+        fc::path shared_mem_dir = fc::path(argv[2]) / "shared_mem";
+        uint64_t shared_file_size = uint64_t((argc > 3) ? std::stoul(argv[3]) : 1024) * 1024 * 1024;
+
+        FC_ASSERT(boost::filesystem::exists((data_dir / "block_log").string()), "Block log doesn't exist");
+
+        database db;
+        db.set_inc_shared_memory_size(shared_file_size);
+        db.set_min_free_shared_memory_size(shared_file_size / 8);
+        db.set_block_num_check_free_size(1000);
+        db.wipe(data_dir, shared_mem_dir, false);
+        db.open(data_dir, shared_mem_dir, STEEMIT_INIT_SUPPLY, shared_file_size, chainbase::database::read_write);
+        init_synthetic_chain(db);
+
+        const uint64_t start_max_memory = db.max_memory();
+        const uint64_t start_used_memory = db.max_memory() - db.free_memory();
+        const uint64_t start_rss = peak_rss();
+
+        uint64_t operations = 0;
+        uint64_t transactions = 0;
+        auto connection = db.applied_block.connect([&](const signed_block& block) {
+            transactions += block.transactions.size();
+            for (const auto& trx: block.transactions) {
+                operations += trx.operations.size();
+            }
+        });
+
+        auto start = fc::time_point::now();
+        db.reindex(data_dir, shared_mem_dir, 1, shared_file_size);
+        auto elapsed = seconds(fc::time_point::now() - start);
+        connection.disconnect();
+
+        const uint32_t blocks = db.head_block_num();
+        const uint64_t end_max_memory = db.max_memory();
+        const uint64_t end_used_memory = db.max_memory() - db.free_memory();
+        const auto timing = db.get_apply_timing_stats().get_info();
+        db.close();
+
+        std::cout << fc::json::to_pretty_string(fc::mutable_variant_object()
+            ("blocks", blocks)
+            ("transactions", transactions)
+            ("operations", operations)
+            ("elapsed_sec", elapsed)
+            ("blocks_per_sec", blocks / elapsed)
+            ("operations_per_sec", operations / elapsed)
+            ("peak_rss", fc::mutable_variant_object()
+                ("before_replay", start_rss)
+                ("after_replay", peak_rss()))
+            ("shared_memory", fc::mutable_variant_object()
+                ("start_size", start_max_memory)
+                ("end_size", end_max_memory)
+                ("start_used", start_used_memory)
+                ("end_used", end_used_memory)
+                ("used_per_block", blocks ? (end_used_memory - start_used_memory) / blocks : 0))
+            ("timing", timing)) << std::endl;
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
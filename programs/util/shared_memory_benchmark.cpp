@@ -0,0 +1,123 @@
+#include <golos/chain/database.hpp>
+#include <golos/chain/block_log.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+
+using golos::chain::database;
+using golos::chain::block_log;
+
+namespace {
+    struct configuration {
+        std::string name;
+        uint32_t advice;
+        uint32_t prefault_threads;
+        fc::path shared_mem_root;
+    };
+
+    double seconds(fc::microseconds elapsed) {
+        return std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+    }
+}
+
+/**
+ * Applies a fixed range of blocks under several configurations of the shared memory mapping:
+ * hints for madvise(), the prefault on startup and hugetlbfs.
+ * The state before the range is built first, then the database is reopened like after a restart,
+ * so the time of opening and the first blocks include page faults of the existing file.
+ * Pages stay in the page cache between runs, drop it before each run to measure a cold start.
+ */
+int main(int argc, char **argv, char **envp) {
+    try {
+        if (argc < 5) {
+            std::cerr
+                << "Usage: " << argv[0] << " <block_log> <work_dir> <from_block> <to_block> "
+                << "[shared_file_size_mb] [prefault_threads] [hugetlbfs_dir]\n"
+                << "    shared_file_size_mb - start size of shared memory. Default: 2048\n"
+                << "    prefault_threads - threads for configurations with the prefault. Default: 4\n"
+                << "    hugetlbfs_dir - a directory on hugetlbfs to run also the configuration with huge pages\n";
+            return 1;
+        }
+
+        fc::path path(argv[1]);
+        fc::path work_dir(argv[2]);
+        uint32_t from_block = std::stoul(argv[3]);
+        uint32_t to_block = std::stoul(argv[4]);
+        uint64_t shared_file_size = uint64_t((argc > 5) ? std::stoul(argv[5]) : 2048) * 1024 * 1024;
+        uint32_t prefault_threads = (argc > 6) ? std::stoul(argv[6]) : 4;
+
+        FC_ASSERT(boost::filesystem::exists(path.string()), "Block log doesn't exist");
+        FC_ASSERT(from_block > 1 && from_block <= to_block, "Invalid range of blocks");
+
+        block_log log;
+        log.open(path);
+        FC_ASSERT(log.head().valid() && log.head()->block_num() >= to_block, "Block log doesn't contain the range");
+
+        std::vector<configuration> configurations = {
+            {"normal", golos::chain::shared_memory_advice_normal, 0, work_dir},
+            {"random", golos::chain::shared_memory_advice_random, 0, work_dir},
+            {"willneed", golos::chain::shared_memory_advice_willneed, 0, work_dir},
+            {"hugepage", golos::chain::shared_memory_advice_hugepage, 0, work_dir},
+            {"random+prefault", golos::chain::shared_memory_advice_random, prefault_threads, work_dir},
+        };
+        if (argc > 7) {
+            configurations.push_back({"hugetlbfs", golos::chain::shared_memory_advice_normal, 0, fc::path(argv[7])});
+        }
+
+        for (const auto& config: configurations) {
+            auto data_dir = work_dir / "blockchain";
+            auto shared_mem_dir = config.shared_mem_root / "shared_mem";
+
+            auto configure = [&](database& db) {
+                db.set_shared_memory_advice(config.advice);
+                db.set_shared_memory_prefault_threads(config.prefault_threads);
+                db.set_inc_shared_memory_size(shared_file_size);
+                db.set_min_free_shared_memory_size(shared_file_size / 8);
+                db.set_block_num_check_free_size(100);
+            };
+
+            auto apply = [&](database& db, uint32_t first, uint32_t last) {
+                for (auto block_num = first; block_num <= last; ++block_num) {
+                    auto block = log.read_block_by_num(block_num);
+                    FC_ASSERT(block.valid(), "Block ${n} not found", ("n", block_num));
+                    db.with_strong_write_lock([&]() {
+                        db.apply_irreversible_block(*block);
+                        db.check_free_memory(true, block_num);
+                    });
+                }
+            };
+
+            {
+                database db;
+                configure(db);
+                db.wipe(data_dir, shared_mem_dir, true);
+                db.open(data_dir, shared_mem_dir, STEEMIT_INIT_SUPPLY, shared_file_size, chainbase::database::read_write);
+                apply(db, 1, from_block - 1);
+                db.close();
+            }
+
+            database db;
+            configure(db);
+
+            auto start = fc::time_point::now();
+            db.open(data_dir, shared_mem_dir, STEEMIT_INIT_SUPPLY, shared_file_size, chainbase::database::read_write);
+            auto opened = fc::time_point::now();
+            apply(db, from_block, to_block);
+            auto applied = fc::time_point::now();
+
+            const uint32_t blocks = to_block - from_block + 1;
+            std::cout
+                << config.name << ": open " << seconds(opened - start) << " sec, "
+                << blocks << " blocks in " << seconds(applied - opened) << " sec, "
+                << uint64_t(blocks / seconds(applied - opened)) << " blocks/sec, "
+                << (db.max_memory() / (1024 * 1024)) << "M of shared memory\n";
+
+            db.wipe(data_dir, shared_mem_dir, true);
+        }
+    } catch (const fc::exception& e) {
+        edump((e.to_detail_string()));
+        return 1;
+    }
+    return 0;
+}
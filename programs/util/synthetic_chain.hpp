@@ -0,0 +1,29 @@
+#pragma once
+
+#include <golos/chain/database.hpp>
+
+#include <string>
+
+namespace golos { namespace benchmark {
+
+    /// Key of all accounts of the synthetic chain, it is the key of the init miner
+    inline fc::ecc::private_key synthetic_private_key() {
+        return STEEMIT_INIT_PRIVATE_KEY;
+    }
+
+    inline std::string synthetic_account_name(uint32_t i) {
+        return "bench" + std::to_string(i);
+    }
+
+    /**
+     * Prepares the genesis state of the synthetic chain. Hardforks are applied before the first block,
+     *   so the same call on the replay gives the same state as on the generation.
+     */
+    inline void init_synthetic_chain(golos::chain::database& db) {
+        db._log_hardforks = false;
+        db.with_strong_write_lock([&]() {
+            db.set_hardfork(STEEMIT_NUM_HARDFORKS);
+        });
+    }
+
+} } // golos::benchmark
@@ -0,0 +1,173 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/plugins/chain/plugin.hpp>
+#include <golos/plugins/json_rpc/plugin.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <thread>
+
+typedef golos::plugins::json_rpc::plugin json_rpc_plugin;
+
+namespace batch_benchmark {
+
+    using golos::plugins::json_rpc::msg_pack;
+
+    DEFINE_API_ARGS(get_block, msg_pack, fc::optional<golos::protocol::signed_block>)
+
+    /// Reads blocks like database_api::get_block, the delay emulates reading of the block_log from the disk
+    class benchmark_api final : public appbase::plugin<benchmark_api> {
+    public:
+        benchmark_api() { }
+        ~benchmark_api() { }
+
+        constexpr static const char *plugin_name = "benchmark_api";
+
+        APPBASE_PLUGIN_REQUIRES((json_rpc_plugin));
+
+        static const std::string &name() {
+            static std::string name = plugin_name;
+            return name;
+        }
+
+        void set_program_options(boost::program_options::options_description &,
+                boost::program_options::options_description &) override {
+        }
+
+        void plugin_initialize(const boost::program_options::variables_map &options) override {
+            JSON_RPC_REGISTER_API(plugin_name);
+        }
+
+        void plugin_startup() override { }
+
+        void plugin_shutdown() override { }
+
+        uint32_t delay_us = 0;
+
+        DECLARE_API((get_block))
+    };
+
+    DEFINE_API(benchmark_api, get_block) {
+        auto block_num = args.args->at(0).as<uint32_t>();
+        if (delay_us) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        }
+        auto& db = appbase::app().get_plugin<golos::plugins::chain::plugin>().db();
+        return db.with_weak_read_lock([&]() {
+            return db.fetch_block_by_number(block_num);
+        });
+    }
+
+    uint32_t env_value(const char* name, uint32_t default_value) {
+        const char* value = getenv(name);
+        return value ? std::stoul(value) : default_value;
+    }
+
+} // namespace batch_benchmark
+
+using namespace batch_benchmark;
+
+/**
+ * Compares the latency of batch requests of get_block calls with different json-rpc-batch-parallelism,
+ * the parallelism 1 is the execution of calls one after another.
+ * Parameters are taken from the environment:
+ *   BATCH_BENCHMARK_SIZE - number of calls in a batch. Default: 100
+ *   BATCH_BENCHMARK_ROUNDS - number of batches for each parallelism. Default: 20
+ *   BATCH_BENCHMARK_THREADS - size of the thread pool. Default: 16
+ *   BATCH_BENCHMARK_DELAY_US - additional time of each call. Default: 1000
+ */
+BOOST_FIXTURE_TEST_SUITE(json_rpc_batch_benchmark, golos::chain::database_fixture)
+
+BOOST_AUTO_TEST_CASE(batch_latency) {
+    const uint32_t batch_size = env_value("BATCH_BENCHMARK_SIZE", 100);
+    const uint32_t rounds = env_value("BATCH_BENCHMARK_ROUNDS", 20);
+    const uint32_t threads_count = env_value("BATCH_BENCHMARK_THREADS", 16);
+
+    initialize();
+
+    auto &rpc_plugin = appbase::app().register_plugin<json_rpc_plugin>();
+    auto &api = appbase::app().register_plugin<benchmark_api>();
+
+    boost::program_options::variables_map options;
+    rpc_plugin.plugin_initialize(options);
+    api.plugin_initialize(options);
+    api.delay_us = env_value("BATCH_BENCHMARK_DELAY_US", 1000);
+
+    open_database();
+    startup();
+    rpc_plugin.plugin_startup();
+    api.plugin_startup();
+
+    generate_blocks(batch_size);
+
+    std::string request = "[";
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        if (i) {
+            request += ",";
+        }
+        request += "{\"id\":" + std::to_string(i) + ",\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+            "\"benchmark_api\",\"get_block\",[" + std::to_string(i + 1) + "]]}";
+    }
+    request += "]";
+
+    boost::asio::io_service ios;
+    std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(ios));
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&]{ ios.run(); });
+    }
+
+    fc::variants results;
+    for (uint32_t parallelism: {1, 2, 4, 8, 16}) {
+        rpc_plugin.set_batch_parallelism(parallelism);
+
+        std::vector<int64_t> latencies;
+        for (uint32_t round = 0; round < rounds; ++round) {
+            std::promise<std::string> promise;
+            auto result = promise.get_future();
+
+            // the batch is started from the pool, like the webserver does
+            auto start = fc::time_point::now();
+            ios.post([&]{
+                rpc_plugin.call(request, [&](const std::string& str) {
+                    promise.set_value(str);
+                }, [&](std::function<void ()> task) {
+                    ios.post(std::move(task));
+                });
+            });
+            auto response = result.get();
+            latencies.push_back((fc::time_point::now() - start).count());
+
+            BOOST_CHECK_EQUAL(fc::json::from_string(response).get_array().size(), batch_size);
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        results.push_back(fc::mutable_variant_object()
+            ("parallelism", parallelism)
+            ("p50_us", latencies[latencies.size() / 2])
+            ("p99_us", latencies[std::min<std::size_t>(latencies.size() - 1, latencies.size() * 99 / 100)])
+            ("max_us", latencies.back()));
+    }
+
+    work.reset();
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    std::cout << fc::json::to_pretty_string(fc::mutable_variant_object()
+        ("batch_size", batch_size)
+        ("rounds", rounds)
+        ("threads", threads_count)
+        ("delay_us", api.delay_us)
+        ("results", results)) << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
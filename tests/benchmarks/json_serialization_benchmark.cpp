@@ -0,0 +1,108 @@
+#include <boost/test/unit_test.hpp>
+
+#include <golos/api/discussion.hpp>
+#include <golos/protocol/json_writer.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+using golos::protocol::json_writer;
+using golos::api::discussion;
+
+namespace {
+
+    uint32_t env_value(const char* name, uint32_t default_value) {
+        const char* value = getenv(name);
+        return value ? std::stoul(value) : default_value;
+    }
+
+    /// A discussion like ones returned by get_discussions_by_* with votes
+    discussion make_discussion(uint32_t i, uint32_t votes) {
+        discussion d;
+        d.id = golos::chain::comment_id_type(i);
+        d.author = "author" + std::to_string(i % 100);
+        d.permlink = "post-" + std::to_string(i);
+        d.category = "golos";
+        d.parent_permlink = "golos";
+        d.title = "Title of the post " + std::to_string(i);
+        d.body = std::string(2000, 'x');
+        d.json_metadata = "{\"tags\":[\"golos\",\"benchmark\"],\"app\":\"golos-io/0.1\"}";
+        d.created = fc::time_point_sec(1500000000 + i);
+        d.net_rshares = 5000000000ll + i;
+        d.abs_rshares = d.net_rshares;
+        d.url = "/golos/@" + std::string(d.author) + "/" + d.permlink;
+        d.root_title = d.title;
+        d.author_reputation = golos::protocol::share_type(1000000000ll);
+        d.body_length = d.body.size();
+        for (uint32_t v = 0; v < votes; ++v) {
+            golos::api::vote_state vote;
+            vote.voter = "voter" + std::to_string(v);
+            vote.weight = 1000 + v;
+            vote.rshares = 100000000ll * v;
+            vote.percent = 10000;
+            vote.reputation = golos::protocol::share_type(1000);
+            vote.time = fc::time_point_sec(1500000000 + i + v);
+            d.active_votes.push_back(vote);
+        }
+        d.active_votes_count = votes;
+        return d;
+    }
+
+    double seconds(fc::microseconds elapsed) {
+        return std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+    }
+
+} // namespace
+
+/**
+ * Compares the serialization of a get_discussions_by_* response through fc::variant
+ * with the direct serialization of json_writer.
+ * Parameters are taken from the environment:
+ *   JSON_BENCHMARK_DISCUSSIONS - number of discussions in a response. Default: 100
+ *   JSON_BENCHMARK_VOTES - number of active votes in a discussion. Default: 20
+ *   JSON_BENCHMARK_ROUNDS - number of serializations for each path. Default: 200
+ */
+BOOST_AUTO_TEST_SUITE(json_serialization_benchmark)
+
+BOOST_AUTO_TEST_CASE(discussions) {
+    const uint32_t count = env_value("JSON_BENCHMARK_DISCUSSIONS", 100);
+    const uint32_t votes = env_value("JSON_BENCHMARK_VOTES", 20);
+    const uint32_t rounds = env_value("JSON_BENCHMARK_ROUNDS", 200);
+
+    std::vector<discussion> discussions;
+    for (uint32_t i = 0; i < count; ++i) {
+        discussions.push_back(make_discussion(i, votes));
+    }
+
+    BOOST_REQUIRE_EQUAL(json_writer::to_string(discussions), fc::json::to_string(fc::variant(discussions)));
+
+    std::size_t size = 0;
+    auto start = fc::time_point::now();
+    for (uint32_t i = 0; i < rounds; ++i) {
+        size = fc::json::to_string(fc::variant(discussions)).size();
+    }
+    auto variant_elapsed = seconds(fc::time_point::now() - start);
+
+    start = fc::time_point::now();
+    for (uint32_t i = 0; i < rounds; ++i) {
+        size = json_writer::to_string(discussions).size();
+    }
+    auto direct_elapsed = seconds(fc::time_point::now() - start);
+
+    auto mb = double(size) * rounds / (1024 * 1024);
+    std::cout << fc::json::to_pretty_string(fc::mutable_variant_object()
+        ("discussions", count)
+        ("votes", votes)
+        ("rounds", rounds)
+        ("response_size", size)
+        ("variant_responses_per_sec", rounds / variant_elapsed)
+        ("variant_mb_per_sec", mb / variant_elapsed)
+        ("direct_responses_per_sec", rounds / direct_elapsed)
+        ("direct_mb_per_sec", mb / direct_elapsed)
+        ("speedup", variant_elapsed / direct_elapsed)) << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
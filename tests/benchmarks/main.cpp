@@ -0,0 +1,15 @@
+#include <cstdlib>
+#include <iostream>
+#include <fc/log/logger_config.hpp>
+
+#ifdef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE benchmarks
+#include <boost/test/unit_test.hpp>
+#else
+#include <boost/test/included/unit_test.hpp>
+#endif
+
+boost::unit_test::test_suite *init_unit_test_suite(int argc, char *argv[]) {
+    fc::configure_logging(fc::logging_config::default_config(fc::log_level::error));
+    return nullptr;
+}
@@ -0,0 +1,274 @@
+#include <boost/test/unit_test.hpp>
+
+#include "database_fixture.hpp"
+
+#include <golos/plugins/chain/plugin.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <thread>
+
+using golos::protocol::signed_transaction;
+using golos::protocol::transfer_operation;
+using golos::protocol::asset;
+
+namespace {
+
+    uint32_t env_value(const char* name, uint32_t default_value) {
+        const char* value = getenv(name);
+        return value ? std::stoul(value) : default_value;
+    }
+
+    double seconds(fc::microseconds elapsed) {
+        return std::max<double>(double(elapsed.count()) / 1000000.0, 0.000001);
+    }
+
+    /// Value at the given fraction of sorted durations in microseconds
+    int64_t percentile(const std::vector<int64_t>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[std::min<std::size_t>(sorted.size() - 1, std::size_t(sorted.size() * fraction))];
+    }
+
+} // namespace
+
+/**
+ * Measures how many transactions per second the node accepts and puts into blocks.
+ *
+ * Transactions are signed before the measurement, then they are pushed by several threads
+ * through chain::plugin::accept_transaction(), while the main thread generates blocks by database::generate_block().
+ * Each test case is one configuration of the chain plugin, the results are printed as JSON.
+ * Parameters are taken from the environment:
+ *   TPS_BENCHMARK_ACCOUNTS - number of sending accounts. Default: 1000
+ *   TPS_BENCHMARK_TRANSACTIONS - number of transactions. Default: 20000
+ *   TPS_BENCHMARK_THREADS - number of pushing threads. Default: 4
+ *   TPS_BENCHMARK_BLOCK_INTERVAL_MS - real time between generated blocks. Default: 100
+ */
+struct tps_fixture : public golos::chain::database_fixture {
+    uint32_t accounts = env_value("TPS_BENCHMARK_ACCOUNTS", 1000);
+    uint32_t transactions = env_value("TPS_BENCHMARK_TRANSACTIONS", 20000);
+    uint32_t threads = env_value("TPS_BENCHMARK_THREADS", 4);
+    uint32_t block_interval_ms = env_value("TPS_BENCHMARK_BLOCK_INTERVAL_MS", 100);
+
+    bool single_write_thread = false;
+
+    std::unique_ptr<boost::asio::io_service::work> io_work;
+    std::thread io_thread;
+
+    ~tps_fixture() {
+        stop_io_thread();
+    }
+
+    void initialize(const plugin_options& opts = {}) {
+        database_fixture::initialize(opts);
+        open_database();
+        db->set_min_free_shared_memory_size(16 * 1024 * 1024);
+        db->set_inc_shared_memory_size(256 * 1024 * 1024);
+        db->set_block_num_check_free_size(1);
+        startup();
+
+        auto it = opts.find("single-write-thread");
+        single_write_thread = (it != opts.end() && it->second == "true");
+        if (single_write_thread) {
+            // in the node it is the main thread of the application
+            io_work = std::make_unique<boost::asio::io_service::work>(appbase::app().get_io_service());
+            io_thread = std::thread([]{ appbase::app().get_io_service().run(); });
+        }
+    }
+
+    void stop_io_thread() {
+        if (io_thread.joinable()) {
+            io_work.reset();
+            io_thread.join();
+        }
+    }
+
+    static std::string account_name(uint32_t i) {
+        return "sender" + std::to_string(i);
+    }
+
+    void create_accounts() {
+        for (uint32_t i = 0; i < accounts; ++i) {
+            auto name = account_name(i);
+            account_create(name, generate_private_key(name).get_public_key());
+            fund(name, asset(1000000, STEEM_SYMBOL));
+            vest(name, asset(1000000, STEEM_SYMBOL));
+            if (i % 100 == 99) {
+                generate_block();
+            }
+        }
+        generate_block();
+    }
+
+    std::vector<signed_transaction> sign_transactions() {
+        std::vector<fc::ecc::private_key> keys;
+        for (uint32_t i = 0; i < accounts; ++i) {
+            keys.push_back(generate_private_key(account_name(i)));
+        }
+
+        std::vector<signed_transaction> result(transactions);
+        auto expiration = db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION;
+        auto ref_block = db->head_block_id();
+        auto chain_id = db->get_chain_id();
+
+        std::vector<std::thread> signers;
+        for (uint32_t t = 0; t < threads; ++t) {
+            signers.emplace_back([&, t]() {
+                for (uint32_t i = t; i < transactions; i += threads) {
+                    auto from = i % accounts;
+
+                    transfer_operation op;
+                    op.from = account_name(from);
+                    op.to = account_name((from + 1) % accounts);
+                    op.amount = asset(1, STEEM_SYMBOL);
+                    op.memo = std::to_string(i); // makes transactions unique
+
+                    auto& trx = result[i];
+                    trx.operations.push_back(op);
+                    trx.set_reference_block(ref_block);
+                    trx.set_expiration(expiration);
+                    trx.sign(keys[from], chain_id);
+                }
+            });
+        }
+        for (auto& signer: signers) {
+            signer.join();
+        }
+        return result;
+    }
+
+    /// Generates the block in the same thread, where transactions are pushed
+    fc::microseconds generate_one_block() {
+        auto generate = [&]() {
+            auto start = fc::time_point::now();
+            db->generate_block(
+                db->get_slot_time(1), db->get_scheduled_witness(1), init_account_priv_key, default_skip);
+            return fc::time_point::now() - start;
+        };
+
+        if (!single_write_thread) {
+            return generate();
+        }
+
+        std::promise<fc::microseconds> promise;
+        auto result = promise.get_future();
+        appbase::app().get_io_service().post([&]{
+            try {
+                promise.set_value(generate());
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return result.get();
+    }
+
+    void run(const std::string& name) {
+        create_accounts();
+        auto trxs = sign_transactions();
+
+        std::vector<std::vector<int64_t>> latencies(threads);
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint32_t> running{threads};
+        std::atomic<uint32_t> next{0};
+
+        std::vector<int64_t> block_times;
+        uint64_t included = 0;
+        uint32_t start_block_num = db->head_block_num();
+
+        auto start = fc::time_point::now();
+
+        std::vector<std::thread> pushers;
+        for (uint32_t t = 0; t < threads; ++t) {
+            pushers.emplace_back([&, t]() {
+                while (true) {
+                    auto i = next++;
+                    if (i >= trxs.size()) {
+                        break;
+                    }
+                    auto push_start = fc::time_point::now();
+                    try {
+                        ch_plugin->accept_transaction(trxs[i]);
+                    } catch (...) {
+                        ++failed;
+                    }
+                    latencies[t].push_back((fc::time_point::now() - push_start).count());
+                }
+                --running;
+            });
+        }
+
+        // blocks are generated while transactions are pushed, then until all pending ones are included
+        uint32_t idle_blocks = 0;
+        while (running || (included < trxs.size() - failed && idle_blocks < 3)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(block_interval_ms));
+            block_times.push_back(generate_one_block().count());
+            auto count = db->last_block_assembly().transactions;
+            included += count;
+            idle_blocks = (!running && !count) ? idle_blocks + 1 : 0;
+        }
+        auto elapsed = fc::time_point::now() - start;
+
+        for (auto& pusher: pushers) {
+            pusher.join();
+        }
+        stop_io_thread();
+
+        std::vector<int64_t> all_latencies;
+        for (const auto& item: latencies) {
+            all_latencies.insert(all_latencies.end(), item.begin(), item.end());
+        }
+        std::sort(all_latencies.begin(), all_latencies.end());
+        std::sort(block_times.begin(), block_times.end());
+
+        uint64_t accepted = trxs.size() - failed;
+
+        std::cout << fc::json::to_pretty_string(fc::mutable_variant_object()
+            ("configuration", name)
+            ("threads", threads)
+            ("transactions", trxs.size())
+            ("accepted", accepted)
+            ("failed", failed.load())
+            ("included", included)
+            ("blocks", db->head_block_num() - start_block_num)
+            ("elapsed_sec", seconds(elapsed))
+            ("accepted_tps", accepted / seconds(elapsed))
+            ("admission_latency_us", fc::mutable_variant_object()
+                ("p50", percentile(all_latencies, 0.5))
+                ("p99", percentile(all_latencies, 0.99))
+                ("max", all_latencies.empty() ? 0 : all_latencies.back()))
+            ("block_generation_us", fc::mutable_variant_object()
+                ("p50", percentile(block_times, 0.5))
+                ("p99", percentile(block_times, 0.99))
+                ("max", block_times.empty() ? 0 : block_times.back()))
+            ("last_block_assembly_us", db->last_block_assembly().assembly_time.count())) << std::endl;
+
+        BOOST_CHECK_EQUAL(accepted, included);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(tps_benchmark, tps_fixture)
+
+BOOST_AUTO_TEST_CASE(concurrent_write) {
+    initialize();
+    run("concurrent_write");
+}
+
+BOOST_AUTO_TEST_CASE(single_write_thread) {
+    initialize({{"single-write-thread", "true"}});
+    run("single_write_thread");
+}
+
+BOOST_AUTO_TEST_CASE(single_write_thread_with_queue) {
+    initialize({{"single-write-thread", "true"}, {"transaction-queue-size", "1000"}});
+    run("single_write_thread_with_queue");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,8 @@
 #include <golos/chain/account_object.hpp>
 #include <golos/plugins/chain/plugin.hpp>
 
+#include <future>
+
 using golos::protocol::comment_operation;
 using golos::protocol::vote_operation;
 using golos::protocol::public_key_type;
@@ -286,4 +288,92 @@ BOOST_AUTO_TEST_CASE(clear_votes_older_n_smaller_cashout) {
 
 BOOST_AUTO_TEST_SUITE_END() // clear_votes
 
+BOOST_AUTO_TEST_SUITE(trx_queue)
+
+BOOST_AUTO_TEST_CASE(push_in_batches) {
+    BOOST_TEST_MESSAGE("Testing: push_in_batches");
+    initialize();
+
+    auto make_trx = [&](const std::string& name) {
+        golos::protocol::account_create_operation op;
+        op.new_account_name = name;
+        op.creator = STEEMIT_INIT_MINER_NAME;
+        op.fee = golos::protocol::asset(30000, STEEM_SYMBOL);
+        op.owner = golos::protocol::authority(1, init_account_pub_key, 1);
+        op.active = op.owner;
+        op.posting = op.owner;
+        op.memo_key = init_account_pub_key;
+        signed_transaction tx;
+        tx.operations.push_back(op);
+        tx.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+        tx.sign(init_account_priv_key, db->get_chain_id());
+        return tx;
+    };
+
+    const auto alice_tx = make_trx("alice");
+    const auto bob_tx = make_trx("bob");
+
+    std::vector<std::exception_ptr> errors(3);
+    std::vector<bool> done(3, false);
+    auto callback = [&](std::size_t i) {
+        return [&, i](std::exception_ptr e) {
+            errors[i] = e;
+            done[i] = true;
+        };
+    };
+
+    transaction_queue queue(*db, 10, 2);
+
+    BOOST_TEST_MESSAGE("--- the first caller drains the queue, others only add transactions");
+    BOOST_CHECK(queue.push(alice_tx, 0, callback(0)));
+    BOOST_CHECK(!queue.push(bob_tx, 0, callback(1)));
+    BOOST_CHECK(!queue.push(alice_tx, 0, callback(2)));
+    BOOST_CHECK_EQUAL(queue.get_stats().queue_size, 3);
+
+    BOOST_TEST_MESSAGE("--- transactions are pushed by batches, a failed one doesn't stop others");
+    BOOST_CHECK(queue.process_batch());
+    BOOST_CHECK(done[0] && done[1] && !done[2]);
+    BOOST_CHECK(!queue.process_batch());
+    BOOST_CHECK(done[2]);
+
+    BOOST_CHECK(!errors[0]);
+    BOOST_CHECK(!errors[1]);
+    BOOST_CHECK(errors[2]); // duplicate
+    BOOST_CHECK(db->find_account("alice") != nullptr);
+    BOOST_CHECK(db->find_account("bob") != nullptr);
+
+    auto stats = queue.get_stats();
+    BOOST_CHECK_EQUAL(stats.queue_size, 0);
+    BOOST_CHECK_EQUAL(stats.max_queue_size, 3);
+    BOOST_CHECK_EQUAL(stats.transactions, 3);
+    BOOST_CHECK_EQUAL(stats.batches, 2);
+    BOOST_CHECK_EQUAL(stats.max_batch_size, 2);
+
+    BOOST_TEST_MESSAGE("--- the queue is drained, the next caller drains it again");
+    BOOST_CHECK(queue.push(make_trx("carol"), 0, callback(0)));
+    BOOST_CHECK(!queue.process_batch());
+    BOOST_CHECK(!errors[0]);
+
+    BOOST_TEST_MESSAGE("--- a failed callback doesn't stop the drainer");
+    done[1] = false;
+    BOOST_CHECK(queue.push(make_trx("dave"), 0, [](std::exception_ptr) { FC_THROW("Callback error"); }));
+    BOOST_CHECK(!queue.push(make_trx("eve"), 0, callback(1)));
+    BOOST_CHECK(!queue.process_batch());
+    BOOST_CHECK(done[1] && !errors[1]);
+    BOOST_CHECK(queue.push(make_trx("frank"), 0, callback(0)));
+    BOOST_CHECK(!queue.process_batch());
+
+    BOOST_TEST_MESSAGE("--- the own thread drains the queue, callers don't");
+    queue.start_thread();
+    std::promise<std::exception_ptr> result;
+    BOOST_CHECK(!queue.push(make_trx("george"), 0, [&](std::exception_ptr e) { result.set_value(e); }));
+    BOOST_CHECK(!result.get_future().get());
+    BOOST_CHECK(db->find_account("george") != nullptr);
+
+    queue.stop();
+    BOOST_CHECK_THROW(queue.push(make_trx("harry"), 0, callback(0)), fc::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // trx_queue
+
 BOOST_AUTO_TEST_SUITE_END()
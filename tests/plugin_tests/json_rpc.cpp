@@ -10,6 +10,14 @@
 
 #include "database_fixture.hpp"
 
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <map>
+#include <thread>
+
 using namespace golos::chain;
 using namespace golos::protocol;
 
@@ -20,6 +28,8 @@ namespace test_plugin {
     using golos::plugins::json_rpc::msg_pack;
 
     DEFINE_API_ARGS(throw_exception, msg_pack, std::string)
+    DEFINE_API_ARGS(get_value,       msg_pack, std::string)
+    DEFINE_API_ARGS(sleep,           msg_pack, bool)
 
     class testing_api final : public appbase::plugin<testing_api> {
     public:
@@ -47,7 +57,9 @@ namespace test_plugin {
 
         void plugin_shutdown() override { }
 
-        DECLARE_API((throw_exception))
+        DECLARE_API((throw_exception)(get_value)(sleep))
+
+        uint32_t calls = 0;
     };
 
     DEFINE_API(testing_api, throw_exception) {
@@ -82,6 +94,21 @@ namespace test_plugin {
 
         throw "Internal error";
     }
+
+    DEFINE_API(testing_api, sleep) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(args.args->at(0).as_uint64()));
+        return true;
+    }
+
+    DEFINE_API(testing_api, get_value) {
+        auto value = args.args->at(0).get_string();
+        auto is_immutable = args.args->at(1).as_bool();
+        ++calls;
+        if (is_immutable) {
+            args.mark_immutable();
+        }
+        return value + "-" + std::to_string(calls);
+    }
 } // namespace test_plugin
 
 fc::variant call(json_rpc_plugin& plugin, const std::string& request) {
@@ -284,5 +311,289 @@ BOOST_FIXTURE_TEST_SUITE(json_rpc, database_fixture)
         FC_LOG_AND_RETHROW()
     }
 
+    BOOST_AUTO_TEST_CASE(json_rpc_batch_test) {
+        try {
+            initialize();
+
+            auto &rpc_plugin  = appbase::app().register_plugin<json_rpc_plugin>();
+            auto &testing_api = appbase::app().register_plugin<test_plugin::testing_api>();
+
+            boost::program_options::variables_map options;
+            rpc_plugin.plugin_initialize(options);
+            testing_api.plugin_initialize(options);
+
+            open_database();
+
+            startup();
+            rpc_plugin.plugin_startup();
+            testing_api.plugin_startup();
+
+            const std::vector<std::string> errors = {
+                "unsupported_operation", "invalid_parameter", "business_exception", "std::exception", "..."};
+            const std::vector<int32_t> codes = {
+                SERVER_UNSUPPORTED_OPERATION, SERVER_INVALID_PARAMETER, SERVER_BUSINESS_LOGIC_ERROR,
+                JSON_RPC_INTERNAL_ERROR, JSON_RPC_INTERNAL_ERROR};
+
+            std::string request = "[";
+            for (std::size_t i = 0; i < 20; ++i) {
+                if (i) {
+                    request += ",";
+                }
+                request += "{\"id\":" + std::to_string(i) + ", \"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                    "\"testing_api\",\"throw_exception\",[\"" + errors[i % errors.size()] + "\"]]}";
+            }
+            request += "]";
+
+            boost::asio::io_service ios;
+            std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(ios));
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 4; ++i) {
+                threads.emplace_back([&]{ ios.run(); });
+            }
+
+            auto check_batch = [&](uint32_t parallelism) {
+                rpc_plugin.set_batch_parallelism(parallelism);
+
+                std::promise<std::string> promise;
+                auto result = promise.get_future();
+                rpc_plugin.call(request, [&](const std::string& str) {
+                    promise.set_value(str);
+                }, [&](std::function<void ()> task) {
+                    ios.post(std::move(task));
+                });
+
+                auto responses = fc::json::from_string(result.get()).get_array();
+                BOOST_REQUIRE_EQUAL(responses.size(), 20);
+                for (std::size_t i = 0; i < responses.size(); ++i) {
+                    check_error_response(responses[i].get_object(), fc::variant(i), codes[i % codes.size()]);
+                }
+            };
+
+            BOOST_TEST_MESSAGE("--- responses of parallel calls are in the order of requests, errors don't affect others");
+            check_batch(8);
+
+            BOOST_TEST_MESSAGE("--- parallelism 1 executes calls one after another");
+            check_batch(1);
+
+            BOOST_TEST_MESSAGE("--- parallelism greater than the batch");
+            check_batch(100);
+
+            BOOST_CHECK_THROW(rpc_plugin.set_batch_parallelism(0), fc::exception);
+
+            work.reset();
+            for (auto& thread: threads) {
+                thread.join();
+            }
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(json_rpc_call_scheduler_test) {
+        try {
+            initialize();
+
+            auto &rpc_plugin  = appbase::app().register_plugin<json_rpc_plugin>();
+            auto &testing_api = appbase::app().register_plugin<test_plugin::testing_api>();
+
+            boost::program_options::variables_map options;
+            rpc_plugin.plugin_initialize(options);
+            testing_api.plugin_initialize(options);
+
+            open_database();
+
+            startup();
+            rpc_plugin.plugin_startup();
+            testing_api.plugin_startup();
+
+            std::vector<std::string> methods;
+            std::vector<std::function<void ()>> delayed;
+            bool is_overloaded = false;
+            rpc_plugin.set_call_scheduler([&](
+                const std::string &method, std::function<void ()> run, std::function<void ()> reject
+            ) {
+                methods.push_back(method);
+                if (is_overloaded) {
+                    reject();
+                } else {
+                    delayed.push_back(std::move(run));
+                }
+            });
+
+            const std::string request = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                "\"testing_api\",\"get_value\",[\"a\",false]]}";
+
+            BOOST_TEST_MESSAGE("--- call is answered when the scheduler runs it");
+            fc::variant response;
+            rpc_plugin.call(request, [&](const std::string& str) {response = fc::json::from_string(str);});
+            BOOST_CHECK(response.is_null());
+            BOOST_REQUIRE_EQUAL(delayed.size(), 1);
+            BOOST_REQUIRE_EQUAL(methods.size(), 1);
+            BOOST_CHECK_EQUAL(methods[0], "testing_api.get_value");
+
+            delayed[0]();
+            BOOST_CHECK_EQUAL(response["id"].as_uint64(), 1);
+            BOOST_CHECK_EQUAL(response["result"].get_string(), "a-1");
+
+            BOOST_TEST_MESSAGE("--- rejected call is answered by the overloaded error");
+            is_overloaded = true;
+            response = call(rpc_plugin, request);
+            check_error_response(response, fc::variant(1u), SERVER_OVERLOADED);
+            BOOST_CHECK_EQUAL(testing_api.calls, 1);
+
+            BOOST_TEST_MESSAGE("--- rejected request");
+            rpc_plugin.reject([&](const std::string& str) {response = fc::json::from_string(str);});
+            check_error_response(response, fc::variant(), SERVER_OVERLOADED);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(json_rpc_response_cache_test) {
+        try {
+            initialize();
+
+            auto &rpc_plugin  = appbase::app().register_plugin<json_rpc_plugin>();
+            auto &testing_api = appbase::app().register_plugin<test_plugin::testing_api>();
+
+            boost::program_options::variables_map options;
+            rpc_plugin.plugin_initialize(options);
+            testing_api.plugin_initialize(options);
+
+            open_database();
+
+            startup();
+            rpc_plugin.plugin_startup();
+            testing_api.plugin_startup();
+
+            auto get_value = [&](const std::string& value, bool is_immutable) {
+                auto response = call(rpc_plugin, "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                    "\"testing_api\",\"get_value\",[\"" + value + "\"," + (is_immutable ? "true" : "false") + "]]}");
+                BOOST_CHECK_EQUAL(response["id"].as_uint64(), 1);
+                return response["result"].get_string();
+            };
+
+            BOOST_TEST_MESSAGE("--- mutable results are not cached");
+            BOOST_CHECK_EQUAL(get_value("a", false), "a-1");
+            BOOST_CHECK_EQUAL(get_value("a", false), "a-2");
+            BOOST_CHECK_EQUAL(rpc_plugin.get_response_cache_stats().entries, 0);
+
+            BOOST_TEST_MESSAGE("--- immutable result is returned from the cache");
+            BOOST_CHECK_EQUAL(get_value("b", true), "b-3");
+            BOOST_CHECK_EQUAL(get_value("b", true), "b-3");
+            BOOST_CHECK_EQUAL(testing_api.calls, 3);
+
+            BOOST_TEST_MESSAGE("--- other arguments are other entries");
+            BOOST_CHECK_EQUAL(get_value("c", true), "c-4");
+            BOOST_CHECK_EQUAL(get_value("c", true), "c-4");
+            BOOST_CHECK_EQUAL(get_value("b", true), "b-3");
+
+            auto stats = rpc_plugin.get_response_cache_stats();
+            BOOST_CHECK_EQUAL(stats.entries, 2);
+            BOOST_CHECK_EQUAL(stats.hits, 3);
+            BOOST_CHECK_EQUAL(stats.misses, 1);
+            BOOST_CHECK(stats.memory_usage > 0);
+            BOOST_CHECK(stats.memory_usage <= stats.max_memory);
+
+            auto response = call(rpc_plugin, "{\"id\":2,\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                "\"json_rpc\",\"get_response_cache_stats\",[]]}");
+            BOOST_CHECK_EQUAL(response["result"]["entries"].as_uint64(), 2);
+            BOOST_CHECK_EQUAL(response["result"]["hits"].as_uint64(), 3);
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
+    BOOST_AUTO_TEST_CASE(response_cache_eviction_test) {
+        using golos::plugins::json_rpc::response_cache;
+
+        response_cache cache;
+        BOOST_CHECK(!cache.enabled());
+        cache.add("api.method", "api.method[1]", "1");
+        BOOST_CHECK_EQUAL(cache.get_stats().entries, 0);
+
+        cache.set_max_memory(1024);
+        BOOST_CHECK(cache.enabled());
+        std::string json(200, 'x');
+        for (int i = 0; i < 10; ++i) {
+            cache.add("api.method", "api.method[" + std::to_string(i) + "]", json);
+        }
+        auto stats = cache.get_stats();
+        BOOST_CHECK(stats.memory_usage <= 1024);
+        BOOST_CHECK(stats.evictions > 0);
+        BOOST_CHECK(cache.is_cacheable("api.method"));
+        BOOST_CHECK(!cache.is_cacheable("api.other"));
+
+        BOOST_TEST_MESSAGE("--- the least recently used entries are evicted");
+        BOOST_CHECK(cache.find("api.method[9]").valid());
+        BOOST_CHECK(!cache.find("api.method[0]").valid());
+
+        BOOST_TEST_MESSAGE("--- result larger than the limit isn't cached");
+        cache.add("api.method", "api.method[big]", std::string(2048, 'x'));
+        BOOST_CHECK(!cache.find("api.method[big]").valid());
+        BOOST_CHECK(cache.find("api.method[9]").valid());
+    }
+
+    BOOST_AUTO_TEST_CASE(json_rpc_stats_test) {
+        try {
+            initialize();
+
+            auto &rpc_plugin  = appbase::app().register_plugin<json_rpc_plugin>();
+            auto &testing_api = appbase::app().register_plugin<test_plugin::testing_api>();
+
+            boost::program_options::variables_map options;
+            options.emplace("json-rpc-stats", boost::program_options::variable_value(true, false));
+            options.emplace("json-rpc-slow-call-ms", boost::program_options::variable_value(uint32_t(200), false));
+            rpc_plugin.plugin_initialize(options);
+            testing_api.plugin_initialize(options);
+
+            open_database();
+
+            startup();
+            rpc_plugin.plugin_startup();
+            testing_api.plugin_startup();
+
+            auto request = [](const std::string& method, const std::string& args) {
+                return "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                    "\"testing_api\",\"" + method + "\"," + args + "]}";
+            };
+
+            for (int i = 0; i < 3; ++i) {
+                call(rpc_plugin, request("get_value", "[\"a\",false]"));
+            }
+            call(rpc_plugin, request("throw_exception", "[\"invalid_parameter\"]"));
+            call(rpc_plugin, request("sleep", "[400]"));
+
+            auto stats = rpc_plugin.get_rpc_stats();
+            std::map<std::string, golos::plugins::json_rpc::rpc_method_stats> methods;
+            for (const auto& method: stats.methods) {
+                methods[method.method] = method;
+            }
+
+            BOOST_TEST_MESSAGE("--- calls and errors are counted by methods");
+            BOOST_REQUIRE(methods.count("testing_api.get_value"));
+            BOOST_CHECK_EQUAL(methods["testing_api.get_value"].total.count, 3);
+            BOOST_CHECK_EQUAL(methods["testing_api.get_value"].errors, 0);
+            BOOST_CHECK_EQUAL(methods["testing_api.get_value"].serialization.count, 3);
+            BOOST_REQUIRE(methods.count("testing_api.throw_exception"));
+            BOOST_CHECK_EQUAL(methods["testing_api.throw_exception"].total.count, 1);
+            BOOST_CHECK_EQUAL(methods["testing_api.throw_exception"].errors, 1);
+
+            BOOST_TEST_MESSAGE("--- slow call is recorded with params");
+            BOOST_REQUIRE(methods.count("testing_api.sleep"));
+            BOOST_CHECK_GE(methods["testing_api.sleep"].total.max_us, 400000);
+            // fast calls can be slow on a loaded machine too, so only the sleep is required
+            auto slow_call = std::find_if(stats.slow_calls.begin(), stats.slow_calls.end(), [](const auto& c) {
+                return c.method == "testing_api.sleep";
+            });
+            BOOST_REQUIRE(slow_call != stats.slow_calls.end());
+            BOOST_CHECK_EQUAL(slow_call->params, "[400]");
+            BOOST_CHECK_GE(slow_call->total_us, 400000);
+
+            auto response = call(rpc_plugin, "{\"id\":2,\"jsonrpc\":\"2.0\",\"method\":\"call\",\"params\":["
+                "\"json_rpc\",\"get_rpc_stats\",[]]}");
+            BOOST_CHECK(response["result"]["methods"].is_array());
+            BOOST_CHECK_EQUAL(response["result"]["slow_calls"].get_array().size(), stats.slow_calls.size());
+        }
+        FC_LOG_AND_RETHROW()
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 #endif
@@ -0,0 +1,155 @@
+#ifdef STEEMIT_BUILD_TESTNET
+
+#include <boost/test/unit_test.hpp>
+
+#include <golos/plugins/webserver/request_queue.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using golos::plugins::webserver::request_queue;
+
+namespace {
+
+    /// Collects posted tasks, they are run by the test in one thread
+    struct manual_pool final {
+        std::deque<std::function<void ()>> tasks;
+
+        std::function<void (std::function<void ()>)> poster() {
+            return [this](std::function<void ()> task) {
+                tasks.push_back(std::move(task));
+            };
+        }
+
+        void run_all() {
+            while (!tasks.empty()) {
+                auto task = std::move(tasks.front());
+                tasks.pop_front();
+                task();
+            }
+        }
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(webserver_request_queue)
+
+    BOOST_AUTO_TEST_CASE(method_limits) {
+        manual_pool pool;
+        request_queue queue(pool.poster());
+        queue.set_limit("api.heavy=1");
+
+        std::vector<std::string> log;
+        auto reject = [&]{ log.push_back("rejected"); };
+
+        BOOST_TEST_MESSAGE("--- call over the limit waits for the running one");
+        queue.call("api.heavy", [&]{
+            log.push_back("heavy-1-start");
+            queue.call("api.heavy", [&]{ log.push_back("heavy-2"); }, reject);
+            queue.call("api.light", [&]{ log.push_back("light"); }, reject);
+            log.push_back("heavy-1-end");
+        }, reject);
+
+        BOOST_CHECK_EQUAL(queue.get_stats().queue_size, 1);
+        pool.run_all();
+
+        std::vector<std::string> expected = {"heavy-1-start", "light", "heavy-1-end", "heavy-2"};
+        BOOST_CHECK_EQUAL_COLLECTIONS(log.begin(), log.end(), expected.begin(), expected.end());
+
+        auto stats = queue.get_stats();
+        BOOST_CHECK_EQUAL(stats.queue_size, 0);
+        BOOST_CHECK_EQUAL(stats.accepted, 3);
+        BOOST_REQUIRE_EQUAL(stats.classes.size(), 2);
+        BOOST_CHECK_EQUAL(stats.classes[1].name, "api.heavy");
+        BOOST_CHECK_EQUAL(stats.classes[1].limit, 1);
+        BOOST_CHECK_EQUAL(stats.classes[1].running, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(api_limits) {
+        manual_pool pool;
+        request_queue queue(pool.poster());
+        queue.set_limit("tags.*", 2);
+        queue.set_limit("tags.get_trending", 1);
+
+        uint32_t calls = 0;
+        auto run = [&]{ ++calls; };
+        auto reject = []{ BOOST_FAIL("call is rejected"); };
+
+        queue.call("tags.get_hot", [&]{
+            queue.call("tags.get_created", [&]{
+                // both slots of tags.* are taken, own limit of get_trending is free
+                queue.call("tags.get_active", run, reject);
+                queue.call("tags.get_trending", run, reject);
+                BOOST_CHECK_EQUAL(calls, 1);
+            }, reject);
+        }, reject);
+
+        pool.run_all();
+        BOOST_CHECK_EQUAL(calls, 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(queue_size) {
+        manual_pool pool;
+        request_queue queue(pool.poster());
+        queue.set_max_size(2);
+
+        uint32_t calls = 0;
+        uint32_t rejects = 0;
+        for (int i = 0; i < 3; ++i) {
+            queue.push([&]{ ++calls; }, [&]{ ++rejects; });
+        }
+
+        BOOST_CHECK_EQUAL(rejects, 1);
+        auto stats = queue.get_stats();
+        BOOST_CHECK_EQUAL(stats.queue_size, 2);
+        BOOST_CHECK_EQUAL(stats.rejected_queue_full, 1);
+
+        pool.run_all();
+        BOOST_CHECK_EQUAL(calls, 2);
+        BOOST_CHECK_EQUAL(queue.get_stats().queue_size, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(queue_timeout) {
+        manual_pool pool;
+        request_queue queue(pool.poster());
+        queue.set_timeout(fc::milliseconds(1));
+
+        uint32_t calls = 0;
+        uint32_t rejects = 0;
+        queue.push([&]{ ++calls; }, [&]{ ++rejects; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pool.run_all();
+
+        BOOST_CHECK_EQUAL(calls, 0);
+        BOOST_CHECK_EQUAL(rejects, 1);
+        BOOST_CHECK_EQUAL(queue.get_stats().rejected_timeout, 1);
+
+        queue.push([&]{ ++calls; }, [&]{ ++rejects; });
+        pool.run_all();
+        BOOST_CHECK_EQUAL(calls, 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(limit_options) {
+        manual_pool pool;
+        request_queue queue(pool.poster());
+
+        BOOST_CHECK_THROW(queue.set_limit("method=1"), fc::exception);
+        BOOST_CHECK_THROW(queue.set_limit("api.method=0"), fc::exception);
+        BOOST_CHECK_THROW(queue.set_limit("api.method=x"), fc::exception);
+        BOOST_CHECK_THROW(queue.set_limit("api.method"), fc::exception);
+
+        queue.set_limit(" api.method = 3 ");
+        queue.set_limit("api.method=4");
+        auto stats = queue.get_stats();
+        BOOST_REQUIRE_EQUAL(stats.classes.size(), 2);
+        BOOST_CHECK_EQUAL(stats.classes[1].name, "api.method");
+        BOOST_CHECK_EQUAL(stats.classes[1].limit, 4);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+#endif
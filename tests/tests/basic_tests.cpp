@@ -26,11 +26,19 @@
 #include <boost/test/unit_test_monitor.hpp>
 
 #include <golos/chain/database.hpp>
+#include <golos/protocol/signature_cache.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include "database_fixture.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <random>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace golos;
 using namespace golos::chain;
@@ -313,4 +321,192 @@ BOOST_FIXTURE_TEST_SUITE(basic_tests, clean_database_fixture)
         BOOST_CHECK(block.calculate_merkle_root() == c(dO));
     }
 
+    BOOST_AUTO_TEST_CASE(signature_cache_test) {
+        ACTORS((alice)(bob))
+        fund("alice", 10000);
+
+        auto& cache = signature_cache::instance();
+        auto old_max_size = cache.get_stats().max_size;
+        cache.clear();
+        cache.set_max_size(2);
+
+        const auto& alice_pub = alice_public_key;
+        auto d = [](const std::string& data) {
+            return digest_type::hash(data);
+        };
+        auto sig = [&](const fc::ecc::private_key& key, const std::string& data) {
+            return key.sign_compact(d(data));
+        };
+        auto stats = cache.get_stats();
+
+        flat_set<public_key_type> keys;
+        cache.add(d("a"), {sig(alice_private_key, "a")}, fc::time_point_sec(100), {alice_pub});
+        BOOST_CHECK(cache.get(d("a"), {sig(alice_private_key, "a")}, keys));
+        BOOST_CHECK(keys.count(alice_pub));
+        BOOST_CHECK_EQUAL(cache.get_stats().hits, stats.hits + 1);
+
+        // other signatures of the same transaction are not taken from cache
+        BOOST_CHECK(!cache.get(d("a"), {sig(alice_private_key, "a"), sig(bob_private_key, "a")}, keys));
+        BOOST_CHECK_EQUAL(cache.get_stats().misses, stats.misses + 1);
+
+        // the first to expire is dropped on overflow
+        cache.add(d("b"), {sig(alice_private_key, "b")}, fc::time_point_sec(300), {alice_pub});
+        cache.add(d("c"), {sig(alice_private_key, "c")}, fc::time_point_sec(200), {alice_pub});
+        BOOST_CHECK_EQUAL(cache.get_stats().size, 2);
+        BOOST_CHECK(!cache.get(d("a"), {sig(alice_private_key, "a")}, keys));
+
+        cache.remove_expired(fc::time_point_sec(250));
+        BOOST_CHECK_EQUAL(cache.get_stats().size, 1);
+
+        BOOST_TEST_MESSAGE("--- only transactions passed the authority check are cached");
+        cache.clear();
+        auto chain_id = db->get_chain_id();
+        auto make_trx = [&](const fc::ecc::private_key& key) {
+            signed_transaction tx;
+            transfer_operation op;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = asset(1, STEEM_SYMBOL);
+            tx.operations.push_back(op);
+            tx.set_expiration(db->head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION / 2);
+            tx.sign(key, chain_id);
+            return tx;
+        };
+
+        // keys recovered for public APIs are not kept
+        auto tx = make_trx(alice_private_key);
+        BOOST_CHECK(tx.get_signature_keys(chain_id).count(alice_pub));
+        BOOST_CHECK_EQUAL(cache.get_stats().size, 0);
+
+        STEEMIT_CHECK_THROW(db->push_transaction(make_trx(bob_private_key), 0), fc::exception);
+        BOOST_CHECK_EQUAL(cache.get_stats().size, 0);
+
+        db->push_transaction(tx, 0);
+        BOOST_CHECK_EQUAL(cache.get_stats().size, 1);
+
+        cache.clear();
+        cache.set_max_size(old_max_size);
+    }
+
+    BOOST_AUTO_TEST_CASE(priority_lock_test) {
+        priority_lock lock;
+        lock.set_enabled(true);
+        const auto forever = fc::microseconds::maximum();
+        auto stats_of = [&](lock_source source) {
+            return lock.get_stats()[static_cast<uint32_t>(source)];
+        };
+
+        // nested acquisitions pass through the gate and aren't counted
+        {
+            priority_lock::guard outer(lock, lock_source::block_write, forever);
+            outer.locked();
+            priority_lock::guard inner(lock, lock_source::api_read, fc::milliseconds(1));
+            inner.locked();
+        }
+        BOOST_CHECK_EQUAL(stats_of(lock_source::block_write).wait.count, 1);
+        BOOST_CHECK_EQUAL(stats_of(lock_source::block_write).hold.count, 1);
+        BOOST_CHECK_EQUAL(stats_of(lock_source::api_read).wait.count, 0);
+
+        // the block writer waits for the current reader, new readers wait for the block writer
+        auto reader = std::make_unique<priority_lock::guard>(lock, lock_source::api_read, forever);
+        reader->locked();
+
+        std::atomic<bool> is_written(false);
+        std::thread writer([&]() {
+            priority_lock::guard guard(lock, lock_source::block_write, forever);
+            guard.locked();
+            is_written = true;
+        });
+
+        // new readers wait only for the queued writer
+        for (int i = 0; i < 1000 && !stats_of(lock_source::block_write).waiting; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        BOOST_REQUIRE_EQUAL(stats_of(lock_source::block_write).waiting, 1);
+
+        std::thread late_reader([&]() {
+            for (int i = 0; i < 1000 && !stats_of(lock_source::p2p_read).timeouts; ++i) {
+                try {
+                    priority_lock::guard guard(lock, lock_source::p2p_read, fc::milliseconds(10));
+                    guard.locked();
+                } catch (const lock_timeout_exception&) {
+                }
+            }
+        });
+        late_reader.join();
+
+        BOOST_CHECK_EQUAL(stats_of(lock_source::p2p_read).timeouts, 1);
+        BOOST_CHECK(!is_written);
+
+        reader.reset();
+        writer.join();
+        BOOST_CHECK(is_written);
+        BOOST_CHECK_EQUAL(stats_of(lock_source::block_write).waiting, 0);
+        BOOST_CHECK_EQUAL(stats_of(lock_source::block_write).wait.count, 2);
+        BOOST_CHECK_EQUAL(stats_of(lock_source::api_read).hold.count, 1);
+
+        lock.clear_stats();
+        BOOST_CHECK_EQUAL(stats_of(lock_source::block_write).wait.count, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(shared_memory_growth_test) {
+        shared_memory_growth growth;
+
+        BOOST_CHECK_EQUAL(growth.blocks_left(1000, 100), std::numeric_limits<uint32_t>::max());
+        BOOST_CHECK_EQUAL(growth.blocks_left(100, 100), 0);
+
+        uint64_t used = 1000000;
+        for (uint32_t n = 1; n <= 20000; ++n, used += 1000) {
+            growth.add_block(n, used);
+        }
+        BOOST_CHECK_CLOSE(growth.bytes_per_block(), 1000.0, 1);
+        BOOST_CHECK_CLOSE(double(growth.blocks_left(1100000, 100000)), 1000.0, 1);
+
+        // skipped blocks are counted as several blocks, popped ones aren't counted
+        growth.add_block(20010, used + 10000);
+        growth.add_block(20005, used);
+        BOOST_CHECK_CLOSE(growth.bytes_per_block(), 1000.0, 1);
+
+        // freed memory lowers the rate, but it isn't predicted negative
+        for (uint32_t n = 20006; n <= 40000; ++n, used -= 1000) {
+            growth.add_block(n, used);
+        }
+        BOOST_CHECK_EQUAL(growth.bytes_per_block(), 0);
+
+        // without the file there is nothing to reserve
+        BOOST_CHECK(growth.reserve(1024 * 1024, 1024 * 1024));
+
+        // the new tail starts in the middle of the page, the prefault starts from the beginning of this page
+        const std::size_t page_size = sysconf(_SC_PAGESIZE);
+        const std::size_t size = page_size * 4;
+        auto base = static_cast<char*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+        BOOST_REQUIRE(base != MAP_FAILED);
+        growth.resized(40001, used, base + page_size + 100, size - page_size - 100);
+        for (int i = 0; i < 500 && growth.is_populating(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        BOOST_CHECK(!growth.is_populating());
+        BOOST_CHECK_EQUAL(growth.populate_errors(), 0);
+        BOOST_CHECK_EQUAL(growth.populated_bytes(), size - page_size);
+
+        growth.stop();
+        munmap(base, size);
+    }
+
+    BOOST_AUTO_TEST_CASE(shared_memory_advice_test) {
+        BOOST_CHECK_EQUAL(parse_shared_memory_advice({}), shared_memory_advice_normal);
+        auto advice = parse_shared_memory_advice({"random", "hugepage"});
+        BOOST_CHECK_EQUAL(advice, shared_memory_advice_random | shared_memory_advice_hugepage);
+        BOOST_CHECK_EQUAL(shared_memory_advice_to_string(advice), "random,hugepage");
+        BOOST_CHECK_EQUAL(shared_memory_advice_to_string(shared_memory_advice_normal), "normal");
+        BOOST_CHECK_THROW(parse_shared_memory_advice({"sequential"}), fc::assert_exception);
+
+        // madvise() fails on the address of the segment manager, it isn't aligned to the page
+        auto mapping = db->get_shared_memory_mapping();
+        BOOST_CHECK_EQUAL(uintptr_t(mapping.first) % uintptr_t(sysconf(_SC_PAGESIZE)), 0);
+        BOOST_CHECK_GE(mapping.second, db->max_memory());
+        BOOST_CHECK(advise_shared_memory(mapping.first, mapping.second, shared_memory_advice_random));
+        BOOST_CHECK(advise_shared_memory(mapping.first, mapping.second, shared_memory_advice_willneed));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,8 @@
 
 #include <golos/chain/database.hpp>
 #include <golos/chain/steem_objects.hpp>
+#include <golos/chain/block_prevalidator.hpp>
+#include <golos/chain/operation_batch_worker.hpp>
 
 #include <golos/plugins/account_history/history_object.hpp>
 #include <golos/plugins/account_history/plugin.hpp>
@@ -37,6 +39,11 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+
 #include "database_fixture.hpp"
 
 using namespace golos;
@@ -285,6 +292,7 @@ BOOST_AUTO_TEST_SUITE(block_tests)
             db1._log_hardforks = false;
             db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
             db2._log_hardforks = false;
+            db2.set_recent_transaction_cache_size(100);
             db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
             BOOST_CHECK(db1.get_chain_id() == db2.get_chain_id());
 
@@ -326,6 +334,903 @@ BOOST_AUTO_TEST_SUITE(block_tests)
             STEEMIT_CHECK_THROW(PUSH_TX(db2, trx, skip_sigs), fc::exception);
             BOOST_CHECK_EQUAL(db1.get_balance("alice", STEEM_SYMBOL).amount.value, 500);
             BOOST_CHECK_EQUAL(db2.get_balance("alice", STEEM_SYMBOL).amount.value, 500);
+
+            // the dedupe index has only ids, bodies are served from the cache
+            BOOST_CHECK(db1.is_known_transaction(trx.id()));
+            STEEMIT_CHECK_THROW(db1.get_recent_transaction(trx.id()), fc::exception);
+            BOOST_CHECK(db2.get_recent_transaction(trx.id()).id() == trx.id());
+            BOOST_CHECK_EQUAL(db2.get_recent_transaction_cache_stats().size, 2);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(state_version_check) {
+        try {
+            fc::temp_directory data_dir(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            auto open = [&](database& db) {
+                db._log_hardforks = false;
+                db.open(data_dir.path(), data_dir.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            };
+
+            {
+                database db;
+                open(db);
+                db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+                db.close();
+            }
+            {
+                database db;
+                open(db);
+                BOOST_CHECK_EQUAL(db.head_block_num(), 1);
+
+                // the state of the previous layout has no version
+                auto version = db.get_segment_manager()->find<uint32_t>("golos_state_version").first;
+                BOOST_REQUIRE(version != nullptr);
+                db.get_segment_manager()->destroy_ptr(version);
+                db.close();
+            }
+            {
+                database db;
+                STEEMIT_CHECK_THROW(open(db), database_state_version_exception);
+            }
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(block_prevalidation) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path()),
+                    dir2(golos::utilities::temp_directory_path()),
+                    dir3(golos::utilities::temp_directory_path());
+            database db1,
+                    db2,
+                    db3;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db2._log_hardforks = false;
+            db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db3._log_hardforks = false;
+            db3.open(dir3.path(), dir3.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_pub_key, 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(
+                    db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            PUSH_TX(db1, trx, 0);
+
+            auto b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+
+            block_prevalidator prevalidator;
+            prevalidator.start(2, 10);
+            prevalidator.prevalidate(b, b.id(), true);
+
+            auto result = prevalidator.take(b.id());
+            BOOST_REQUIRE(result);
+            BOOST_CHECK(result->block_id == b.id());
+            BOOST_CHECK(result->merkle_root == b.transaction_merkle_root);
+            BOOST_CHECK(result->matches(b));
+            BOOST_REQUIRE_EQUAL(result->transactions.size(), 1);
+            BOOST_CHECK(result->transactions[0].is_valid);
+            BOOST_CHECK(result->transactions[0].signature_keys.count(init_account_pub_key));
+            BOOST_CHECK(!prevalidator.take(b.id()));
+
+            // the same header with other transactions has the same id, but results don't match it
+            auto forged = b;
+            forged.transactions[0].ref_block_num++;
+            BOOST_CHECK(forged.id() == b.id());
+            BOOST_CHECK(!result->matches(forged));
+            STEEMIT_CHECK_THROW(db3.push_block(forged, database::skip_nothing, result), fc::exception);
+            BOOST_CHECK(db3.find_account("alice") == nullptr);
+
+            BOOST_CHECK(!db2.push_block(b, database::skip_nothing, result));
+            BOOST_CHECK(db2.find_account("alice") != nullptr);
+
+            // recovered keys are used instead of the transaction signatures
+            auto wrong_result = std::make_shared<prevalidated_block>(*result);
+            wrong_result->transactions[0].signature_keys.clear();
+            STEEMIT_CHECK_THROW(db3.push_block(b, database::skip_nothing, wrong_result), fc::exception);
+            BOOST_CHECK(db3.find_account("alice") == nullptr);
+
+            prevalidator.stop();
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(generate_block_reuses_pending_state) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+
+            auto create_account = [&](const std::string& name, fc::time_point_sec expiration, uint32_t skip) {
+                signed_transaction trx;
+                account_create_operation cop;
+                cop.new_account_name = name;
+                cop.creator = STEEMIT_INIT_MINER_NAME;
+                cop.owner = authority(1, init_account_pub_key, 1);
+                cop.active = cop.owner;
+                trx.operations.push_back(cop);
+                trx.set_expiration(expiration);
+                trx.sign(init_account_priv_key, db1.get_chain_id());
+                PUSH_TX(db1, trx, skip);
+            };
+            auto max_expiration = [&]() {
+                return db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION;
+            };
+            auto generate = [&]() {
+                return db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+            };
+
+            // all pending transactions were fully checked, they are taken without reapplying
+            create_account("alice", max_expiration(), 0);
+            create_account("bob", max_expiration(), 0);
+            auto b = generate();
+            BOOST_CHECK_EQUAL(b.transactions.size(), 2);
+            BOOST_CHECK(db1.last_block_assembly().reused_pending_state);
+            BOOST_CHECK_EQUAL(db1.last_block_assembly().transactions, 2);
+            BOOST_CHECK_EQUAL(db1.last_block_assembly().postponed_transactions, 0);
+
+            // authority wasn't checked on pushing, so the transaction is reapplied
+            create_account("carol", max_expiration(), database::skip_authority_check);
+            b = generate();
+            BOOST_CHECK_EQUAL(b.transactions.size(), 1);
+            BOOST_CHECK(!db1.last_block_assembly().reused_pending_state);
+            BOOST_CHECK(db1.find_account("carol") != nullptr);
+
+            // the transaction expires before the block time, it is dropped and the rest is reapplied
+            create_account("dave", db1.head_block_time() + 1, 0);
+            create_account("eve", max_expiration(), 0);
+            b = generate();
+            BOOST_CHECK_EQUAL(b.transactions.size(), 1);
+            BOOST_CHECK(!db1.last_block_assembly().reused_pending_state);
+            BOOST_CHECK(db1.find_account("dave") == nullptr);
+            BOOST_CHECK(db1.find_account("eve") != nullptr);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(compressed_block_log_format) {
+        try {
+            fc::temp_directory dir(golos::utilities::temp_directory_path());
+            auto path = dir.path() / "block_log";
+
+            std::vector<signed_block> blocks;
+            block_id_type previous;
+            for (int i = 0; i < 8; ++i) {
+                signed_block b;
+                b.previous = previous;
+                b.witness = "alice";
+                b.timestamp = fc::time_point_sec(1000 + i * STEEMIT_BLOCK_INTERVAL);
+                previous = b.id();
+                blocks.push_back(b);
+            }
+
+            {
+                block_log log;
+                log.open(path, 3);
+                BOOST_CHECK(log.is_compressed());
+                BOOST_CHECK(!log.head().valid());
+
+                for (const auto& b: blocks) {
+                    log.append(b);
+                    BOOST_CHECK(log.head()->id() == b.id());
+                }
+                // reading of the open chunk
+                BOOST_CHECK(log.read_block_by_num(7)->id() == blocks[6].id());
+                STEEMIT_CHECK_THROW(log.append(blocks[0]), fc::exception);
+
+                BOOST_CHECK_EQUAL(log.get_block_pos(1), log.get_block_pos(3));
+                BOOST_CHECK(log.get_block_pos(3) != log.get_block_pos(4));
+                BOOST_CHECK(log.get_block_pos(9) == block_log::npos);
+            }
+
+            // the index is reconstructed and the format is detected on opening
+            fc::remove_all(dir.path() / "block_log.index");
+
+            block_log log;
+            log.set_cache_size(1);
+            log.open(path);
+            BOOST_REQUIRE(log.is_compressed());
+            BOOST_REQUIRE(log.head().valid());
+            BOOST_CHECK(log.head()->id() == blocks.back().id());
+            BOOST_CHECK(log.read_head().id() == blocks.back().id());
+
+            for (uint32_t num = 1; num <= blocks.size(); ++num) {
+                auto b = log.read_block_by_num(num);
+                BOOST_REQUIRE(b.valid());
+                BOOST_CHECK(b->id() == blocks[num - 1].id());
+                BOOST_CHECK(log.read_block_data_by_num(num, [&](const char* data, std::size_t size) {
+                    BOOST_CHECK(std::vector<char>(data, data + size) == fc::raw::pack(blocks[num - 1]));
+                }));
+            }
+            BOOST_CHECK(!log.read_block_by_num(0).valid());
+            BOOST_CHECK(!log.read_block_by_num(blocks.size() + 1).valid());
+
+            // each chunk is decoded once on sequential reading
+            auto stats = log.get_cache_stats();
+            BOOST_CHECK_EQUAL(stats.misses, 3);
+            BOOST_CHECK_EQUAL(stats.hits, blocks.size() - 3);
+            BOOST_CHECK_EQUAL(stats.size, 1);
+
+            // the open chunk is continued after reopening
+            signed_block b;
+            b.previous = blocks.back().id();
+            b.witness = "alice";
+            log.append(b);
+            BOOST_CHECK(log.read_block_by_num(9)->id() == b.id());
+            STEEMIT_CHECK_THROW(log.read_block(0), fc::exception);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(compressed_block_log_interrupted_sealing) {
+        try {
+            fc::temp_directory dir(golos::utilities::temp_directory_path());
+            auto path = dir.path() / "block_log";
+
+            std::vector<signed_block> blocks;
+            std::vector<char> raw;
+            block_id_type previous;
+            for (int i = 0; i < 3; ++i) {
+                signed_block b;
+                b.previous = previous;
+                b.witness = "alice";
+                b.timestamp = fc::time_point_sec(1000 + i * STEEMIT_BLOCK_INTERVAL);
+                previous = b.id();
+                blocks.push_back(b);
+
+                auto data = fc::raw::pack(b);
+                uint32_t size = data.size();
+                raw.insert(raw.end(), reinterpret_cast<const char*>(&size), reinterpret_cast<const char*>(&size + 1));
+                raw.insert(raw.end(), data.begin(), data.end());
+            }
+
+            {
+                block_log log;
+                log.open(path, 3);
+                for (const auto& b: blocks) {
+                    log.append(b);
+                }
+            }
+
+            auto read_file = [&]() {
+                std::ifstream stream(path.string(), std::ios::in|std::ios::binary);
+                return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            };
+
+            // the file header, then the sealed chunk: first block, count, flags, raw size, data size, data
+            const std::size_t file_header_size = 16;
+            auto sealed = read_file();
+            uint32_t chunk[5];
+            std::memcpy(chunk, sealed.data() + file_header_size, sizeof(chunk));
+            BOOST_REQUIRE_EQUAL(chunk[2], 1);
+            BOOST_REQUIRE_EQUAL(chunk[3], raw.size());
+            BOOST_REQUIRE_EQUAL(sealed.size(), file_header_size + sizeof(chunk) + chunk[4]);
+
+            // killed on copying of the compressed data over the raw data: the raw header is still in place
+            //   and the compressed copy lies after the raw chunk
+            std::vector<char> interrupted(sealed.begin(), sealed.begin() + file_header_size);
+            uint32_t raw_header[5] = {1, 3, 0, uint32_t(raw.size()), uint32_t(raw.size())};
+            interrupted.insert(interrupted.end(),
+                reinterpret_cast<const char*>(raw_header), reinterpret_cast<const char*>(raw_header + 5));
+            auto partial = raw;
+            auto compressed = sealed.begin() + file_header_size + sizeof(chunk);
+            std::copy(compressed, compressed + chunk[4] / 2, partial.begin());
+            interrupted.insert(interrupted.end(), partial.begin(), partial.end());
+            interrupted.insert(interrupted.end(), sealed.begin() + file_header_size, sealed.end());
+            {
+                std::ofstream stream(path.string(), std::ios::out|std::ios::binary|std::ios::trunc);
+                stream.write(interrupted.data(), interrupted.size());
+            }
+            fc::remove_all(dir.path() / "block_log.index");
+
+            {
+                block_log log;
+                log.open(path);
+                BOOST_REQUIRE(log.head().valid());
+                BOOST_CHECK(log.head()->id() == blocks.back().id());
+                for (uint32_t num = 1; num <= blocks.size(); ++num) {
+                    BOOST_CHECK(log.read_block_by_num(num)->id() == blocks[num - 1].id());
+                }
+            }
+            BOOST_CHECK(read_file() == sealed);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(block_log_block_data) {
+        try {
+            fc::temp_directory dir(golos::utilities::temp_directory_path());
+
+            block_log log;
+            log.open(dir.path() / "block_log");
+            BOOST_CHECK(!log.is_compressed());
+            BOOST_CHECK(!log.read_block_data_by_num(1, [](const char*, std::size_t) {}));
+
+            std::vector<signed_block> blocks;
+            block_id_type previous;
+            for (int i = 0; i < 3; ++i) {
+                signed_block b;
+                b.previous = previous;
+                b.witness = "alice";
+                previous = b.id();
+                blocks.push_back(b);
+                log.append(b);
+            }
+
+            // packed blocks are taken from the file as is, including the head block
+            for (uint32_t num = 1; num <= blocks.size(); ++num) {
+                BOOST_CHECK(log.read_block_data_by_num(num, [&](const char* data, std::size_t size) {
+                    BOOST_CHECK(std::vector<char>(data, data + size) == fc::raw::pack(blocks[num - 1]));
+                }));
+            }
+            BOOST_CHECK(!log.read_block_data_by_num(blocks.size() + 1, [](const char*, std::size_t) {}));
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(state_snapshot) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            fc::temp_directory dir2(golos::utilities::temp_directory_path());
+            auto snapshot = dir1.path() / "snapshot.bin";
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto create_account = [&](const std::string& name) {
+                signed_transaction trx;
+                account_create_operation cop;
+                cop.new_account_name = name;
+                cop.creator = STEEMIT_INIT_MINER_NAME;
+                cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+                cop.active = cop.owner;
+                trx.operations.push_back(cop);
+                trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+                trx.sign(init_account_priv_key, db1.get_chain_id());
+                db1.push_transaction(trx);
+            };
+
+            create_account("alice");
+            create_account("bob");
+            db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+
+            create_account("carol");
+
+            while (db1.get_dynamic_global_properties().last_irreversible_block_num < 10) {
+                db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+            }
+
+            // the snapshot is written at the last irreversible block
+            db1.close();
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db1.export_snapshot(snapshot, false, 2);
+            db1.close();
+
+            fc::copy(dir1.path() / "block_log", dir2.path() / "block_log");
+            fc::copy(dir1.path() / "block_log.index", dir2.path() / "block_log.index");
+
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            database db2;
+            db2._log_hardforks = false;
+            db2.open_from_snapshot(dir2.path(), dir2.path(), snapshot, TEST_SHARED_MEM_SIZE);
+
+            BOOST_CHECK_EQUAL(db2.head_block_num(), db1.head_block_num());
+            BOOST_CHECK(db2.head_block_id() == db1.head_block_id());
+            BOOST_CHECK_EQUAL(db2.revision(), db1.revision());
+            BOOST_CHECK(db2.get_dynamic_global_properties().current_supply == db1.get_dynamic_global_properties().current_supply);
+            BOOST_CHECK_EQUAL(
+                db2.get_index<account_index>().indices().size(), db1.get_index<account_index>().indices().size());
+            BOOST_CHECK_EQUAL(
+                db2.get_index<witness_index>().indices().size(), db1.get_index<witness_index>().indices().size());
+            BOOST_CHECK(db2.get_account("alice").id == db1.get_account("alice").id);
+            BOOST_CHECK(db2.get_account("bob").id == db1.get_account("bob").id);
+            BOOST_CHECK(db2.get_account("carol").id == db1.get_account("carol").id);
+            BOOST_CHECK(db2.get_authority("carol").owner == db1.get_authority("carol").owner);
+
+            // the node continues from the block of the snapshot with the same ids of new objects
+            create_account("dave");
+            auto b = db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+            db2.push_block(b);
+            BOOST_CHECK(db2.head_block_id() == db1.head_block_id());
+            BOOST_CHECK(db2.get_account("dave").id == db1.get_account("dave").id);
+            db2.close();
+
+            // a broken section is detected by its checksum
+            {
+                std::fstream f(snapshot.generic_string(), std::ios::in | std::ios::out | std::ios::binary);
+                f.seekp(-1, std::ios::end);
+                f.put(0x55);
+            }
+            database db3;
+            db3._log_hardforks = false;
+            STEEMIT_REQUIRE_THROW(
+                db3.open_from_snapshot(dir2.path(), dir2.path(), snapshot, TEST_SHARED_MEM_SIZE), fc::exception);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(plugins_reindex) {
+        try {
+            using golos::plugins::account_history::account_history_index;
+            using golos::plugins::account_history::account_history_object;
+
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db1;
+            db1._log_hardforks = false;
+
+            using op_location = std::tuple<uint32_t, uint32_t, uint16_t, int>;
+            std::vector<op_location> applied_ops;
+            std::vector<op_location> reindexed_ops;
+            bool reindexing = false;
+            bool head_matches = true;
+            uint32_t other_calls = 0;
+            uint32_t external_calls = 0;
+
+            // the test plugin keeps created accounts in its index, it fails on carol while reindexing
+            auto on_operation = [&](const operation_notification& note) {
+                if (reindexing) {
+                    BOOST_CHECK(db1.is_reindexing_plugins());
+                    head_matches &= (db1.head_block_num() + 1 == note.block);
+                    reindexed_ops.emplace_back(note.block, note.trx_in_block, note.op_in_trx, note.op.which());
+                }
+                if (note.op.which() != operation::tag<account_create_operation>::value) {
+                    return;
+                }
+                const auto& op = note.op.get<account_create_operation>();
+                FC_ASSERT(!reindexing || op.new_account_name != "carol", "Test plugin failure");
+                db1.create<account_history_object>([&](account_history_object& o) {
+                    o.account = op.new_account_name;
+                    o.block = note.block;
+                });
+            };
+            db1.post_apply_operation.connect(on_operation);
+            db1.add_reindexable_plugin("test", {nullptr, on_operation, nullptr});
+            add_plugin_index<account_history_index>(db1, "test");
+
+            db1.add_reindexable_plugin("other", {nullptr, [&](const operation_notification&) { ++other_calls; }, nullptr});
+
+            // operations of pending transactions aren't in batches
+            db1.applied_operation_batch.connect([&](const operation_batch_ptr& batch) {
+                if (reindexing) {
+                    ++external_calls;
+                }
+                for (const auto& note: batch->operations) {
+                    if (!is_virtual_operation(note.op)) {
+                        applied_ops.emplace_back(note.block, note.trx_in_block, note.op_in_trx, note.op.which());
+                    }
+                }
+            });
+            db1.applied_block.connect([&](const signed_block&) {
+                if (reindexing) {
+                    ++external_calls;
+                }
+            });
+
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto create_account = [&](const std::string& name) {
+                signed_transaction trx;
+                account_create_operation cop;
+                cop.new_account_name = name;
+                cop.creator = STEEMIT_INIT_MINER_NAME;
+                cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+                cop.active = cop.owner;
+                trx.operations.push_back(cop);
+                trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+                trx.sign(init_account_priv_key, db1.get_chain_id());
+                db1.push_transaction(trx);
+            };
+            auto generate = [&]() {
+                db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, database::skip_nothing);
+            };
+            using history_item = std::pair<std::string, uint32_t>;
+            auto get_history = [&]() {
+                std::vector<history_item> result;
+                for (const auto& o: db1.get_index<account_history_index>().indices()) {
+                    result.emplace_back(std::string(o.account), o.block);
+                }
+                std::sort(result.begin(), result.end());
+                return result;
+            };
+
+            create_account("alice");
+            create_account("bob");
+            generate();
+            create_account("carol");
+            generate();
+
+            while (db1.get_dynamic_global_properties().last_irreversible_block_num < 10) {
+                generate();
+            }
+
+            // plugins are reindexed at the last irreversible block
+            db1.close();
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto head_block_num = db1.head_block_num();
+            auto head_block_id = db1.head_block_id();
+            auto head_block_time = db1.head_block_time();
+            auto accounts = db1.get_index<account_index>().indices().size();
+
+            applied_ops.erase(std::remove_if(applied_ops.begin(), applied_ops.end(), [&](const op_location& l) {
+                return std::get<0>(l) > head_block_num;
+            }), applied_ops.end());
+            BOOST_CHECK_EQUAL(applied_ops.size(), 3);
+
+            auto history = get_history();
+            BOOST_REQUIRE_EQUAL(history.size(), 3);
+            BOOST_CHECK_EQUAL(history[0].first, "alice");
+            BOOST_CHECK_EQUAL(history[2].first, "carol");
+
+            BOOST_TEST_MESSAGE("--- plugins, which didn't register for reindexing, are refused");
+            STEEMIT_CHECK_THROW(db1.reindex_plugins({"unknown"}), fc::exception);
+            STEEMIT_CHECK_THROW(db1.reindex_plugins({}), fc::exception);
+            BOOST_CHECK_EQUAL(get_history().size(), 3);
+
+            BOOST_TEST_MESSAGE("--- the index of the plugin is cleared and rebuilt");
+            db1.with_strong_write_lock([&]() {
+                db1.create<account_history_object>([&](account_history_object& o) {
+                    o.account = "dave";
+                });
+            });
+            BOOST_CHECK_EQUAL(get_history().size(), 4);
+
+            reindexing = true;
+            auto info = db1.reindex_plugins({"test"});
+            reindexing = false;
+
+            BOOST_CHECK(reindexed_ops == applied_ops);
+            BOOST_CHECK(head_matches);
+            BOOST_CHECK(!db1.is_reindexing_plugins());
+            BOOST_CHECK_EQUAL(info.operations, applied_ops.size());
+            BOOST_CHECK_EQUAL(info.failed_operations, 1);
+
+            // dave is removed, carol is missed because of the failure
+            std::vector<history_item> expected(history.begin(), history.begin() + 2);
+            auto rebuilt = get_history();
+            BOOST_CHECK(rebuilt == expected);
+
+            BOOST_TEST_MESSAGE("--- other plugins and subscribers aren't notified");
+            BOOST_CHECK_EQUAL(other_calls, 0);
+            BOOST_CHECK_EQUAL(external_calls, 0);
+
+            // the consensus state isn't changed
+            BOOST_CHECK_EQUAL(db1.head_block_num(), head_block_num);
+            BOOST_CHECK(db1.head_block_id() == head_block_id);
+            BOOST_CHECK(db1.head_block_time() == head_block_time);
+            BOOST_CHECK_EQUAL(db1.get_index<account_index>().indices().size(), accounts);
+
+            generate();
+            BOOST_CHECK_EQUAL(db1.head_block_num(), head_block_num + 1);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(irreversible_block_replica) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            fc::temp_directory dir2(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            db1.push_transaction(trx);
+
+            while (db1.get_dynamic_global_properties().last_irreversible_block_num < 10) {
+                db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+            }
+            auto lib = db1.last_non_undoable_block_num();
+
+            database db2;
+            db2._log_hardforks = false;
+            db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            db2.with_strong_write_lock([&]() {
+                for (uint32_t n = 1; n <= lib; ++n) {
+                    db2.apply_irreversible_block(*db1.get_block_log().read_block_by_num(n));
+                }
+                // only the next block can be applied
+                STEEMIT_REQUIRE_THROW(db2.apply_irreversible_block(*db1.get_block_log().read_block_by_num(lib)), fc::exception);
+            });
+
+            BOOST_CHECK_EQUAL(db2.head_block_num(), lib);
+            BOOST_CHECK(db2.head_block_id() == db1.get_block_id_for_num(lib));
+            BOOST_CHECK(db2.find_account("alice") != nullptr);
+            BOOST_CHECK_EQUAL(db2.get_block_log().head()->block_num(), lib);
+
+            // the state matches the block log after the restart
+            db2.close();
+            db2.open(dir2.path(), dir2.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            BOOST_CHECK_EQUAL(db2.head_block_num(), lib);
+            BOOST_CHECK_EQUAL(db2.revision(), int64_t(lib));
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(async_shared_memory_flush) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            auto generate = [&](uint32_t n) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+                }
+            };
+
+            // the synchronous flush is counted too
+            db1.set_flush_interval(5);
+            generate(10);
+            auto stats = db1.get_flush_stats();
+            BOOST_CHECK_EQUAL(stats.flushes, 1);
+            BOOST_CHECK_EQUAL(stats.synced_bytes, db1.max_memory());
+            BOOST_CHECK_EQUAL(stats.flushing_block, 0);
+
+            db1.set_async_flush(true, 0);
+            generate(10);
+            for (int i = 0; i < 500 && db1.get_flush_stats().flushes < 2; ++i) {
+                fc::usleep(fc::milliseconds(10));
+            }
+            stats = db1.get_flush_stats();
+            BOOST_CHECK_EQUAL(stats.errors, 0);
+            BOOST_CHECK_GE(stats.flushes, 2);
+            BOOST_CHECK_GT(stats.last_flushed_block, 10);
+            BOOST_CHECK_GT(stats.synced_bytes, db1.max_memory());
+            BOOST_CHECK_EQUAL(stats.duration.count, stats.flushes);
+
+            db1.close();
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(operation_batch_notifications) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            auto generate = [&]() {
+                return db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+            };
+
+            std::vector<operation_batch_ptr> batches;
+            db1.applied_operation_batch.connect([&](const operation_batch_ptr& b) {
+                batches.push_back(b);
+            });
+
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            PUSH_TX(db1, trx, 0);
+
+            // operations of pending transactions aren't collected
+            BOOST_CHECK(batches.empty());
+
+            auto b = generate();
+            BOOST_REQUIRE_EQUAL(batches.size(), 1);
+            const auto& batch = *batches.front();
+            BOOST_CHECK_EQUAL(batch.block->id(), b.id());
+            BOOST_CHECK_EQUAL(batch.last_irreversible_block_num, db1.last_non_undoable_block_num());
+            BOOST_REQUIRE(!batch.operations.empty());
+            BOOST_CHECK(batch.operations.front().op.which() == operation::tag<account_create_operation>::value);
+            BOOST_CHECK_EQUAL(batch.operations.front().trx_id, trx.id());
+            BOOST_CHECK_EQUAL(batch.operations.front().block, b.block_num());
+            BOOST_CHECK_EQUAL(batch.operations.front().virtual_op, 0);
+            for (const auto& note: batch.operations) {
+                BOOST_CHECK_EQUAL(note.block, b.block_num());
+                BOOST_CHECK_EQUAL(is_virtual_operation(note.op), note.virtual_op != 0);
+            }
+
+            // the worker gets blocks in order, the lag above max_lag is processed in the applying thread
+            std::vector<uint32_t> processed;
+            operation_batch_worker worker(db1, "test", [&](const operation_batch& batch) {
+                processed.push_back(batch.block->block_num());
+            });
+            db1.applied_operation_batch.connect([&](const operation_batch_ptr& b) {
+                worker.push(b);
+            });
+            worker.start(2);
+
+            std::vector<uint32_t> applied;
+            for (int i = 0; i < 20; ++i) {
+                applied.push_back(generate().block_num());
+            }
+            worker.stop();
+
+            BOOST_CHECK_EQUAL(worker.queue_size(), 0);
+            BOOST_CHECK_EQUAL(worker.processed_batches(), applied.size());
+            BOOST_CHECK(processed == applied);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(operation_batch_worker_draining) {
+        try {
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+
+            auto make_batch = [](uint32_t block_num) {
+                auto batch = std::make_shared<operation_batch>();
+                signed_block block;
+                block.previous._hash[0] = fc::endian_reverse_u32(block_num - 1);
+                batch->block = std::make_shared<signed_block>(block);
+                return operation_batch_ptr(batch);
+            };
+
+            std::vector<uint32_t> processed;
+            std::mutex processed_mutex;
+            std::promise<void> first_started;
+            std::promise<void> first_released;
+            auto released = first_released.get_future().share();
+            operation_batch_worker worker(db1, "test", [&](const operation_batch& batch) {
+                auto block_num = batch.block->block_num();
+                if (block_num == 4) {
+                    first_started.set_value();
+                    released.wait();
+                }
+                std::lock_guard<std::mutex> lock(processed_mutex);
+                processed.push_back(block_num);
+            });
+
+            BOOST_TEST_MESSAGE("--- batches are processed at once before start and with zero max_lag");
+            worker.push(make_batch(1));
+            worker.start(0);
+            worker.push(make_batch(2));
+            worker.push(make_batch(3));
+            BOOST_CHECK_EQUAL(worker.queue_size(), 0);
+            BOOST_CHECK_EQUAL(worker.processed_batches(), 3);
+            BOOST_CHECK_EQUAL(worker.sync_drains(), 0);
+            worker.stop();
+
+            BOOST_TEST_MESSAGE("--- stop() processes batches, which are still queued");
+            worker.start(100);
+            worker.push(make_batch(4));
+            first_started.get_future().wait();
+            worker.push(make_batch(5));
+            worker.push(make_batch(6));
+            BOOST_CHECK_EQUAL(worker.queue_size(), 2);
+            first_released.set_value();
+            worker.stop();
+
+            BOOST_CHECK_EQUAL(worker.queue_size(), 0);
+            BOOST_CHECK_EQUAL(worker.processed_batches(), 6);
+            std::vector<uint32_t> expected = {1, 2, 3, 4, 5, 6};
+            BOOST_CHECK_EQUAL_COLLECTIONS(processed.begin(), processed.end(), expected.begin(), expected.end());
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(apply_timing_stats_collection) {
+        try {
+            latency_histogram h;
+            h.add(fc::microseconds(0));
+            h.add(fc::microseconds(1));
+            h.add(fc::microseconds(5));
+            h.add(fc::seconds(3600));
+            BOOST_CHECK_EQUAL(h.count, 4);
+            BOOST_CHECK_EQUAL(h.max_us, 3600000000ull);
+            BOOST_CHECK_EQUAL(h.buckets[0], 1);
+            BOOST_CHECK_EQUAL(h.buckets[1], 1);
+            BOOST_CHECK_EQUAL(h.buckets[3], 1);
+            BOOST_CHECK_EQUAL(h.buckets[latency_histogram::buckets_count - 1], 1);
+
+            fc::temp_directory dir1(golos::utilities::temp_directory_path());
+            database db1;
+            db1._log_hardforks = false;
+            db1.open(dir1.path(), dir1.path(), INITIAL_TEST_SUPPLY, TEST_SHARED_MEM_SIZE, chainbase::database::read_write);
+            db1.clear_apply_timing_stats();
+
+            auto init_account_priv_key = STEEMIT_INIT_PRIVATE_KEY;
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = "alice";
+            cop.creator = STEEMIT_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_priv_key.get_public_key(), 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            trx.set_expiration(db1.head_block_time() + STEEMIT_MAX_TIME_UNTIL_EXPIRATION);
+            trx.sign(init_account_priv_key, db1.get_chain_id());
+            PUSH_TX(db1, trx, 0);
+
+            for (int i = 0; i < 3; ++i) {
+                db1.generate_block(db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key, 0);
+            }
+
+            auto info = db1.get_apply_timing_stats().get_info();
+            auto find = [](const std::vector<apply_timing_item>& items, const std::string& name) {
+                return std::find_if(items.begin(), items.end(), [&](const apply_timing_item& i) {
+                    return i.name == name;
+                });
+            };
+
+            // the operation is applied on pushing and on applying of the block
+            auto op = find(info.operations, "account_create");
+            BOOST_REQUIRE(op != info.operations.end());
+            BOOST_CHECK_GE(op->count, 2);
+
+            auto total = find(info.block_steps, "total");
+            BOOST_REQUIRE(total != info.block_steps.end());
+            BOOST_CHECK_EQUAL(total->count, 3);
+
+            // update_virtual_supply is called twice per block, but it is counted once
+            auto supply = find(info.block_steps, "update_virtual_supply");
+            BOOST_REQUIRE(supply != info.block_steps.end());
+            BOOST_CHECK_EQUAL(supply->count, 3);
+
+            // the stats are returned as they were before the clearing
+            auto cleared = db1.clear_apply_timing_stats();
+            BOOST_CHECK_EQUAL(cleared.block_steps.size(), info.block_steps.size());
+            BOOST_CHECK(db1.get_apply_timing_stats().get_info().block_steps.empty());
         } catch (fc::exception &e) {
             edump((e.to_detail_string()));
             throw;
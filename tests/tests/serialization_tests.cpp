@@ -27,6 +27,9 @@
 
 #include <golos/chain/steem_objects.hpp>
 #include <golos/chain/database.hpp>
+#include <golos/protocol/transaction_memo.hpp>
+#include <golos/protocol/json_writer.hpp>
+#include <golos/api/discussion.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -85,6 +88,93 @@ BOOST_FIXTURE_TEST_SUITE(serialization_tests, clean_database_fixture)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(transaction_memo_test) {
+        try {
+            transfer_operation op;
+            op.from = "alice";
+            op.to = "bob";
+            op.amount = asset(100, STEEM_SYMBOL);
+            op.memo = "memo";
+
+            signed_transaction tx;
+            tx.operations.push_back(op);
+            tx.set_expiration(fc::time_point_sec(1000000));
+            tx.sign(STEEMIT_INIT_PRIVATE_KEY, STEEMIT_CHAIN_ID);
+
+            transaction_memo memo(tx);
+            BOOST_CHECK(memo.id() == tx.id());
+            BOOST_CHECK(memo.digest() == tx.digest());
+            BOOST_CHECK(memo.sig_digest(STEEMIT_CHAIN_ID) == tx.sig_digest(STEEMIT_CHAIN_ID));
+            BOOST_CHECK_EQUAL(memo.packed_size(), fc::raw::pack_size(tx));
+            BOOST_CHECK(tx.get_signature_keys_for_digest(memo.sig_digest(STEEMIT_CHAIN_ID)) ==
+                tx.get_signature_keys(STEEMIT_CHAIN_ID));
+
+            // the memo of the changed transaction is another one
+            tx.operations.push_back(op);
+            transaction_memo changed(tx);
+            BOOST_CHECK(changed.id() == tx.id());
+            BOOST_CHECK(changed.id() != memo.id());
+            BOOST_CHECK_EQUAL(changed.packed_size(), fc::raw::pack_size(tx));
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(json_writer_test) {
+        try {
+            using golos::protocol::json_writer;
+
+            golos::api::discussion d;
+            d.id = comment_id_type(42);
+            d.author = "alice";
+            d.permlink = "post";
+            d.title = "Title with \"quotes\", a \\ and\na new line";
+            d.body = "Текст поста";
+            d.json_metadata = "{\"tags\":[\"golos\"]}";
+            d.created = fc::time_point_sec(1000000);
+            d.last_update = fc::time_point_sec(1000003);
+            d.children_rshares2 = 12345;
+            d.net_rshares = 5000000000ll;
+            d.abs_rshares = -7;
+            d.total_vote_weight = 0xffffffffull + 1;
+            d.net_votes = -3;
+            d.mode = golos::chain::first_payout;
+            d.allow_votes = true;
+            d.beneficiaries.push_back(beneficiary_route_type(account_name_type("bob"), 500));
+            d.pending_payout_value = asset(1234, SBD_SYMBOL);
+            d.author_reputation = share_type(1000);
+            d.hot = 1.5;
+            d.reblogged_by.push_back("carol");
+            d.reblog_entries.emplace_back(account_name_type("carol"), "t", "b", "{}");
+
+            golos::api::vote_state vote;
+            vote.voter = "bob";
+            vote.weight = 100;
+            vote.rshares = -5000000000ll;
+            vote.percent = 10000;
+            vote.time = fc::time_point_sec(1000001);
+            d.active_votes.push_back(vote);
+            vote.reputation = share_type(-1);
+            d.active_votes.push_back(vote);
+
+            BOOST_TEST_MESSAGE("--- the direct output is the same as the output through fc::variant");
+            BOOST_CHECK_EQUAL(json_writer::to_string(d), fc::json::to_string(fc::variant(d)));
+
+            std::vector<golos::api::discussion> discussions = {d, golos::api::discussion()};
+            BOOST_CHECK_EQUAL(json_writer::to_string(discussions), fc::json::to_string(fc::variant(discussions)));
+
+            std::map<uint32_t, golos::api::vote_state> votes = {{1, vote}, {7, golos::api::vote_state()}};
+            BOOST_CHECK_EQUAL(json_writer::to_string(votes), fc::json::to_string(fc::variant(votes)));
+
+            BOOST_CHECK(golos::protocol::has_direct_json<std::vector<golos::api::discussion>>::value);
+            BOOST_CHECK(!golos::protocol::has_direct_json<asset>::value);
+        } catch (fc::exception &e) {
+            edump((e.to_detail_string()));
+            throw;
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(serialization_json_test) {
         try {
             ACTORS((alice)(bob))